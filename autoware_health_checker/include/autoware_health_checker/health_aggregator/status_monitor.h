@@ -51,10 +51,22 @@ class StatusMonitor
 public:
   StatusMonitor();
   void updateStamp(const std::string& name, const double timeout);
-  autoware_system_msgs::NodeStatus getMonitorStatus() const;
+  // The returned status is a buffer that the next call updates in place,
+  // so callers copy what they keep and don't call it from several threads.
+  const autoware_system_msgs::NodeStatus& getMonitorStatus();
 private:
+  struct MonitoredNode
+  {
+    TimeoutManager timer_;
+    size_t index_;  // position in the status buffer
+    autoware_system_msgs::DiagnosticStatus status_template_;  // key and description built once
+  };
+  void rebuildStatusBuffer();
   std::mutex mtx_;
-  std::map<std::string, TimeoutManager> timeout_manager_array_;
+  std::map<std::string, MonitoredNode> monitored_nodes_;
+  // reused between calls, only the values, levels and stamps are updated
+  autoware_system_msgs::NodeStatus status_buffer_;
+  bool layout_changed_;
 };
 
 #endif  // AUTOWARE_HEALTH_CHECKER_HEALTH_AGGREGATOR_STATUS_MONITOR_H
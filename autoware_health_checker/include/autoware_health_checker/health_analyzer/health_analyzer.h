@@ -24,8 +24,12 @@
 #include <ros/ros.h>
 
 // headers in STL
+#include <cstdint>
 #include <map>
+#include <ostream>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 // headers in Autoware
@@ -77,7 +81,8 @@ private:
   void systemStatusCallback(
     const autoware_system_msgs::SystemStatus::ConstPtr& msg);
   void generateDependGraph(const autoware_system_msgs::SystemStatus& status);
-  void addDepend(const rosgraph_msgs::TopicStatistics& statistics);
+  boost::optional<uint64_t> addDepend(
+    const rosgraph_msgs::TopicStatistics& statistics);
   autoware_system_msgs::SystemStatus filterSystemStatus(
     const autoware_system_msgs::SystemStatus& status);
   std::vector<std::string> findWarningNodes(
@@ -87,16 +92,18 @@ private:
   std::vector<std::string> findRootNodes(
     const std::vector<std::string>& target_nodes);
   boost::optional<vertex_t> getTargetNode(const std::string& target_node);
+  vertex_t getOrAddNode(const std::string& node_name);
+  uint64_t getEdgeKey(vertex_t node_sub, vertex_t node_pub) const;
   int countWarn(const autoware_system_msgs::SystemStatus& msg);
   void writeDot();
+  void writeDot(std::ostream& out);
+  // the graph is kept between messages, vertices are never removed
+  // and only the changed edges are added or removed
   graph_t depend_graph_;
+  std::unordered_map<std::string, vertex_t> node_vertices_;
+  std::unordered_map<uint64_t, edge_t> depend_edges_;
   int warn_nodes_count_threshold_;
-  template <typename T> bool
-    isAlreadyExist(const std::vector<T>& vector, const T& target) const
-  {
-    auto result = std::find(vector.begin(), vector.end(), target);
-    return (result != vector.end());
-  }
+  friend class HealthAnalyzerTestClass;
 };
 
 #endif  // AUTOWARE_HEALTH_CHECKER_HEALTH_ANALYZER_HEALTH_ANALYZER_H
@@ -116,6 +116,7 @@ void HealthAggregator::publishSystemStatus(const ros::TimerEvent& event)
 {
   std::lock_guard<std::mutex> lock(mtx_);
   system_status_.header.stamp = ros::Time::now();
+  // copies the monitor status buffer into system_status_
   updateNodeStatus(status_monitor_.getMonitorStatus());
   system_status_.available_nodes = detected_nodes_;
   system_status_pub_.publish(system_status_);
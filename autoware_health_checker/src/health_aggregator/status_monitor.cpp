@@ -13,10 +13,11 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#include <cstdio>
 #include <string>
 #include <autoware_health_checker/health_aggregator/status_monitor.h>
 
-StatusMonitor::StatusMonitor() {}
+StatusMonitor::StatusMonitor() : layout_changed_(true) {}
 
 void StatusMonitor::updateStamp(const std::string& name, const double timeout)
 {
@@ -25,42 +26,60 @@ void StatusMonitor::updateStamp(const std::string& name, const double timeout)
     return;
   }
   std::lock_guard<std::mutex> lock(mtx_);
-  timeout_manager_array_[name] = TimeoutManager(timeout);
+  auto found = monitored_nodes_.find(name);
+  if (found != monitored_nodes_.end())
+  {
+    found->second.timer_ = TimeoutManager(timeout);
+    return;
+  }
+  using DiagStatus = autoware_system_msgs::DiagnosticStatus;
+  MonitoredNode node;
+  node.timer_ = TimeoutManager(timeout);
+  node.index_ = 0;
+  node.status_template_.key = name + "_node_status_rate_slow";
+  node.status_template_.description = name + " node_status rate slow";
+  node.status_template_.type = DiagStatus::UNEXPECTED_RATE;
+  node.status_template_.level = DiagStatus::OK;
+  monitored_nodes_.emplace(name, node);
+  layout_changed_ = true;
+}
+
+void StatusMonitor::rebuildStatusBuffer()
+{
+  status_buffer_.node_name = ros::this_node::getName();
+  status_buffer_.node_activated = true;
+  status_buffer_.status.resize(monitored_nodes_.size());
+  size_t index = 0;
+  for (auto& node : monitored_nodes_)
+  {
+    node.second.index_ = index;
+    auto& status_array = status_buffer_.status.at(index).status;
+    status_array.assign(1, node.second.status_template_);
+    index++;
+  }
+  layout_changed_ = false;
 }
 
-autoware_system_msgs::NodeStatus StatusMonitor::getMonitorStatus() const
+const autoware_system_msgs::NodeStatus& StatusMonitor::getMonitorStatus()
 {
   using DiagStatus = autoware_system_msgs::DiagnosticStatus;
-  using DiagStatusArray = autoware_system_msgs::DiagnosticStatusArray;
-  static const std::string my_name = ros::this_node::getName();
+  std::lock_guard<std::mutex> lock(mtx_);
+  if (layout_changed_)
+  {
+    rebuildStatusBuffer();
+  }
   const ros::Time current = ros::Time::now();
-  autoware_system_msgs::NodeStatus my_status;
-  DiagStatus status_template;
-  status_template.key = "node_status_rate_slow";
-  status_template.description = "node_status rate slow";
-  status_template.type = DiagStatus::UNEXPECTED_RATE;
-  status_template.level = DiagStatus::OK;
-  for (const auto& timeout_manager : timeout_manager_array_)
+  char value[32];
+  for (const auto& node : monitored_nodes_)
   {
-    DiagStatusArray status_array;
-    DiagStatus status(status_template);
-    const auto& node_name = timeout_manager.first;
-    const auto& node_timer = timeout_manager.second;
-    status.key = node_name + "_" + status.key;
-    status.description = node_name + " " + status.description;
-    std::stringstream ss;
-    ss << node_timer.getDuration(current);
-    status.value = ss.str();
-    if (node_timer.isOverLimit(current))
-    {
-      status.level = DiagStatus::ERROR;
-    }
+    const auto& node_timer = node.second.timer_;
+    auto& status = status_buffer_.status.at(node.second.index_).status.front();
+    // same format as the default stream output
+    const int length = snprintf(value, sizeof(value), "%g", node_timer.getDuration(current));
+    status.value.assign(value, length);
+    status.level = node_timer.isOverLimit(current) ? DiagStatus::ERROR : DiagStatus::OK;
     status.header.stamp = node_timer.getStartTime();
-    status_array.status.emplace_back(status);
-    my_status.status.emplace_back(status_array);
   }
-  my_status.header.stamp = ros::Time::now();
-  my_status.node_name = my_name;
-  my_status.node_activated = true;
-  return my_status;
+  status_buffer_.header.stamp = current;
+  return status_buffer_;
 }
@@ -17,10 +17,13 @@
  * v1.0 Masaya Kataoka
  */
 
+#include <functional>
 #include <string>
 #include <vector>
 #include <autoware_health_checker/health_analyzer/health_analyzer.h>
 
+#include <boost/graph/filtered_graph.hpp>
+
 HealthAnalyzer::HealthAnalyzer(ros::NodeHandle nh, ros::NodeHandle pnh)
   : nh_(nh), pnh_(pnh)
 {
@@ -73,6 +76,7 @@ std::vector<std::string> HealthAnalyzer::findWarningNodes(
   const autoware_system_msgs::SystemStatus& sys_status)
 {
   std::vector<std::string> ret;
+  std::unordered_set<std::string> found;
   auto isOverWarn = [](autoware_health_checker::ErrorLevel level)
   {
     return (
@@ -82,20 +86,23 @@ std::vector<std::string> HealthAnalyzer::findWarningNodes(
   };
   for (const auto& node_status : sys_status.node_status)
   {
+    if (found.count(node_status.node_name) != 0)
+    {
+      continue;
+    }
+    bool over_warn = false;
     for (const auto& status_array : node_status.status)
     {
       for (const auto& status : status_array.status)
       {
-        if (isAlreadyExist(ret, node_status.node_name))
-        {
-          continue;
-        }
-        else if (isOverWarn(status.level))
-        {
-          ret.emplace_back(node_status.node_name);
-        }
+        over_warn = over_warn || isOverWarn(status.level);
       }
     }
+    if (over_warn)
+    {
+      found.insert(node_status.node_name);
+      ret.emplace_back(node_status.node_name);
+    }
   }
   return ret;
 }
@@ -104,6 +111,9 @@ std::vector<std::string> HealthAnalyzer::findErrorNodes(
   const autoware_system_msgs::SystemStatus& sys_status)
 {
   std::vector<std::string> ret;
+  std::unordered_set<std::string> found;
+  const std::unordered_set<std::string> available_nodes(
+    sys_status.available_nodes.begin(), sys_status.available_nodes.end());
   auto isOverError = [](autoware_health_checker::ErrorLevel level)
   {
     return (
@@ -112,21 +122,24 @@ std::vector<std::string> HealthAnalyzer::findErrorNodes(
   };
   for (const auto& node_status : sys_status.node_status)
   {
+    const auto& node_name = node_status.node_name;
+    if (found.count(node_name) != 0 || available_nodes.count(node_name) == 0)
+    {
+      continue;
+    }
+    bool over_error = false;
     for (const auto& status_array : node_status.status)
     {
-      const auto& node_name = node_status.node_name;
       for (const auto& status : status_array.status)
       {
-        if (isAlreadyExist(ret, node_name) || !isOverError(status.level))
-        {
-          continue;
-        }
-        if (isAlreadyExist(sys_status.available_nodes, node_name))
-        {
-          ret.emplace_back(node_name);
-        }
+        over_error = over_error || isOverError(status.level);
       }
     }
+    if (over_error)
+    {
+      found.insert(node_name);
+      ret.emplace_back(node_name);
+    }
   }
   return ret;
 }
@@ -135,9 +148,10 @@ std::vector<std::string> HealthAnalyzer::findRootNodes(
   const std::vector<std::string>& target_nodes)
 {
   std::vector<std::string> ret;
+  const std::unordered_set<std::string> targets(
+    target_nodes.begin(), target_nodes.end());
   for (const auto& node : target_nodes)
   {
-    std::vector<std::string> pub_nodes;
     bool depend_found = false;
     adjacency_iterator_t vi, vi_end;
     auto vertex = getTargetNode(node);
@@ -146,12 +160,9 @@ std::vector<std::string> HealthAnalyzer::findRootNodes(
       continue;
     }
     boost::tie(vi, vi_end) = adjacent_vertices(vertex.get(), depend_graph_);
-    for (; vi != vi_end; ++vi)
+    for (; vi != vi_end && !depend_found; ++vi)
     {
-      if (isAlreadyExist(target_nodes, depend_graph_[*vi].node_name))
-      {
-        depend_found = true;
-      }
+      depend_found = (targets.count(depend_graph_[*vi].node_name) != 0);
     }
     if (!depend_found)
     {
@@ -165,14 +176,21 @@ autoware_system_msgs::SystemStatus HealthAnalyzer::filterSystemStatus(
   const autoware_system_msgs::SystemStatus& status)
 {
   int warn_count = countWarn(status);
-  autoware_system_msgs::SystemStatus filtered_status(status);
+  // copy everything but the node status, only the root nodes are kept
+  autoware_system_msgs::SystemStatus filtered_status;
+  filtered_status.header = status.header;
+  filtered_status.available_nodes = status.available_nodes;
+  filtered_status.hardware_status = status.hardware_status;
+  filtered_status.topic_statistics = status.topic_statistics;
   filtered_status.detect_too_match_warning =
     (warn_count >= warn_nodes_count_threshold_);
-  filtered_status.node_status.clear();
-  std::vector<std::string> root_nodes(findRootNodes(findWarningNodes(status)));
+  const std::vector<std::string> root_nodes(
+    findRootNodes(findWarningNodes(status)));
+  const std::unordered_set<std::string> roots(
+    root_nodes.begin(), root_nodes.end());
   for (const auto& node_status : status.node_status)
   {
-    if (isAlreadyExist(root_nodes, node_status.node_name))
+    if (roots.count(node_status.node_name) != 0)
     {
       filtered_status.node_status.emplace_back(node_status);
     }
@@ -190,10 +208,28 @@ void HealthAnalyzer::systemStatusCallback(
 void HealthAnalyzer::generateDependGraph(
   const autoware_system_msgs::SystemStatus& status)
 {
-  depend_graph_ = graph_t();
+  std::unordered_set<uint64_t> current_edges;
+  current_edges.reserve(status.topic_statistics.size());
   for (const auto& el : status.topic_statistics)
   {
-    addDepend(el);
+    auto key = addDepend(el);
+    if (key)
+    {
+      current_edges.insert(key.get());
+    }
+  }
+  // remove the dependencies that are not in the statistics anymore
+  for (auto it = depend_edges_.begin(); it != depend_edges_.end();)
+  {
+    if (current_edges.count(it->first) == 0)
+    {
+      boost::remove_edge(it->second, depend_graph_);
+      it = depend_edges_.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
   }
 }
 
@@ -202,53 +238,83 @@ void HealthAnalyzer::writeDot()
   const std::string path =
     ros::package::getPath("autoware_health_checker") + "/data/node_depends.dot";
   std::ofstream f(path.c_str());
-  boost::write_graphviz(f, depend_graph_,
+  writeDot(f);
+}
+
+void HealthAnalyzer::writeDot(std::ostream& out)
+{
+  // vertices are never removed, the ones without edges left the graph
+  auto connected = [this](vertex_t v)
+  {
+    return boost::out_degree(v, depend_graph_) != 0 ||
+      boost::in_degree(v, depend_graph_) != 0;
+  };
+  boost::filtered_graph<graph_t, boost::keep_all,
+    std::function<bool(vertex_t)>> graph(
+      depend_graph_, boost::keep_all(), connected);
+  boost::write_graphviz(out, graph,
     boost::make_label_writer(get(&node_property::node_name, depend_graph_)));
 }
 
 boost::optional<HealthAnalyzer::vertex_t>
   HealthAnalyzer::getTargetNode(const std::string& target_node)
 {
-  vertex_t ret;
-  auto vertex_range = boost::vertices(depend_graph_);
-  for (auto first = vertex_range.first, last = vertex_range.second;
-       first != last; ++first)
+  auto it = node_vertices_.find(target_node);
+  if (it == node_vertices_.end())
   {
-    vertex_t v = *first;
-    if (depend_graph_[v].node_name == target_node)
-    {
-      ret = v;
-      return ret;
-    }
+    return boost::none;
+  }
+  // a node without dependencies is not part of the current graph
+  vertex_t v = it->second;
+  if (boost::out_degree(v, depend_graph_) == 0 &&
+      boost::in_degree(v, depend_graph_) == 0)
+  {
+    return boost::none;
   }
-  return boost::none;
+  return v;
 }
 
-void HealthAnalyzer::addDepend(
-  const rosgraph_msgs::TopicStatistics& statistics)
+HealthAnalyzer::vertex_t
+  HealthAnalyzer::getOrAddNode(const std::string& node_name)
 {
-  if (statistics.node_pub == statistics.node_sub)
+  auto it = node_vertices_.find(node_name);
+  if (it != node_vertices_.end())
   {
-    return;
+    return it->second;
   }
-  vertex_t node_sub;
-  vertex_t node_pub;
-  edge_t topic;
-  auto pub_vertex = getTargetNode(statistics.node_pub);
-  auto sub_vertex = getTargetNode(statistics.node_sub);
-  if (!pub_vertex)
+  vertex_t v = boost::add_vertex(depend_graph_);
+  depend_graph_[v].node_name = node_name;
+  node_vertices_.emplace(node_name, v);
+  return v;
+}
+
+uint64_t HealthAnalyzer::getEdgeKey(
+  vertex_t node_sub, vertex_t node_pub) const
+{
+  return (static_cast<uint64_t>(node_sub) << 32) |
+    static_cast<uint64_t>(node_pub & 0xffffffff);
+}
+
+boost::optional<uint64_t> HealthAnalyzer::addDepend(
+  const rosgraph_msgs::TopicStatistics& statistics)
+{
+  if (statistics.node_pub == statistics.node_sub)
   {
-    pub_vertex = boost::add_vertex(depend_graph_);
-    depend_graph_[pub_vertex.get()].node_name = statistics.node_pub;
+    return boost::none;
   }
-  if (!sub_vertex)
+  vertex_t sub_vertex = getOrAddNode(statistics.node_sub);
+  vertex_t pub_vertex = getOrAddNode(statistics.node_pub);
+  const uint64_t key = getEdgeKey(sub_vertex, pub_vertex);
+  if (depend_edges_.count(key) != 0)
   {
-    sub_vertex = boost::add_vertex(depend_graph_);
-    depend_graph_[sub_vertex.get()].node_name = statistics.node_sub;
+    return key;
   }
+  edge_t topic;
   bool inserted = false;
   boost::tie(topic, inserted) =
-    boost::add_edge(sub_vertex.get(), pub_vertex.get(), depend_graph_);
+    boost::add_edge(sub_vertex, pub_vertex, depend_graph_);
   depend_graph_[topic].node_sub = statistics.node_sub;
   depend_graph_[topic].node_pub = statistics.node_pub;
+  depend_edges_.emplace(key, topic);
+  return key;
 }
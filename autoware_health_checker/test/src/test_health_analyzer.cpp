@@ -0,0 +1,281 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <autoware_health_checker/health_analyzer/health_analyzer.h>
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using AwDiagStatus = autoware_system_msgs::DiagnosticStatus;
+using SystemStatus = autoware_system_msgs::SystemStatus;
+
+class HealthAnalyzerTestClass
+{
+public:
+  HealthAnalyzerTestClass() : pnh("~") {}
+  std::shared_ptr<HealthAnalyzer> health_analyzer_ptr;
+  ros::NodeHandle pnh;
+  ros::NodeHandle nh;
+  void init()
+  {
+    health_analyzer_ptr = std::make_shared<HealthAnalyzer>(nh, pnh);
+  }
+  SystemStatus analyze(const SystemStatus& status)
+  {
+    health_analyzer_ptr->generateDependGraph(status);
+    return health_analyzer_ptr->filterSystemStatus(status);
+  }
+  std::vector<std::string> findWarningNodes(const SystemStatus& status)
+  {
+    return health_analyzer_ptr->findWarningNodes(status);
+  }
+  std::vector<std::string> findErrorNodes(const SystemStatus& status)
+  {
+    return health_analyzer_ptr->findErrorNodes(status);
+  }
+  std::string writeDot()
+  {
+    std::ostringstream out;
+    health_analyzer_ptr->writeDot(out);
+    return out.str();
+  }
+  int warnThreshold()
+  {
+    return health_analyzer_ptr->warn_nodes_count_threshold_;
+  }
+};
+
+class HealthAnalyzerTestSuite : public ::testing::Test
+{
+public:
+  HealthAnalyzerTestSuite() {}
+
+  ~HealthAnalyzerTestSuite() {}
+  HealthAnalyzerTestClass test_obj_;
+
+protected:
+  virtual void SetUp()
+  {
+    test_obj_.init();
+  }
+  virtual void TearDown() {}
+};
+
+/*
+  analysis of one message as it was done before the graph was kept between messages
+*/
+struct ReferenceResult
+{
+  std::vector<std::string> warning_nodes;
+  std::vector<std::string> error_nodes;
+  std::vector<std::string> filtered_nodes;
+  bool detect_too_match_warning;
+};
+
+ReferenceResult analyzeReference(const SystemStatus& status, int warn_threshold)
+{
+  ReferenceResult result;
+  // subscriber to publishers, rebuilt from this message only
+  std::map<std::string, std::set<std::string>> depends;
+  for (const auto& el : status.topic_statistics)
+  {
+    if (el.node_pub == el.node_sub)
+    {
+      continue;
+    }
+    depends[el.node_sub].insert(el.node_pub);
+    depends[el.node_pub];
+  }
+
+  int warn_count = 0;
+  for (const auto& node_status : status.node_status)
+  {
+    bool over_warn = false, over_error = false;
+    for (const auto& status_array : node_status.status)
+    {
+      for (const auto& diag : status_array.status)
+      {
+        warn_count += (diag.level == AwDiagStatus::WARN) ? 1 : 0;
+        over_warn = over_warn || diag.level == AwDiagStatus::WARN ||
+          diag.level == AwDiagStatus::ERROR || diag.level == AwDiagStatus::FATAL;
+        over_error = over_error || diag.level == AwDiagStatus::ERROR ||
+          diag.level == AwDiagStatus::FATAL;
+      }
+    }
+    const auto& name = node_status.node_name;
+    auto contains = [&name](const std::vector<std::string>& v)
+    {
+      return std::find(v.begin(), v.end(), name) != v.end();
+    };
+    if (over_warn && !contains(result.warning_nodes))
+    {
+      result.warning_nodes.push_back(name);
+    }
+    if (over_error && !contains(result.error_nodes) &&
+        std::find(status.available_nodes.begin(), status.available_nodes.end(), name) !=
+          status.available_nodes.end())
+    {
+      result.error_nodes.push_back(name);
+    }
+  }
+  for (const auto& hardware_status : status.hardware_status)
+  {
+    for (const auto& status_array : hardware_status.status)
+    {
+      for (const auto& diag : status_array.status)
+      {
+        warn_count += (diag.level == AwDiagStatus::WARN) ? 1 : 0;
+      }
+    }
+  }
+  result.detect_too_match_warning = (warn_count >= warn_threshold);
+
+  // a warning node is a root when none of the nodes it subscribes to is warning
+  std::set<std::string> roots;
+  const std::set<std::string> warning(result.warning_nodes.begin(), result.warning_nodes.end());
+  for (const auto& name : result.warning_nodes)
+  {
+    auto it = depends.find(name);
+    if (it == depends.end())
+    {
+      continue;
+    }
+    bool depend_found = false;
+    for (const auto& pub : it->second)
+    {
+      depend_found = depend_found || warning.count(pub) != 0;
+    }
+    if (!depend_found)
+    {
+      roots.insert(name);
+    }
+  }
+  for (const auto& node_status : status.node_status)
+  {
+    if (roots.count(node_status.node_name) != 0)
+    {
+      result.filtered_nodes.push_back(node_status.node_name);
+    }
+  }
+  return result;
+}
+
+std::string nodeName(int i)
+{
+  return "/node_" + std::to_string(i);
+}
+
+SystemStatus createRandomStatus(std::mt19937& gen)
+{
+  auto random = [&gen](int n) { return static_cast<int>(gen() % n); };
+  SystemStatus status;
+  const int n_nodes = 2 + random(8);
+  for (int i = 0, n = random(15); i < n; i++)
+  {
+    rosgraph_msgs::TopicStatistics statistics;
+    statistics.node_pub = nodeName(random(n_nodes));
+    statistics.node_sub = nodeName(random(n_nodes));
+    status.topic_statistics.push_back(statistics);
+  }
+  for (int i = 0, n = random(10); i < n; i++)
+  {
+    autoware_system_msgs::NodeStatus node_status;
+    node_status.node_name = nodeName(random(n_nodes));
+    for (int j = 0, n_arrays = random(3); j < n_arrays; j++)
+    {
+      autoware_system_msgs::DiagnosticStatusArray status_array;
+      for (int k = 0, n_diags = random(3); k < n_diags; k++)
+      {
+        AwDiagStatus diag;
+        diag.level = random(5);
+        status_array.status.push_back(diag);
+      }
+      node_status.status.push_back(status_array);
+    }
+    status.node_status.push_back(node_status);
+  }
+  for (int i = 0; i < n_nodes; i++)
+  {
+    if (random(2) == 0)
+    {
+      status.available_nodes.push_back(nodeName(i));
+    }
+  }
+  return status;
+}
+
+/*
+  test that keeping the graph between messages gives the same result as rebuilding it
+*/
+TEST_F(HealthAnalyzerTestSuite, COMPARE_REBUILT_GRAPH)
+{
+  std::mt19937 gen(5);
+  for (int m = 0; m < 15000; m++)
+  {
+    const SystemStatus status = createRandomStatus(gen);
+    const SystemStatus filtered = test_obj_.analyze(status);
+    const ReferenceResult expected = analyzeReference(status, test_obj_.warnThreshold());
+
+    std::vector<std::string> filtered_nodes;
+    for (const auto& node_status : filtered.node_status)
+    {
+      filtered_nodes.push_back(node_status.node_name);
+    }
+    ASSERT_EQ(expected.filtered_nodes, filtered_nodes) << "message " << m;
+    ASSERT_EQ(expected.detect_too_match_warning, filtered.detect_too_match_warning);
+    ASSERT_EQ(expected.warning_nodes, test_obj_.findWarningNodes(status));
+    ASSERT_EQ(expected.error_nodes, test_obj_.findErrorNodes(status));
+  }
+}
+
+/*
+  test that nodes without dependencies anymore are left out of the dot file
+*/
+TEST_F(HealthAnalyzerTestSuite, WRITE_DOT)
+{
+  SystemStatus status;
+  rosgraph_msgs::TopicStatistics statistics;
+  statistics.node_pub = "/pub_a";
+  statistics.node_sub = "/sub";
+  status.topic_statistics.push_back(statistics);
+  statistics.node_pub = "/pub_b";
+  status.topic_statistics.push_back(statistics);
+  test_obj_.analyze(status);
+  std::string dot = test_obj_.writeDot();
+  ASSERT_NE(std::string::npos, dot.find("/pub_a"));
+  ASSERT_NE(std::string::npos, dot.find("/pub_b"));
+  ASSERT_NE(std::string::npos, dot.find("/sub"));
+
+  status.topic_statistics.pop_back();
+  test_obj_.analyze(status);
+  dot = test_obj_.writeDot();
+  ASSERT_NE(std::string::npos, dot.find("/pub_a"));
+  ASSERT_EQ(std::string::npos, dot.find("/pub_b"));
+  ASSERT_NE(std::string::npos, dot.find("/sub"));
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "HealthAnalyzerTestNode");
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <autoware_health_checker/health_aggregator/status_monitor.h>
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+#include <string>
+#include <vector>
+
+using AwDiagStatus = autoware_system_msgs::DiagnosticStatus;
+using NodeStatus = autoware_system_msgs::NodeStatus;
+
+namespace
+{
+struct ExpectedStatus
+{
+  std::string name;
+  std::string value;
+  autoware_health_checker::ErrorLevel level;
+  double start;
+};
+
+void checkStatus(const NodeStatus& status, const std::vector<ExpectedStatus>& expected)
+{
+  ASSERT_EQ(ros::this_node::getName(), status.node_name);
+  ASSERT_TRUE(status.node_activated);
+  ASSERT_EQ(expected.size(), status.status.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    ASSERT_EQ(1u, status.status.at(i).status.size());
+    const AwDiagStatus& diag = status.status.at(i).status.front();
+    EXPECT_EQ(expected.at(i).name + "_node_status_rate_slow", diag.key);
+    EXPECT_EQ(expected.at(i).name + " node_status rate slow", diag.description);
+    EXPECT_EQ(AwDiagStatus::UNEXPECTED_RATE, diag.type);
+    EXPECT_EQ(expected.at(i).value, diag.value) << expected.at(i).name;
+    EXPECT_EQ(expected.at(i).level, diag.level) << expected.at(i).name;
+    EXPECT_EQ(ros::Time(expected.at(i).start), diag.header.stamp) << expected.at(i).name;
+  }
+}
+}  // namespace
+
+TEST(StatusMonitorTestSuite, BufferAfterUpdates)
+{
+  StatusMonitor monitor;
+  ros::Time::setNow(ros::Time(100.0));
+  monitor.updateStamp("node_b", 1.0);
+  monitor.updateStamp("node_c", 5.0);
+
+  ros::Time::setNow(ros::Time(102.0));
+  checkStatus(monitor.getMonitorStatus(), {
+    { "node_b", "2", AwDiagStatus::ERROR, 100.0 },
+    { "node_c", "2", AwDiagStatus::OK, 100.0 }
+  });
+  EXPECT_EQ(ros::Time(102.0), monitor.getMonitorStatus().header.stamp);
+
+  // a known node only restarts its timer
+  ros::Time::setNow(ros::Time(102.5));
+  monitor.updateStamp("node_b", 1.0);
+  ros::Time::setNow(ros::Time(103.0));
+  checkStatus(monitor.getMonitorStatus(), {
+    { "node_b", "0.5", AwDiagStatus::OK, 102.5 },
+    { "node_c", "3", AwDiagStatus::OK, 100.0 }
+  });
+
+  // a new node sorts before the known ones, their statuses move with their keys
+  monitor.updateStamp("node_a", 2.0);
+  ros::Time::setNow(ros::Time(106.0));
+  checkStatus(monitor.getMonitorStatus(), {
+    { "node_a", "3", AwDiagStatus::ERROR, 103.0 },
+    { "node_b", "3.5", AwDiagStatus::ERROR, 102.5 },
+    { "node_c", "6", AwDiagStatus::ERROR, 100.0 }
+  });
+
+  // empty names are ignored
+  monitor.updateStamp("", 1.0);
+  EXPECT_EQ(3u, monitor.getMonitorStatus().status.size());
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
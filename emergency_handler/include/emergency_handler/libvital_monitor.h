@@ -20,6 +20,7 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <unordered_map>
 #include <algorithm>
 #include <autoware_system_msgs/SystemStatus.h>
 
@@ -50,6 +51,17 @@ struct LifeTime
   }
 };
 
+struct MonitoredNode
+{
+  MonitoredNode(const std::string& name, const LifeTime& life_time) :
+    name_(name), life_time_(life_time), dead_(false) {}
+
+  std::string name_;
+  LifeTime life_time_;
+  bool dead_;
+  autoware_system_msgs::NodeStatus dead_status_;  // reported while the node is dead, the headers are set on use
+};
+
 class VitalMonitor
 {
 public:
@@ -63,7 +75,9 @@ public:
     createNodeStatus(std::string dead_node_name, std_msgs::Header* const header, int level) const;
 
 private:
-  std::map<std::string, LifeTime> required_nodes_;
+  std::vector<MonitoredNode> required_nodes_;  // sorted by name
+  std::unordered_map<std::string, size_t> required_index_;
+  std::vector<char> available_;
   std::map<std::string, int> dead_nodes_;
 };
 
@@ -30,37 +30,45 @@ void VitalMonitor::updateNodeStatus(const std::vector<std::string>& available_no
   const double diff = (current - previous).toSec();
   previous = current;
 
+  available_.assign(required_nodes_.size(), false);
   for (const auto& node : available_nodes)
   {
-    if (dead_nodes_.count(node) != 0)
+    const auto found = required_index_.find(node);
+    if (found == required_index_.end())
+    {
+      continue;
+    }
+    auto& required = required_nodes_.at(found->second);
+    available_.at(found->second) = true;
+    if (required.dead_)
     {
       ROS_INFO("%s is switched to be available", node.c_str());
-      required_nodes_.at(node).reset();
+      required.life_time_.reset();
+      required.dead_ = false;
       dead_nodes_.erase(node);
     }
   }
 
-  for (auto& node : required_nodes_)
+  for (size_t i = 0; i < required_nodes_.size(); i++)
   {
-    const std::string node_name = node.first;
-    const auto& found = std::find(available_nodes.begin(), available_nodes.end(), node_name);
-    if (found == available_nodes.end())
+    auto& node = required_nodes_.at(i);
+    if (!available_.at(i))
     {
-      node.second.spend(diff);
+      node.life_time_.spend(diff);
     }
     else
     {
-      node.second.activate();
+      node.life_time_.activate();
     }
   }
 
-  for (const auto& node : required_nodes_)
+  for (auto& node : required_nodes_)
   {
-    const std::string node_name = node.first;
-    if (dead_nodes_.count(node_name) == 0 && node.second.isDead())
+    if (!node.dead_ && node.life_time_.isDead())
     {
-      ROS_INFO("%s is not available", node_name.c_str());
-      dead_nodes_.emplace(node_name, node.second.level_);
+      ROS_INFO("%s is not available", node.name_.c_str());
+      node.dead_ = true;
+      dead_nodes_.emplace(node.name_, node.life_time_.level_);
     }
   }
 }
@@ -69,13 +77,24 @@ void VitalMonitor::initMonitoredNodeList(const ros::NodeHandle& pnh)
 {
   XmlRpc::XmlRpcValue params;
   pnh.getParam("vital_monitor", params);
+  std::map<std::string, LifeTime> required_nodes;
   for (const auto& param : params)
   {
     std::string node_name = "/" + param.first;
     auto val = param.second;
     const double timeout_sec = val.hasMember("timeout") ? static_cast<double>(val["timeout"]) : 0.1;
     const int level = val.hasMember("level") ? static_cast<int>(val["level"]) : 1;
-    required_nodes_.emplace(node_name, LifeTime(timeout_sec, level));
+    required_nodes.emplace(node_name, LifeTime(timeout_sec, level));
+  }
+
+  required_nodes_.clear();
+  required_index_.clear();
+  std_msgs::Header header;
+  for (const auto& node : required_nodes)
+  {
+    required_index_.emplace(node.first, required_nodes_.size());
+    required_nodes_.emplace_back(node.first, node.second);
+    required_nodes_.back().dead_status_ = createNodeStatus(node.first, &header, node.second.level_);
   }
   dead_nodes_.clear();
 }
@@ -113,21 +132,38 @@ autoware_system_msgs::NodeStatus VitalMonitor::createNodeStatus(std::string dead
 
 void VitalMonitor::addDeadNodes(std::shared_ptr<autoware_system_msgs::SystemStatus> const status) const
 {
-  for (auto& node : dead_nodes_)
+  if (dead_nodes_.empty())
   {
-    const std::string name = node.first;
-    const int level = node.second;
-    auto& array = status->node_status;
-    auto found = std::find_if(array.begin(), array.end(),
-    [&](autoware_system_msgs::NodeStatus& stat) {return (name == stat.node_name);});  // NOLINT
-    if (found == array.end())
+    return;
+  }
+
+  auto& array = status->node_status;
+  std::unordered_map<std::string, size_t> status_index;  // first status of each node
+  status_index.reserve(array.size());
+  for (size_t i = 0; i < array.size(); i++)
+  {
+    status_index.emplace(array.at(i).node_name, i);
+  }
+
+  for (const auto& node : required_nodes_)
+  {
+    if (!node.dead_)
+    {
+      continue;
+    }
+    const auto found = status_index.find(node.name_);
+    if (found == status_index.end())
     {
-      array.emplace_back(createNodeStatus(name, &status->header, level));
+      array.emplace_back(node.dead_status_);
+      array.back().header = status->header;
+      array.back().status.back().status.back().header = status->header;
     }
     else
     {
-      found->node_activated = true;
-      found->status.emplace_back(createDiagnosticStatusArray(name, &status->header, level));
+      auto& stat = array.at(found->second);
+      stat.node_activated = true;
+      stat.status.emplace_back(node.dead_status_.status.back());
+      stat.status.back().status.back().header = status->header;
     }
   }
 }
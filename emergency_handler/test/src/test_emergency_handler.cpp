@@ -16,10 +16,14 @@
 #include <ros/ros.h>
 #include <iostream>
 #include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
 #include <gtest/gtest.h>
 #include <emergency_handler/emergency_handler.h>
 #include <emergency_handler/emergency_stop_planner.h>
 #include <emergency_handler/system_status_filter.h>
+#include <emergency_handler/libvital_monitor.h>
 #include "autoware_msgs/VehicleCmd.h"
 
 class MyEmergencyHandler : public EmergencyHandler
@@ -294,6 +298,75 @@ TEST_F(EmergencyHandlerTestSuite, NodeStatusCallback)
   nodeStatusCallback();
 }
 
+TEST(VitalMonitorTestSuite, UpdateNodeStatusAndAddDeadNodes)
+{
+  ros::NodeHandle pnh("~");
+  VitalMonitor monitor;
+  monitor.initMonitoredNodeList(pnh);
+
+  const std::vector<std::string> all_nodes = { "/test_node_a", "/test_node_b", "/not_monitored" };
+  const std::vector<std::string> without_a = { "/test_node_b" };
+
+  // nodes are activated by their first appearance
+  monitor.updateNodeStatus(all_nodes);
+  ASSERT_TRUE(monitor.getDeadNodes().empty());
+
+  // test_node_a runs out of its life time
+  ros::WallDuration(0.2).sleep();
+  monitor.updateNodeStatus(without_a);
+  ASSERT_EQ(monitor.getDeadNodes().size(), 1);
+  ASSERT_EQ(monitor.getDeadNodes().count("/test_node_a"), 1);
+  ASSERT_EQ(monitor.getDeadNodes().at("/test_node_a"), 2);
+
+  std_msgs::Header header;
+  header.seq = 7;
+
+  // the dead node is not in the status, so its dead status is appended
+  auto status = std::make_shared<autoware_system_msgs::SystemStatus>();
+  status->header = header;
+  status->node_status.emplace_back(monitor.createNodeStatus("/test_node_b", &header, 0));
+  monitor.addDeadNodes(status);
+  ASSERT_EQ(status->node_status.size(), 2);
+  const auto& appended = status->node_status.at(1);
+  ASSERT_STREQ(appended.node_name.c_str(), "/test_node_a");
+  ASSERT_TRUE(appended.node_activated);
+  ASSERT_EQ(appended.header.seq, 7);
+  ASSERT_EQ(appended.status.size(), 1);
+  ASSERT_STREQ(appended.status.at(0).status.at(0).key.c_str(), "node_test_node_a_dead");
+  ASSERT_EQ(appended.status.at(0).status.at(0).level, 2);
+  ASSERT_EQ(appended.status.at(0).status.at(0).header.seq, 7);
+
+  // the dead node is already in the status, so the dead status is added to its first entry
+  status = std::make_shared<autoware_system_msgs::SystemStatus>();
+  status->header = header;
+  status->node_status.emplace_back(monitor.createNodeStatus("/test_node_a", &header, 1));
+  status->node_status.back().node_activated = false;
+  status->node_status.emplace_back(monitor.createNodeStatus("/test_node_a", &header, 1));
+  monitor.addDeadNodes(status);
+  ASSERT_EQ(status->node_status.size(), 2);
+  const auto& present = status->node_status.at(0);
+  ASSERT_TRUE(present.node_activated);
+  ASSERT_EQ(present.status.size(), 2);
+  ASSERT_EQ(present.status.at(1).status.at(0).level, 2);
+  ASSERT_EQ(present.status.at(1).status.at(0).header.seq, 7);
+  ASSERT_EQ(status->node_status.at(1).status.size(), 1);
+
+  // test_node_a comes back and nothing is added any more
+  monitor.updateNodeStatus(all_nodes);
+  ASSERT_TRUE(monitor.getDeadNodes().empty());
+  status = std::make_shared<autoware_system_msgs::SystemStatus>();
+  monitor.addDeadNodes(status);
+  ASSERT_TRUE(status->node_status.empty());
+
+  // the revived node got its life time back and can die again
+  monitor.updateNodeStatus(without_a);
+  ASSERT_TRUE(monitor.getDeadNodes().empty());
+  ros::WallDuration(0.2).sleep();
+  monitor.updateNodeStatus(without_a);
+  ASSERT_EQ(monitor.getDeadNodes().size(), 1);
+  ASSERT_EQ(monitor.getDeadNodes().count("/test_node_a"), 1);
+}
+
 // Run all the tests that were declared with TEST()
 int main(int argc, char** argv)
 {
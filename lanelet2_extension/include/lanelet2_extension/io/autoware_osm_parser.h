@@ -19,6 +19,7 @@
 #ifndef LANELET2_EXTENSION_IO_AUTOWARE_OSM_PARSER_H
 #define LANELET2_EXTENSION_IO_AUTOWARE_OSM_PARSER_H
 
+#include <lanelet2_core/primitives/LineString.h>
 #include <lanelet2_io/io_handlers/OsmHandler.h>
 
 #include <string>
@@ -35,7 +36,7 @@ public:
   /**
    * [parse parse osm file to laneletMap. It is generally same as default
    * OsmParser, but it will overwrite x and y value with local_x and local_y
-   * tags if present]
+   * tags if present. Already aligned lanelet bounds are left untouched]
    * @param  filename [path to osm file]
    * @param  errors   [any errors catched during parsing]
    * @return          [returns LaneletMap]
@@ -43,13 +44,24 @@ public:
   std::unique_ptr<LaneletMap> parse(const std::string& filename, ErrorMessages& errors) const;  // NOLINT
 
   /**
-   * [parseVersions parses MetaInfo tags from osm file]
+   * [parseVersions parses MetaInfo tags from osm file. Only the head of the
+   * file up to the MetaInfo tag is read]
    * @param filename       [path to osm file]
    * @param format_version [parsed information about map format version]
    * @param map_version    [parsed information about map version]
    */
   static void parseVersions(const std::string& filename, std::string* format_version, std::string* map_version);
 
+  /**
+   * [isAligned cheap test whether geometry::align would return the bounds
+   * unchanged: both bounds run in the same direction and the right bound lies
+   * right of the left one]
+   * @param left  [left bound of a lanelet]
+   * @param right [right bound of a lanelet]
+   * @return      [true if the bounds are already aligned]
+   */
+  static bool isAligned(const ConstLineString3d& left, const ConstLineString3d& right);
+
   static constexpr const char* extension()
   {
     return ".osm";
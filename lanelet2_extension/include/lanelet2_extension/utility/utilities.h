@@ -21,12 +21,14 @@
 
 #include <geometry_msgs/Point.h>
 
+#include <lanelet2_core/primitives/LineString.h>
 #include <lanelet2_routing/Route.h>
 #include <lanelet2_routing/RoutingGraph.h>
 
 #include <autoware_msgs/LaneArray.h>
 
 #include <map>
+#include <vector>
 
 namespace lanelet
 {
@@ -51,6 +53,40 @@ void matchWaypointAndLanelet(const lanelet::LaneletMapPtr lanelet_map,
  */
 void overwriteLaneletsCenterline(lanelet::LaneletMapPtr lanelet_map, const bool force_overite = false);
 
+/**
+ * [interpolatePoints linearly interpolates the line string at the given arc lengths]
+ * All resampling functions walk the line string and the targets once, O(N + M).
+ * Lengths are measured in the dimension of the line string, targets outside
+ * [0, length] are clamped to the end points.
+ * @param line_string    [line string to interpolate]
+ * @param target_lengths [arc lengths from the first point, in ascending order]
+ * @return               [one point per target length, empty if the line string is empty]
+ */
+std::vector<lanelet::BasicPoint3d> interpolatePoints(const lanelet::ConstLineString3d& line_string,
+                                                     const std::vector<double>& target_lengths);
+std::vector<lanelet::BasicPoint2d> interpolatePoints(const lanelet::ConstLineString2d& line_string,
+                                                     const std::vector<double>& target_lengths);
+
+/**
+ * [resamplePoints resamples the line string into segments of equal length]
+ * @param line_string  [line string to resample]
+ * @param num_segments [number of segments, at least 1]
+ * @return             [num_segments + 1 points including both end points]
+ */
+std::vector<lanelet::BasicPoint3d> resamplePoints(const lanelet::ConstLineString3d& line_string, const int num_segments);
+std::vector<lanelet::BasicPoint2d> resamplePoints(const lanelet::ConstLineString2d& line_string, const int num_segments);
+
+/**
+ * [resamplePointsBySpacing resamples the line string every spacing meters]
+ * @param line_string [line string to resample]
+ * @param spacing     [distance between the points along the line string, greater than 0]
+ * @return            [points from the first point every spacing meters, then the last point]
+ */
+std::vector<lanelet::BasicPoint3d> resamplePointsBySpacing(const lanelet::ConstLineString3d& line_string,
+                                                           const double spacing);
+std::vector<lanelet::BasicPoint2d> resamplePointsBySpacing(const lanelet::ConstLineString2d& line_string,
+                                                           const double spacing);
+
 }  // namespace utils
 }  // namespace lanelet
 
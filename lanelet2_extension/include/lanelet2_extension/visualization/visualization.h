@@ -36,8 +36,8 @@ namespace lanelet
 namespace visualization
 {
 /**
- * [polygon2Triangle converts polygon into vector of triangles. Used for
- * triangulation]
+ * [polygon2Triangle converts polygon into vector of triangles using ear
+ * clipping. Used for triangulation]
  * @param polygon        [input polygon]
  * @param triangles [array of polygon message, each containing 3 vertices]
  */
@@ -45,7 +45,8 @@ void polygon2Triangle(const geometry_msgs::Polygon& polygon,
                                      std::vector<geometry_msgs::Polygon>* triangles);
 /**
  * [lanelet2Triangle converts lanelet into vector of triangles. Used for
- * triangulation]
+ * triangulation. Triangulates the strip between left and right bound in
+ * linear time, and falls back to polygon2Triangle if the strip is invalid]
  * @param ll        [input lanelet]
  * @param triangles [array of polygon message, each containing 3 vertices]
  */
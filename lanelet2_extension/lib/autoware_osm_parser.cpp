@@ -23,19 +23,83 @@
 #include <lanelet2_io/io_handlers/OsmFile.h>
 #include <lanelet2_io/io_handlers/OsmHandler.h>
 
+#include <fstream>
 #include <string>
+#include <vector>
 
 namespace lanelet
 {
 namespace io_handlers
 {
+namespace
+{
+// scans the file chunk by chunk for the MetaInfo tag so that the version can be read
+// without building a DOM of the whole map. The tag is written right after <osm>,
+// so usually only the first chunk has to be read.
+bool readMetaInfoTag(std::istream& stream, std::string* tag)
+{
+  const std::string key = "<MetaInfo";
+  std::vector<char> chunk(64 * 1024);
+  std::string buffer;
+  std::size_t begin = std::string::npos;
+
+  while (stream)
+  {
+    stream.read(chunk.data(), chunk.size());
+    buffer.append(chunk.data(), stream.gcount());
+
+    if (begin == std::string::npos)
+    {
+      begin = buffer.find(key);
+      if (begin == std::string::npos)
+      {
+        // keep only the tail that might hold the beginning of the key
+        if (buffer.size() >= key.size())
+        {
+          buffer.erase(0, buffer.size() - key.size() + 1);
+        }
+        continue;
+      }
+    }
+
+    const std::size_t end = buffer.find('>', begin);
+    if (end != std::string::npos)
+    {
+      *tag = buffer.substr(begin, end - begin + 1);
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace
+
+bool AutowareOsmParser::isAligned(const ConstLineString3d& left, const ConstLineString3d& right)
+{
+  if (left.size() < 2 || right.size() < 2)
+  {
+    return false;
+  }
+  const BasicPoint2d left_dir = left.back().basicPoint2d() - left.front().basicPoint2d();
+  const BasicPoint2d right_dir = right.back().basicPoint2d() - right.front().basicPoint2d();
+  if (left_dir.dot(right_dir) <= 0)
+  {
+    return false;
+  }
+  const BasicPoint2d offset = (right.front().basicPoint2d() + right.back().basicPoint2d()) * 0.5 -
+                              (left.front().basicPoint2d() + left.back().basicPoint2d()) * 0.5;
+  return left_dir.x() * offset.y() - left_dir.y() * offset.x() < 0;
+}
+
 std::unique_ptr<LaneletMap> AutowareOsmParser::parse(const std::string& filename, ErrorMessages& errors) const
 {
   auto map = OsmParser::parse(filename, errors);
 
   // overwrite x and y values if there are local_x, local_y tags
-  for (Point3d point : map->pointLayer)
+  std::vector<Point3d> points(map->pointLayer.begin(), map->pointLayer.end());
+#pragma omp parallel for
+  for (std::size_t i = 0; i < points.size(); i++)
   {
+    Point3d& point = points.at(i);
     if (point.hasAttribute("local_x"))
     {
       point.x() = point.attribute("local_x").asDouble().value();
@@ -47,8 +111,15 @@ std::unique_ptr<LaneletMap> AutowareOsmParser::parse(const std::string& filename
   }
 
   // rerun align function in just in case
-  for (Lanelet& lanelet : map->laneletLayer)
+  std::vector<Lanelet> lanelets(map->laneletLayer.begin(), map->laneletLayer.end());
+#pragma omp parallel for
+  for (std::size_t i = 0; i < lanelets.size(); i++)
   {
+    Lanelet& lanelet = lanelets.at(i);
+    if (isAligned(lanelet.leftBound(), lanelet.rightBound()))
+    {
+      continue;
+    }
     LineString3d new_left, new_right;
     std::tie(new_left, new_right) = geometry::align(lanelet.leftBound(), lanelet.rightBound());
     lanelet.setLeftBound(new_left);
@@ -72,15 +143,30 @@ void AutowareOsmParser::parseVersions(const std::string& filename, std::string*
     return;
   }
 
+  std::ifstream file(filename, std::ios::binary);
+  if (!file)
+  {
+    throw lanelet::ParseError(std::string("Errors occured while parsing osm file: File was not found"));
+  }
+
+  std::string tag;
+  if (!readMetaInfoTag(file, &tag))
+  {
+    return;
+  }
+  if (tag.compare(tag.size() - 2, 2, "/>") != 0)
+  {
+    tag.insert(tag.size() - 1, "/");
+  }
+
   pugi::xml_document doc;
-  auto result = doc.load_file(filename.c_str());
+  auto result = doc.load_buffer(tag.data(), tag.size());
   if (!result)
   {
     throw lanelet::ParseError(std::string("Errors occured while parsing osm file: ") + result.description());
   }
 
-  auto osmNode = doc.child("osm");
-  auto metainfo = osmNode.child("MetaInfo");
+  auto metainfo = doc.child("MetaInfo");
   if (metainfo.attribute("format_version"))
     *format_version = metainfo.attribute("format_version").value();
   if (metainfo.attribute("map_version"))
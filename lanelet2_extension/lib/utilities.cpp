@@ -26,6 +26,7 @@
 #include <ros/ros.h>
 
 #include <algorithm>
+#include <cmath>
 #include <map>
 #include <utility>
 #include <vector>
@@ -219,93 +220,95 @@ void getContactingLanelets(const lanelet::LaneletMapPtr lanelet_map,
   }
 }
 
-std::vector<double> calculateSegmentDistances(const lanelet::ConstLineString3d& line_string)
+template <typename BasicPointT, typename LineStringT>
+double calculateLength(const LineStringT& line_string)
 {
-  std::vector<double> segment_distances;
-  segment_distances.reserve(line_string.size() - 1);
-
+  double length = 0;
   for (size_t i = 1; i < line_string.size(); ++i)
   {
-    const auto distance = lanelet::geometry::distance2d(line_string[i], line_string[i - 1]);
-    segment_distances.push_back(distance);
+    const BasicPointT back_point = line_string[i - 1].basicPoint();
+    const BasicPointT front_point = line_string[i].basicPoint();
+    length += (front_point - back_point).norm();
   }
-
-  return segment_distances;
-}
-
-std::vector<double> calculateAccumulatedLengths(const lanelet::ConstLineString3d& line_string)
-{
-  const auto segment_distances = calculateSegmentDistances(line_string);
-
-  std::vector<double> accumulated_lengths{ 0 };
-  accumulated_lengths.reserve(segment_distances.size() + 1);
-  std::partial_sum(std::begin(segment_distances), std::end(segment_distances), std::back_inserter(accumulated_lengths));
-
-  return accumulated_lengths;
+  return length;
 }
 
-std::pair<size_t, size_t> findNearestIndexPair(const std::vector<double>& accumulated_lengths,
-                                               const double target_length)
+// single walk over the segments, the targets are ascending so the segment of a target is never behind the previous one
+template <typename BasicPointT, typename LineStringT>
+std::vector<BasicPointT> interpolatePointsImpl(const LineStringT& line_string, const std::vector<double>& target_lengths)
 {
-  // List size
-  const auto N = accumulated_lengths.size();
+  std::vector<BasicPointT> points;
+  if (line_string.empty())
+    return points;
 
-  // Front
-  if (target_length < accumulated_lengths.at(1))
+  points.reserve(target_lengths.size());
+  if (line_string.size() == 1)
   {
-    return std::make_pair(0, 1);
+    const BasicPointT point = line_string[0].basicPoint();
+    points.resize(target_lengths.size(), point);
+    return points;
   }
 
-  // Back
-  if (target_length > accumulated_lengths.at(N - 2))
+  size_t front_index = 1;
+  BasicPointT back_point = line_string[0].basicPoint();
+  BasicPointT front_point = line_string[1].basicPoint();
+  double back_length = 0;
+  double segment_length = (front_point - back_point).norm();
+  for (const auto target_length : target_lengths)
   {
-    return std::make_pair(N - 2, N - 1);
-  }
+    while (target_length > back_length + segment_length && front_index + 1 < line_string.size())
+    {
+      ++front_index;
+      back_point = front_point;
+      front_point = line_string[front_index].basicPoint();
+      back_length += segment_length;
+      segment_length = (front_point - back_point).norm();
+    }
 
-  // Middle
-  for (auto i = 1; i < N; ++i)
-  {
-    if (accumulated_lengths.at(i - 1) <= target_length && target_length <= accumulated_lengths.at(i))
+    if (segment_length <= 0)
     {
-      return std::make_pair(i - 1, i);
+      points.push_back(back_point);
+      continue;
     }
+    const double ratio = std::min(std::max((target_length - back_length) / segment_length, 0.0), 1.0);
+    points.push_back(back_point + (front_point - back_point) * ratio);
   }
 
-  // Throw an exception because this never happens
-  throw std::runtime_error("No nearest point found.");
+  return points;
 }
 
-std::vector<lanelet::BasicPoint3d> resamplePoints(const lanelet::ConstLineString3d& line_string, const int num_segments)
+template <typename BasicPointT, typename LineStringT>
+std::vector<BasicPointT> resamplePointsImpl(const LineStringT& line_string, const int num_segments)
 {
-  // Calculate length
-  const auto line_length = lanelet::geometry::length(line_string);
+  const int n = std::max(num_segments, 1);
+  const double line_length = calculateLength<BasicPointT>(line_string);
 
-  // Calculate accumulated lengths
-  const auto accumulated_lengths = calculateAccumulatedLengths(line_string);
+  std::vector<double> target_lengths;
+  target_lengths.reserve(n + 1);
+  for (int i = 0; i <= n; ++i)
+    target_lengths.push_back((static_cast<double>(i) / n) * line_length);
 
-  // Create each segment
-  std::vector<lanelet::BasicPoint3d> resampled_points;
-  for (auto i = 0; i <= num_segments; ++i)
-  {
-    // Find two nearest points
-    const auto target_length = (static_cast<double>(i) / num_segments) * line_length;
-    const auto index_pair = findNearestIndexPair(accumulated_lengths, target_length);
-
-    // Apply linear interpolation
-    const lanelet::BasicPoint3d back_point = line_string[index_pair.first];
-    const lanelet::BasicPoint3d front_point = line_string[index_pair.second];
-    const auto direction_vector = (front_point - back_point);
-
-    const auto back_length = accumulated_lengths.at(index_pair.first);
-    const auto front_length = accumulated_lengths.at(index_pair.second);
-    const auto segment_length = front_length - back_length;
-    const auto target_point = back_point + (direction_vector * (target_length - back_length) / segment_length);
-
-    // Add to list
-    resampled_points.push_back(target_point);
-  }
+  return interpolatePointsImpl<BasicPointT>(line_string, target_lengths);
+}
+
+template <typename BasicPointT, typename LineStringT>
+std::vector<BasicPointT> resamplePointsBySpacingImpl(const LineStringT& line_string, const double spacing)
+{
+  const double line_length = calculateLength<BasicPointT>(line_string);
+  if (spacing <= 0)
+    return interpolatePointsImpl<BasicPointT>(line_string, { 0, line_length });
+
+  // the last regular point is dropped when it would be a duplicate of the end point, the first one is always kept
+  constexpr double epsilon = 1e-6;
+  const size_t num_points = static_cast<size_t>(std::max(1.0, std::ceil((line_length - epsilon) / spacing)));
+
+  std::vector<double> target_lengths;
+  target_lengths.reserve(num_points + 1);
+  for (size_t i = 0; i < num_points; ++i)
+    target_lengths.push_back(i * spacing);
+  target_lengths.push_back(line_length);
 
-  return resampled_points;
+  return interpolatePointsImpl<BasicPointT>(line_string, target_lengths);
 }
 
 lanelet::LineString3d generateFineCenterline(const lanelet::ConstLanelet& lanelet_obj)
@@ -338,6 +341,40 @@ lanelet::LineString3d generateFineCenterline(const lanelet::ConstLanelet& lanele
 
 }  // namespace
 
+std::vector<lanelet::BasicPoint3d> interpolatePoints(const lanelet::ConstLineString3d& line_string,
+                                                     const std::vector<double>& target_lengths)
+{
+  return interpolatePointsImpl<lanelet::BasicPoint3d>(line_string, target_lengths);
+}
+
+std::vector<lanelet::BasicPoint2d> interpolatePoints(const lanelet::ConstLineString2d& line_string,
+                                                     const std::vector<double>& target_lengths)
+{
+  return interpolatePointsImpl<lanelet::BasicPoint2d>(line_string, target_lengths);
+}
+
+std::vector<lanelet::BasicPoint3d> resamplePoints(const lanelet::ConstLineString3d& line_string, const int num_segments)
+{
+  return resamplePointsImpl<lanelet::BasicPoint3d>(line_string, num_segments);
+}
+
+std::vector<lanelet::BasicPoint2d> resamplePoints(const lanelet::ConstLineString2d& line_string, const int num_segments)
+{
+  return resamplePointsImpl<lanelet::BasicPoint2d>(line_string, num_segments);
+}
+
+std::vector<lanelet::BasicPoint3d> resamplePointsBySpacing(const lanelet::ConstLineString3d& line_string,
+                                                           const double spacing)
+{
+  return resamplePointsBySpacingImpl<lanelet::BasicPoint3d>(line_string, spacing);
+}
+
+std::vector<lanelet::BasicPoint2d> resamplePointsBySpacing(const lanelet::ConstLineString2d& line_string,
+                                                           const double spacing)
+{
+  return resamplePointsBySpacingImpl<lanelet::BasicPoint2d>(line_string, spacing);
+}
+
 void matchWaypointAndLanelet(const lanelet::LaneletMapPtr lanelet_map,
                              const lanelet::routing::RoutingGraphPtr routing_graph,
                              const autoware_msgs::LaneArray& lane_array,
@@ -33,27 +33,6 @@
 
 namespace
 {
-void adjacentPoints(const int i, const int N, const geometry_msgs::Polygon poly, geometry_msgs::Point32* p0,
-                    geometry_msgs::Point32* p1, geometry_msgs::Point32* p2)
-{
-  if (p0 == nullptr || p1 == nullptr || p2 == nullptr)
-  {
-    ROS_ERROR_STREAM(__FUNCTION__ << ": either p0, p1, or p2 is null pointer!");
-    return;
-  }
-
-  *p1 = poly.points[i];
-  if (i == 0)
-    *p0 = poly.points[N - 1];
-  else
-    *p0 = poly.points[i - 1];
-
-  if (i < N - 1)
-    *p2 = poly.points[i + 1];
-  else
-    *p2 = poly.points[0];
-}
-
 double hypot(const geometry_msgs::Point32& p0, const geometry_msgs::Point32& p1)
 {
   return (sqrt(pow((p1.x - p0.x), 2.0) + pow((p1.y - p0.y), 2.0)));
@@ -223,13 +202,6 @@ void laneletDirectionAsMarker(const lanelet::ConstLanelet ll, visualization_msgs
   }
 }
 
-bool isReflexAngle(const geometry_msgs::Point32& a, const geometry_msgs::Point32& o, const geometry_msgs::Point32& b)
-{
-  // angle aob is reflex in counterclock wise direction if point b is on the right side of vector oa
-  // which can be found out by calculating cross product of oa and ob
-  return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x) < 0;
-}
-
 bool isWithinTriangle(const geometry_msgs::Point32& a, const geometry_msgs::Point32& b, const geometry_msgs::Point32& c,
                       const geometry_msgs::Point32& p)
 {
@@ -240,6 +212,79 @@ bool isWithinTriangle(const geometry_msgs::Point32& a, const geometry_msgs::Poin
   return (side1 > 0.0 && side2 > 0.0 && side3 > 0.0) || (side1 < 0.0 && side2 < 0.0 && side3 < 0.0);
 }
 
+// twice the signed area of triangle abc, positive if counter clockwise
+double signedArea2(const geometry_msgs::Point32& a, const geometry_msgs::Point32& b, const geometry_msgs::Point32& c)
+{
+  return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+// twice the signed area of polygon, positive if counter clockwise
+double signedArea2(const std::vector<geometry_msgs::Point32>& points)
+{
+  double area = 0.0;
+  for (size_t i = 0, j = points.size() - 1; i < points.size(); j = i++)
+    area += static_cast<double>(points[j].x) * points[i].y - static_cast<double>(points[i].x) * points[j].y;
+  return area;
+}
+
+void pushTriangle(const geometry_msgs::Point32& p0, const geometry_msgs::Point32& p1, const geometry_msgs::Point32& p2,
+                  std::vector<geometry_msgs::Polygon>* triangles)
+{
+  geometry_msgs::Polygon triangle;
+  triangle.points.reserve(3);
+  triangle.points.push_back(p0);
+  triangle.points.push_back(p1);
+  triangle.points.push_back(p2);
+  triangles->push_back(triangle);
+}
+
+// Triangulates the strip between two bounds in linear time, always advancing on the bound that gives the shorter
+// diagonal. Triangles are oriented like the lanelet polygon (left bound forward, right bound backward).
+// Returns false without touching triangles if any triangle is inverted, i.e. the strip does not cover the polygon.
+bool strip2Triangle(const std::vector<geometry_msgs::Point32>& left, const std::vector<geometry_msgs::Point32>& right,
+                    std::vector<geometry_msgs::Polygon>* triangles)
+{
+  if (left.empty() || right.empty() || left.size() + right.size() < 3)
+    return false;
+
+  std::vector<geometry_msgs::Point32> polygon_points(left);
+  polygon_points.insert(polygon_points.end(), right.rbegin(), right.rend());
+  const double orientation = signedArea2(polygon_points) < 0.0 ? -1.0 : 1.0;
+
+  std::vector<geometry_msgs::Polygon> strip;
+  strip.reserve(left.size() + right.size() - 2);
+  size_t i = 0, j = 0;
+  while (i + 1 < left.size() || j + 1 < right.size())
+  {
+    bool advance_left;
+    if (i + 1 >= left.size())
+      advance_left = false;
+    else if (j + 1 >= right.size())
+      advance_left = true;
+    else
+      advance_left = hypot(left[i + 1], right[j]) <= hypot(left[i], right[j + 1]);
+
+    // polygon order is ..., l_i, l_i+1, ..., r_j+1, r_j, ...
+    if (advance_left)
+    {
+      if (signedArea2(left[i], left[i + 1], right[j]) * orientation < 0.0)
+        return false;
+      pushTriangle(left[i], left[i + 1], right[j], &strip);
+      ++i;
+    }
+    else
+    {
+      if (signedArea2(right[j + 1], right[j], left[i]) * orientation < 0.0)
+        return false;
+      pushTriangle(right[j + 1], right[j], left[i], &strip);
+      ++j;
+    }
+  }
+
+  triangles->insert(triangles->end(), strip.begin(), strip.end());
+  return true;
+}
+
 }  // anonymous namespace
 
 namespace lanelet
@@ -253,6 +298,25 @@ void visualization::lanelet2Triangle(const lanelet::ConstLanelet& ll, std::vecto
   }
 
   triangles->clear();
+
+  std::vector<geometry_msgs::Point32> left, right;
+  left.reserve(ll.leftBound3d().size());
+  right.reserve(ll.rightBound3d().size());
+  for (const auto& pt : ll.leftBound3d())
+  {
+    geometry_msgs::Point32 pt32;
+    utils::conversion::toGeomMsgPt32(pt.basicPoint(), &pt32);
+    left.push_back(pt32);
+  }
+  for (const auto& pt : ll.rightBound3d())
+  {
+    geometry_msgs::Point32 pt32;
+    utils::conversion::toGeomMsgPt32(pt.basicPoint(), &pt32);
+    right.push_back(pt32);
+  }
+  if (strip2Triangle(left, right, triangles))
+    return;
+
   geometry_msgs::Polygon ll_poly;
   lanelet2Polygon(ll, &ll_poly);
   polygon2Triangle(ll_poly, triangles);
@@ -261,91 +325,91 @@ void visualization::lanelet2Triangle(const lanelet::ConstLanelet& ll, std::vecto
 void visualization::polygon2Triangle(const geometry_msgs::Polygon& polygon,
                                      std::vector<geometry_msgs::Polygon>* triangles)
 {
-  geometry_msgs::Polygon poly = polygon;
-  // ear clipping: find smallest internal angle in polygon
-  int N = poly.points.size();
+  if (triangles == nullptr)
+  {
+    ROS_ERROR_STREAM(__FUNCTION__ << ": triangles is null pointer!");
+    return;
+  }
 
-  // array of angles for each vertex
-  std::vector<bool> is_reflex_angle;
-  is_reflex_angle.assign(N, false);
+  const std::vector<geometry_msgs::Point32>& points = polygon.points;
+  int N = points.size();
+  if (N < 3)
+    return;
+
+  // ear clipping on a linked list of the remaining vertices.
+  // only reflex vertices can lie inside an ear, so only those are checked.
+  const double orientation = signedArea2(points) < 0.0 ? -1.0 : 1.0;
+  std::vector<int> prev(N), next(N);
   for (int i = 0; i < N; i++)
   {
-    geometry_msgs::Point32 p0, p1, p2;
-
-    adjacentPoints(i, N, poly, &p0, &p1, &p2);
-    is_reflex_angle.at(i) = isReflexAngle(p0, p1, p2);
+    prev[i] = (i == 0) ? N - 1 : i - 1;
+    next[i] = (i == N - 1) ? 0 : i + 1;
   }
 
-  // start ear clipping
-  while (N >= 3)
+  std::vector<bool> is_reflex_angle(N, false);
+  std::vector<int> reflex_vertices;
+  for (int i = 0; i < N; i++)
   {
-    int clipped_vertex = -1;
+    is_reflex_angle[i] = signedArea2(points[prev[i]], points[i], points[next[i]]) * orientation < 0.0;
+    if (is_reflex_angle[i])
+      reflex_vertices.push_back(i);
+  }
 
-    for (int i = 0; i < N; i++)
+  triangles->reserve(triangles->size() + N - 2);
+  int i = 0;
+  int checked_vertices = 0;
+  while (N > 3)
+  {
+    bool is_ear = !is_reflex_angle[i];
+    if (is_ear)
     {
-      bool is_reflex = is_reflex_angle.at(i);
-      if (!is_reflex)
+      const geometry_msgs::Point32& p0 = points[prev[i]];
+      const geometry_msgs::Point32& p1 = points[i];
+      const geometry_msgs::Point32& p2 = points[next[i]];
+      for (int j : reflex_vertices)
       {
-        geometry_msgs::Point32 p0, p1, p2;
-        adjacentPoints(i, N, poly, &p0, &p1, &p2);
-
-        int j_begin = (i + 2) % N;
-        int j_end = (i - 1 + N) % N;
-        bool is_ear = true;
-        for (int j = j_begin; j != j_end; j = (j + 1) % N)
+        if (j == prev[i] || j == i || j == next[i] || !is_reflex_angle[j])
+          continue;
+        if (isWithinTriangle(p0, p1, p2, points[j]))
         {
-          if (isWithinTriangle(p0, p1, p2, poly.points.at(j)))
-          {
-            is_ear = false;
-            break;
-          }
-        }
-
-        if (is_ear)
-        {
-          clipped_vertex = i;
+          is_ear = false;
           break;
         }
       }
     }
-    if (clipped_vertex < 0 || clipped_vertex >= N)
+
+    if (!is_ear && ++checked_vertices < N)
+    {
+      i = next[i];
+      continue;
+    }
+    if (!is_ear)
     {
       ROS_ERROR("Could not find valid vertex for ear clipping triangulation. Triangulation result might be invalid");
-      clipped_vertex = 0;
     }
 
-    // create triangle
-    geometry_msgs::Point32 p0, p1, p2;
-    adjacentPoints(clipped_vertex, N, poly, &p0, &p1, &p2);
-    geometry_msgs::Polygon triangle;
-    triangle.points.push_back(p0);
-    triangle.points.push_back(p1);
-    triangle.points.push_back(p2);
-    triangles->push_back(triangle);
-
-    // remove vertex of center of angle
-    auto it = poly.points.begin();
-    std::advance(it, clipped_vertex);
-    poly.points.erase(it);
-
-    // remove from angle list
-    auto it_angle = is_reflex_angle.begin();
-    std::advance(it_angle, clipped_vertex);
-    is_reflex_angle.erase(it_angle);
-
-    // update angle list
-    N = poly.points.size();
-    if (clipped_vertex == N)
+    pushTriangle(points[prev[i]], points[i], points[next[i]], triangles);
+
+    // unlink clipped vertex and update its neighbours
+    const int i_prev = prev[i];
+    const int i_next = next[i];
+    next[i_prev] = i_next;
+    prev[i_next] = i_prev;
+    is_reflex_angle[i] = false;
+    N--;
+    for (int k : { i_prev, i_next })
     {
-      clipped_vertex = 0;
+      const bool was_reflex = is_reflex_angle[k];
+      is_reflex_angle[k] = signedArea2(points[prev[k]], points[k], points[next[k]]) * orientation < 0.0;
+      if (is_reflex_angle[k] && !was_reflex)
+        reflex_vertices.push_back(k);
     }
-    adjacentPoints(clipped_vertex, N, poly, &p0, &p1, &p2);
-    is_reflex_angle.at(clipped_vertex) = isReflexAngle(p0, p1, p2);
 
-    int i_prev = (clipped_vertex == 0) ? N - 1 : clipped_vertex - 1;
-    adjacentPoints(i_prev, N, poly, &p0, &p1, &p2);
-    is_reflex_angle.at(i_prev) = isReflexAngle(p0, p1, p2);
+    i = i_prev;
+    checked_vertices = 0;
   }
+
+  pushTriangle(points[prev[i]], points[i], points[next[i]], triangles);
 }
 
 void visualization::lanelet2Polygon(const lanelet::ConstLanelet& ll, geometry_msgs::Polygon* polygon)
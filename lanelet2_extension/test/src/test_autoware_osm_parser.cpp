@@ -0,0 +1,139 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <lanelet2_core/geometry/LineString.h>
+#include <lanelet2_extension/io/autoware_osm_parser.h>
+#include <lanelet2_extension/utility/utilities.h>
+#include <ros/ros.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <tuple>
+#include <utility>
+
+using lanelet::LineString3d;
+using lanelet::Point3d;
+using lanelet::io_handlers::AutowareOsmParser;
+using lanelet::utils::getId;
+
+class TestSuite : public ::testing::Test
+{
+public:
+  TestSuite() : file_path("/tmp/test_autoware_osm_parser.osm")
+  {
+  }
+  ~TestSuite()
+  {
+    std::remove(file_path.c_str());
+  }
+
+  void writeFile(const std::string& content)
+  {
+    std::ofstream file(file_path, std::ios::binary);
+    file << content;
+  }
+
+  std::string file_path;
+};
+
+TEST_F(TestSuite, ParseVersions)
+{
+  writeFile("<?xml version=\"1.0\"?>\n<osm generator=\"test\">\n"
+            "  <MetaInfo format_version=\"1.0\" map_version=\"2.0\"/>\n</osm>\n");
+
+  std::string format_version, map_version;
+  AutowareOsmParser::parseVersions(file_path, &format_version, &map_version);
+  ASSERT_EQ(format_version, "1.0") << "Parsed format_version should be 1.0";
+  ASSERT_EQ(map_version, "2.0") << "Parsed map_version should be 2.0";
+}
+
+TEST_F(TestSuite, ParseVersionsNotSelfClosing)
+{
+  writeFile("<?xml version=\"1.0\"?>\n<osm generator=\"test\">\n"
+            "  <MetaInfo format_version=\"1.0\" map_version=\"2.0\"></MetaInfo>\n</osm>\n");
+
+  std::string format_version, map_version;
+  AutowareOsmParser::parseVersions(file_path, &format_version, &map_version);
+  ASSERT_EQ(format_version, "1.0") << "Parsed format_version should be 1.0";
+  ASSERT_EQ(map_version, "2.0") << "Parsed map_version should be 2.0";
+}
+
+TEST_F(TestSuite, ParseVersionsAcrossReadChunks)
+{
+  // the file is read in chunks of 64 KiB, move the tag across the end of the first chunk
+  const std::size_t chunk_size = 64 * 1024;
+  const std::string header = "<?xml version=\"1.0\"?>\n<osm generator=\"test\">\n<!--";
+  const std::string tag = "<MetaInfo format_version=\"1.0\" map_version=\"2.0\"/>";
+
+  for (std::size_t offset = 1; offset <= tag.size() + 1; offset++)
+  {
+    const std::size_t padding = chunk_size - offset - header.size() - 3;
+    writeFile(header + std::string(padding, 'x') + "-->" + tag + "\n</osm>\n");
+
+    std::string format_version, map_version;
+    AutowareOsmParser::parseVersions(file_path, &format_version, &map_version);
+    ASSERT_EQ(format_version, "1.0") << "Tag starting " << offset << " bytes before the end of the first chunk";
+    ASSERT_EQ(map_version, "2.0") << "Tag starting " << offset << " bytes before the end of the first chunk";
+  }
+}
+
+TEST_F(TestSuite, ParseVersionsWithoutMetaInfo)
+{
+  writeFile("<?xml version=\"1.0\"?>\n<osm generator=\"test\">\n</osm>\n");
+
+  std::string format_version, map_version;
+  AutowareOsmParser::parseVersions(file_path, &format_version, &map_version);
+  ASSERT_TRUE(format_version.empty()) << "format_version should stay empty without MetaInfo";
+  ASSERT_TRUE(map_version.empty()) << "map_version should stay empty without MetaInfo";
+}
+
+TEST_F(TestSuite, IsAlignedAgreesWithAlign)
+{
+  // left bound along y = 1, right bound along y = -1, both in +x direction
+  LineString3d left(getId(), { Point3d(getId(), 0., 1., 0.), Point3d(getId(), 1., 1., 0.),
+                               Point3d(getId(), 2., 1., 0.) });  // NOLINT
+  LineString3d right(getId(), { Point3d(getId(), 0., -1., 0.), Point3d(getId(), 1., -1., 0.),
+                                Point3d(getId(), 2., -1., 0.) });  // NOLINT
+
+  const std::pair<LineString3d, LineString3d> cases[] = {
+    { left, right }, { left, right.invert() }, { left.invert(), right }, { left.invert(), right.invert() }
+  };
+  const bool expected[] = { true, false, false, false };
+
+  for (std::size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); i++)
+  {
+    const LineString3d& case_left = cases[i].first;
+    const LineString3d& case_right = cases[i].second;
+
+    LineString3d aligned_left, aligned_right;
+    std::tie(aligned_left, aligned_right) = lanelet::geometry::align(case_left, case_right);
+    const bool unchanged = aligned_left.front().id() == case_left.front().id() &&
+                           aligned_right.front().id() == case_right.front().id();
+
+    ASSERT_EQ(AutowareOsmParser::isAligned(case_left, case_right), expected[i]) << "Case " << i;
+    ASSERT_EQ(AutowareOsmParser::isAligned(case_left, case_right), unchanged)
+        << "isAligned should agree with geometry::align in case " << i;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
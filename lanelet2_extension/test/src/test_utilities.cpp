@@ -137,6 +137,78 @@ TEST_F(TestSuite, OverwriteLaneletsCenterline)
   }
 }
 
+TEST_F(TestSuite, ResamplePoints)
+{
+  // L shaped line string of length 8
+  LineString3d line_string(getId(), { Point3d(getId(), 0., 0., 0.), Point3d(getId(), 4., 0., 0.),     // NOLINT
+                                      Point3d(getId(), 4., 4., 0.) });                              // NOLINT
+  const double expected_x[] = { 0., 2., 4., 4., 4. };
+  const double expected_y[] = { 0., 0., 0., 2., 4. };
+
+  const auto points = lanelet::utils::resamplePoints(line_string, 4);
+  ASSERT_EQ(5, points.size()) << "resampled point number is not num_segments + 1";
+  for (size_t i = 0; i < points.size(); i++)
+  {
+    EXPECT_NEAR(expected_x[i], points.at(i).x(), 1e-9) << "wrong resampled point " << i;
+    EXPECT_NEAR(expected_y[i], points.at(i).y(), 1e-9) << "wrong resampled point " << i;
+  }
+
+  const auto points_2d = lanelet::utils::resamplePoints(lanelet::traits::to2D(line_string), 4);
+  ASSERT_EQ(5, points_2d.size()) << "resampled point number is not num_segments + 1";
+  for (size_t i = 0; i < points_2d.size(); i++)
+  {
+    EXPECT_NEAR(expected_x[i], points_2d.at(i).x(), 1e-9) << "wrong resampled 2d point " << i;
+    EXPECT_NEAR(expected_y[i], points_2d.at(i).y(), 1e-9) << "wrong resampled 2d point " << i;
+  }
+}
+
+TEST_F(TestSuite, ResamplePointsBySpacing)
+{
+  LineString3d line_string(getId(), { Point3d(getId(), 0., 0., 0.), Point3d(getId(), 4., 0., 0.),     // NOLINT
+                                      Point3d(getId(), 4., 4., 0.) });                              // NOLINT
+
+  // every 3 meters, then the end point
+  const auto points = lanelet::utils::resamplePointsBySpacing(line_string, 3.);
+  const double expected_x[] = { 0., 3., 4., 4. };
+  const double expected_y[] = { 0., 0., 2., 4. };
+  ASSERT_EQ(4, points.size()) << "wrong resampled point number";
+  for (size_t i = 0; i < points.size(); i++)
+  {
+    EXPECT_NEAR(expected_x[i], points.at(i).x(), 1e-9) << "wrong resampled point " << i;
+    EXPECT_NEAR(expected_y[i], points.at(i).y(), 1e-9) << "wrong resampled point " << i;
+  }
+
+  // spacing that divides the length gives no duplicate end point
+  ASSERT_EQ(5, lanelet::utils::resamplePointsBySpacing(lanelet::traits::to2D(line_string), 2.).size());
+
+  // a line string without length still gives its first and last point
+  LineString3d degenerate(getId(), { Point3d(getId(), 1., 2., 0.), Point3d(getId(), 1., 2., 0.) });  // NOLINT
+  const auto degenerate_points = lanelet::utils::resamplePointsBySpacing(degenerate, 3.);
+  ASSERT_EQ(2, degenerate_points.size()) << "wrong resampled point number for a line string without length";
+  for (const auto& point : degenerate_points)
+  {
+    EXPECT_NEAR(1., point.x(), 1e-9);
+    EXPECT_NEAR(2., point.y(), 1e-9);
+  }
+}
+
+TEST_F(TestSuite, InterpolatePoints)
+{
+  LineString3d line_string(getId(), { Point3d(getId(), 0., 0., 0.), Point3d(getId(), 4., 0., 0.),     // NOLINT
+                                      Point3d(getId(), 4., 0., 0.), Point3d(getId(), 4., 4., 0.) });  // NOLINT
+
+  // lengths outside of the line string are clamped to its end points
+  const auto points = lanelet::utils::interpolatePoints(line_string, { -1., 1., 4., 5., 10. });  // NOLINT
+  const double expected_x[] = { 0., 1., 4., 4., 4. };
+  const double expected_y[] = { 0., 0., 0., 1., 4. };
+  ASSERT_EQ(5, points.size()) << "interpolated point number is not the target number";
+  for (size_t i = 0; i < points.size(); i++)
+  {
+    EXPECT_NEAR(expected_x[i], points.at(i).x(), 1e-9) << "wrong interpolated point " << i;
+    EXPECT_NEAR(expected_y[i], points.at(i).y(), 1e-9) << "wrong interpolated point " << i;
+  }
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <lanelet2_extension/utility/utilities.h>
+#include <lanelet2_extension/visualization/visualization.h>
+#include <ros/ros.h>
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+using lanelet::Lanelet;
+using lanelet::LineString3d;
+using lanelet::Point3d;
+using lanelet::utils::getId;
+
+namespace
+{
+double signedArea(const std::vector<geometry_msgs::Point32>& points)
+{
+  double area = 0.0;
+  for (size_t i = 0, j = points.size() - 1; i < points.size(); j = i++)
+    area += points[j].x * points[i].y - points[i].x * points[j].y;
+  return area / 2.0;
+}
+
+double totalArea(const std::vector<geometry_msgs::Polygon>& triangles)
+{
+  double area = 0.0;
+  for (const auto& triangle : triangles)
+    area += std::fabs(signedArea(triangle.points));
+  return area;
+}
+
+geometry_msgs::Point32 createPoint32(double x, double y)
+{
+  geometry_msgs::Point32 point;
+  point.x = x;
+  point.y = y;
+  point.z = 0;
+  return point;
+}
+}  // namespace
+
+class TestSuite : public ::testing::Test
+{
+public:
+  TestSuite()
+  {
+  }
+  ~TestSuite()
+  {
+  }
+
+  // curved lanelet with different point counts on each bound
+  Lanelet createCurvedLanelet(int num_points)
+  {
+    LineString3d left(getId());
+    LineString3d right(getId());
+    for (int i = 0; i < num_points; i++)
+    {
+      double t = i * M_PI_2 / (num_points - 1);
+      right.push_back(Point3d(getId(), 20.0 * std::cos(t), 20.0 * std::sin(t), 0.));
+    }
+    for (int i = 0; i < num_points + 3; i++)
+    {
+      double t = i * M_PI_2 / (num_points + 2);
+      left.push_back(Point3d(getId(), 16.5 * std::cos(t), 16.5 * std::sin(t), 0.));
+    }
+    return Lanelet(getId(), left, right);
+  }
+};
+
+TEST_F(TestSuite, Lanelet2TriangleStraight)
+{
+  LineString3d left(getId());
+  LineString3d right(getId());
+  for (int i = 0; i <= 100; i++)
+  {
+    left.push_back(Point3d(getId(), i, 3.0, 0.));
+    right.push_back(Point3d(getId(), i, 0.0, 0.));
+  }
+  Lanelet lanelet(getId(), left, right);
+
+  std::vector<geometry_msgs::Polygon> triangles;
+  lanelet::visualization::lanelet2Triangle(lanelet, &triangles);
+
+  ASSERT_EQ(200, triangles.size()) << "Strip of two bounds gives left + right - 2 triangles";
+  for (const auto& triangle : triangles)
+    ASSERT_EQ(3, triangle.points.size());
+  ASSERT_NEAR(300.0, totalArea(triangles), 1e-3) << "Triangles do not cover the lanelet";
+}
+
+TEST_F(TestSuite, Lanelet2TriangleCurved)
+{
+  for (int num_points : { 3, 30, 300 })
+  {
+    Lanelet lanelet = createCurvedLanelet(num_points);
+    geometry_msgs::Polygon polygon;
+    lanelet::visualization::lanelet2Polygon(lanelet, &polygon);
+
+    std::vector<geometry_msgs::Polygon> triangles;
+    lanelet::visualization::lanelet2Triangle(lanelet, &triangles);
+
+    ASSERT_EQ(polygon.points.size() - 2, triangles.size());
+    ASSERT_NEAR(std::fabs(signedArea(polygon.points)), totalArea(triangles), 1e-2)
+        << "Triangles do not cover the lanelet with " << num_points << " points";
+
+    // every triangle has the orientation of the lanelet polygon, i.e. none of them is flipped
+    const double orientation = signedArea(polygon.points);
+    for (const auto& triangle : triangles)
+      ASSERT_GE(signedArea(triangle.points) * orientation, 0.0);
+  }
+}
+
+TEST_F(TestSuite, Polygon2TriangleConcave)
+{
+  // U shaped polygon in clockwise order
+  geometry_msgs::Polygon polygon;
+  polygon.points.push_back(createPoint32(0, 0));
+  polygon.points.push_back(createPoint32(0, 3));
+  polygon.points.push_back(createPoint32(1, 3));
+  polygon.points.push_back(createPoint32(1, 1));
+  polygon.points.push_back(createPoint32(2, 1));
+  polygon.points.push_back(createPoint32(2, 3));
+  polygon.points.push_back(createPoint32(3, 3));
+  polygon.points.push_back(createPoint32(3, 0));
+
+  std::vector<geometry_msgs::Polygon> triangles;
+  lanelet::visualization::polygon2Triangle(polygon, &triangles);
+
+  ASSERT_EQ(6, triangles.size());
+  ASSERT_NEAR(7.0, totalArea(triangles), 1e-6) << "Triangles do not cover the polygon";
+
+  // same polygon in counter clockwise order
+  std::reverse(polygon.points.begin(), polygon.points.end());
+  triangles.clear();
+  lanelet::visualization::polygon2Triangle(polygon, &triangles);
+
+  ASSERT_EQ(6, triangles.size());
+  ASSERT_NEAR(7.0, totalArea(triangles), 1e-6) << "Triangles do not cover the polygon";
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
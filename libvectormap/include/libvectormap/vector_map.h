@@ -17,12 +17,21 @@
 #ifndef LIBVECTORMAP_VECTOR_MAP_H
 #define LIBVECTORMAP_VECTOR_MAP_H
 
+#include <algorithm>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
+#include <deque>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 #include <map>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
 
 #include "Math.h"
 
@@ -126,17 +135,317 @@ typedef struct
 }
 Lane;
 
+/*
+ * Id-indexed table with the std::map interface used on vector map elements.
+ * Elements are appended to a deque and never move, so references to them stay valid
+ * until clear(), as with std::map. A separate index vector keeps them in id order.
+ * Ids are resolved through a direct lookup table when they are dense enough
+ * and by binary search otherwise. Inserting invalidates iterators, not references.
+ * revision() changes on every insert and on every non-const access to the elements,
+ * so that data derived from the table can tell when to rebuild.
+ */
+template <typename T>
+class IdTable
+{
+public:
+  typedef std::pair<const int, T> value_type;
+
+  template <bool Const>
+  class basic_iterator
+  {
+  public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef typename IdTable::value_type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef typename std::conditional<Const, const value_type*, value_type*>::type pointer;
+    typedef typename std::conditional<Const, const value_type&, value_type&>::type reference;
+
+    basic_iterator() : table_(nullptr), pos_(0) {}
+
+    // iterator converts to const_iterator
+    template <bool C = Const, typename = typename std::enable_if<C>::type>
+    basic_iterator(const basic_iterator<false>& other) : table_(other.table_), pos_(other.pos_) {}
+
+    reference operator*() const { return table_->storage_[table_->order_[pos_]]; }
+    pointer operator->() const { return &**this; }
+
+    basic_iterator& operator++()
+    {
+      ++pos_;
+      return *this;
+    }
+
+    basic_iterator operator++(int)
+    {
+      basic_iterator tmp(*this);
+      ++pos_;
+      return tmp;
+    }
+
+    basic_iterator& operator--()
+    {
+      --pos_;
+      return *this;
+    }
+
+    basic_iterator operator--(int)
+    {
+      basic_iterator tmp(*this);
+      --pos_;
+      return tmp;
+    }
+
+    bool operator==(const basic_iterator& other) const { return pos_ == other.pos_ && table_ == other.table_; }
+    bool operator!=(const basic_iterator& other) const { return !(*this == other); }
+
+  private:
+    typedef typename std::conditional<Const, const IdTable*, IdTable*>::type table_pointer;
+
+    friend class IdTable;
+    friend class basic_iterator<!Const>;
+
+    basic_iterator(table_pointer table, const size_t pos) : table_(table), pos_(pos) {}
+
+    table_pointer table_;
+    size_t pos_;
+  };
+
+  typedef basic_iterator<false> iterator;
+  typedef basic_iterator<true> const_iterator;
+
+  iterator begin()
+  {
+    ++revision_;
+    return iterator(this, 0);
+  }
+  iterator end() { return iterator(this, order_.size()); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, order_.size()); }
+
+  size_t size() const { return order_.size(); }
+  bool empty() const { return order_.empty(); }
+
+  uint64_t revision() const { return revision_; }
+
+  void clear()
+  {
+    ++revision_;
+    storage_.clear();
+    order_.clear();
+    slots_.clear();
+  }
+
+  // bulk insert; like std::map::insert, elements whose id is already present are ignored
+  void insert(std::vector<value_type>&& values)
+  {
+    ++revision_;
+    std::vector<size_t> sorted(values.size());
+    for (size_t i = 0; i < sorted.size(); ++i)
+      sorted[i] = i;
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [&values](const size_t a, const size_t b) { return values[a].first < values[b].first; });
+
+    // duplicates are looked up in the sorted prefix only, the appended tail is not sorted yet
+    const size_t old_size = order_.size();
+    for (size_t i = 0; i < sorted.size(); ++i)
+    {
+      value_type& value = values[sorted[i]];
+      if ((i > 0 && values[sorted[i - 1]].first == value.first) || findInPrefix(value.first, old_size) < old_size)
+        continue;
+      storage_.push_back(std::move(value));
+      order_.push_back(static_cast<int>(storage_.size() - 1));
+    }
+
+    std::inplace_merge(order_.begin(), order_.begin() + old_size, order_.end(),
+                       [this](const int a, const int b) { return storage_[a].first < storage_[b].first; });
+    reindex();
+  }
+
+  std::pair<iterator, bool> insert(const value_type& value)
+  {
+    ++revision_;
+    const size_t pos = lowerBound(value.first);
+    if (pos < order_.size() && storage_[order_[pos]].first == value.first)
+      return std::make_pair(iterator(this, pos), false);
+
+    storage_.push_back(value);
+    order_.insert(order_.begin() + pos, static_cast<int>(storage_.size() - 1));
+    indexInserted(pos);
+    return std::make_pair(iterator(this, pos), true);
+  }
+
+  iterator find(const int id)
+  {
+    ++revision_;
+    return iterator(this, position(id));
+  }
+
+  const_iterator find(const int id) const
+  {
+    return const_iterator(this, position(id));
+  }
+
+  size_t count(const int id) const
+  {
+    return position(id) == order_.size() ? 0 : 1;
+  }
+
+  T& at(const int id)
+  {
+    ++revision_;
+    return const_cast<T&>(static_cast<const IdTable&>(*this).at(id));
+  }
+
+  const T& at(const int id) const
+  {
+    const size_t pos = position(id);
+    if (pos == order_.size())
+      throw std::out_of_range("IdTable::at");
+    return storage_[order_[pos]].second;
+  }
+
+  // like std::map::operator[], inserts a value-initialized element for unknown ids
+  T& operator[](const int id)
+  {
+    ++revision_;
+    const size_t pos = position(id);
+    if (pos != order_.size())
+      return storage_[order_[pos]].second;
+    return insert(value_type(id, T())).first->second;
+  }
+
+private:
+  // direct lookup is used while the id range is at most this many times the element count
+  static constexpr size_t kMaxSlotsPerEntry = 4;
+
+  std::deque<value_type> storage_;
+  std::vector<int> order_;
+  std::vector<int> slots_;
+  int min_id_ = 0;
+  uint64_t revision_ = 0;
+
+  void reindex()
+  {
+    slots_.clear();
+    if (order_.empty())
+      return;
+
+    min_id_ = storage_[order_.front()].first;
+    int64_t range = static_cast<int64_t>(storage_[order_.back()].first) - min_id_ + 1;
+    if (range > static_cast<int64_t>(kMaxSlotsPerEntry * order_.size()))
+      return;
+
+    slots_.assign(static_cast<size_t>(range), -1);
+    for (size_t i = 0; i < order_.size(); ++i)
+      slots_[storage_[order_[i]].first - min_id_] = static_cast<int>(i);
+  }
+
+  // keeps the lookup valid after a single element was inserted at pos
+  void indexInserted(const size_t pos)
+  {
+    if (slots_.empty() && order_.size() > 1)
+      return;
+
+    // an id past the end only needs its own slot, anything else shifts the positions
+    if (pos + 1 == order_.size() && !slots_.empty())
+    {
+      int64_t slot = static_cast<int64_t>(storage_[order_[pos]].first) - min_id_;
+      if (slot < static_cast<int64_t>(kMaxSlotsPerEntry * order_.size()))
+      {
+        if (slot >= static_cast<int64_t>(slots_.size()))
+          slots_.resize(static_cast<size_t>(slot) + 1, -1);
+        slots_[slot] = static_cast<int>(pos);
+        return;
+      }
+    }
+    reindex();
+  }
+
+  // position of id in the first size entries of order_, size if the id is not there
+  size_t findInPrefix(const int id, const size_t size) const
+  {
+    auto end = order_.begin() + size;
+    auto it = std::lower_bound(order_.begin(), end, id,
+                               [this](const int a, const int b) { return storage_[a].first < b; });
+    if (it != end && storage_[*it].first != id)
+      return size;
+    return static_cast<size_t>(it - order_.begin());
+  }
+
+  size_t lowerBound(const int id) const
+  {
+    auto it = std::lower_bound(order_.begin(), order_.end(), id,
+                               [this](const int a, const int b) { return storage_[a].first < b; });
+    return static_cast<size_t>(it - order_.begin());
+  }
+
+  size_t position(const int id) const
+  {
+    if (!slots_.empty())
+    {
+      int64_t slot = static_cast<int64_t>(id) - min_id_;
+      if (slot < 0 || slot >= static_cast<int64_t>(slots_.size()) || slots_[slot] < 0)
+        return order_.size();
+      return static_cast<size_t>(slots_[slot]);
+    }
+
+    const size_t pos = lowerBound(id);
+    if (pos == order_.size() || storage_[order_[pos]].first != id)
+      return order_.size();
+    return pos;
+  }
+};
+
+/*
+ * Uniform grid over the x-y plane that answers radius and nearest neighbour queries on ids.
+ */
+class SpatialIndex
+{
+public:
+  explicit SpatialIndex(double cell_size = 10.0) :
+    cell_size_(cell_size), min_cx_(0), max_cx_(-1), min_cy_(0), max_cy_(-1) {}
+
+  void clear();
+  void insert(const int id, const double x, const double y);
+  bool empty() const { return cells_.empty(); }
+
+  std::vector<int> findInRadius(const double x, const double y, const double radius) const;
+  bool findNearest(const double x, const double y, int* id) const;
+
+private:
+  struct Entry
+  {
+    int id;
+    double x;
+    double y;
+  };
+
+  double cell_size_;
+  std::unordered_map<uint64_t, std::vector<Entry>> cells_;
+  int min_cx_, max_cx_, min_cy_, max_cy_;
+
+  int toCell(const double value) const
+  {
+    return static_cast<int>(std::floor(value / cell_size_));
+  }
+
+  static uint64_t toCellKey(const int cx, const int cy)
+  {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+  }
+};
+
 class VectorMap
 {
 public:
   bool loaded;
-  std::map<int, Point> points;
-  std::map<int, Line> lines;
-  std::map<int, WhiteLine> whitelines;
-  std::map<int, Lane> lanes;
-  std::map<int, DTLane> dtlanes;
-  std::map<int, Vector> vectors;
-  std::map<int, Signal> signals;
+  IdTable<Point> points;
+  IdTable<Line> lines;
+  IdTable<WhiteLine> whitelines;
+  IdTable<Lane> lanes;
+  IdTable<DTLane> dtlanes;
+  IdTable<Vector> vectors;
+  IdTable<Signal> signals;
 
   void load_points(const vector_map::PointArray& msg);
   void load_lines(const vector_map::LineArray& msg);
@@ -147,17 +456,49 @@ public:
   void load_dtlanes(const vector_map::DTLaneArray& msg);
 
   VectorMap() :
-    loaded(false) {}
+    loaded(false), point_index_revision_(kNotIndexed), signal_index_revision_(kNotIndexed),
+    lane_index_revision_(kNotIndexed) {}
 
-  inline Point3 getPoint(const int idx)
+  inline Point3 getPoint(const int idx) const
   {
-    Point3 p;
-    Point psrc = points[idx];
-    p.x() = psrc.bx;
-    p.y() = psrc.ly;
-    p.z() = psrc.h;
+    Point3 p(0, 0, 0);
+    auto it = points.find(idx);
+    if (it == points.end())
+      return p;
+    p.x() = it->second.bx;
+    p.y() = it->second.ly;
+    p.z() = it->second.h;
     return p;
   }
+
+  // Spatial queries in the x-y plane. Signals are located at their vector's point,
+  // lanes at the point of their dtlane. Each index is rebuilt on first use after a change
+  // of the tables it is built from. Queries may run concurrently, changes to the tables
+  // need the same synchronization as with std::map.
+  std::vector<int> findPointsInRadius(const double x, const double y, const double radius) const;
+  std::vector<int> findSignalsInRadius(const double x, const double y, const double radius) const;
+  std::vector<int> findLanesInRadius(const double x, const double y, const double radius) const;
+  bool findNearestPoint(const double x, const double y, int* pid) const;
+  bool findNearestSignal(const double x, const double y, int* id) const;
+  bool findNearestLane(const double x, const double y, int* lnid) const;
+
+private:
+  static constexpr uint64_t kNotIndexed = UINT64_MAX;
+
+  // guards the lazily built indices and their revisions
+  mutable std::mutex index_mutex_;
+  // sum of the revisions of the tables each index was built from
+  mutable uint64_t point_index_revision_;
+  mutable uint64_t signal_index_revision_;
+  mutable uint64_t lane_index_revision_;
+  mutable SpatialIndex point_index_;
+  mutable SpatialIndex signal_index_;
+  mutable SpatialIndex lane_index_;
+
+  // called with index_mutex_ held
+  const SpatialIndex& pointIndex() const;
+  const SpatialIndex& signalIndex() const;
+  const SpatialIndex& laneIndex() const;
 };
 
 #endif  // LIBVECTORMAP_VECTOR_MAP_H
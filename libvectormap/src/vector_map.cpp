@@ -19,11 +19,14 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
+#include <limits>
+#include <utility>
 #include <vector>
-#include <map>
 
 void VectorMap::load_points(const vector_map::PointArray& msg)
 {
+  std::vector<IdTable<Point>::value_type> entries;
+  entries.reserve(msg.data.size());
   for (const auto& point : msg.data)
   {
     Point tmp;
@@ -37,14 +40,17 @@ void VectorMap::load_points(const vector_map::PointArray& msg)
     tmp.mcode1 = point.mcode1;
     tmp.mcode2 = point.mcode2;
     tmp.mcode3 = point.mcode3;
-    points.insert(std::map<int, Point>::value_type(tmp.pid, tmp));
+    entries.push_back(IdTable<Point>::value_type(tmp.pid, tmp));
   }
+  points.insert(std::move(entries));
 
   std::cout << "load points complete. element num: " << points.size() << std::endl;
 } /* void VectorMap::load_points() */
 
 void VectorMap::load_lines(const vector_map::LineArray& msg)
 {
+  std::vector<IdTable<Line>::value_type> entries;
+  entries.reserve(msg.data.size());
   for (const auto& line : msg.data)
   {
     Line tmp;
@@ -54,14 +60,17 @@ void VectorMap::load_lines(const vector_map::LineArray& msg)
     tmp.blid = line.blid;
     tmp.flid = line.flid;
 
-    lines.insert(std::map<int, Line>::value_type(tmp.lid, tmp));
+    entries.push_back(IdTable<Line>::value_type(tmp.lid, tmp));
   }
+  lines.insert(std::move(entries));
 
   std::cout << "load lines complete." << std::endl;
 } /* void VectorMap::load_lines() */
 
 void VectorMap::load_lanes(const vector_map::LaneArray& msg)
 {
+  std::vector<IdTable<Lane>::value_type> entries;
+  entries.reserve(msg.data.size());
   for (const auto& lane : msg.data)
   {
     Lane tmp;
@@ -83,14 +92,17 @@ void VectorMap::load_lanes(const vector_map::LaneArray& msg)
     tmp.lcnt    = lane.lcnt;
     tmp.lno     = lane.lno;
 
-    lanes.insert(std::map<int, Lane>::value_type(tmp.lnid, tmp));
+    entries.push_back(IdTable<Lane>::value_type(tmp.lnid, tmp));
   }
+  lanes.insert(std::move(entries));
 
   std::cout << "load lanes complete." << std::endl;
 } /* void VectorMap::load_lanes() */
 
 void VectorMap::load_vectors(const vector_map::VectorArray& msg)
 {
+  std::vector<IdTable<Vector>::value_type> entries;
+  entries.reserve(msg.data.size());
   for (const auto& vector : msg.data)
   {
     Vector tmp;
@@ -99,14 +111,17 @@ void VectorMap::load_vectors(const vector_map::VectorArray& msg)
     tmp.hang = vector.hang;
     tmp.vang = vector.vang;
 
-    vectors.insert(std::map<int, Vector>::value_type(tmp.vid, tmp));
+    entries.push_back(IdTable<Vector>::value_type(tmp.vid, tmp));
   }
+  vectors.insert(std::move(entries));
 
   std::cout << "load vectors complete. element num: " << vectors.size() << std::endl;
 } /* void VectorMap::load_vectors() */
 
 void VectorMap::load_signals(const vector_map::SignalArray& msg)
 {
+  std::vector<IdTable<Signal>::value_type> entries;
+  entries.reserve(msg.data.size());
   for (const auto& signal : msg.data)
   {
     Signal tmp;
@@ -116,14 +131,17 @@ void VectorMap::load_signals(const vector_map::SignalArray& msg)
     tmp.type   = signal.type;
     tmp.linkid = signal.linkid;
 
-    signals.insert(std::map<int, Signal>::value_type(tmp.id, tmp));
+    entries.push_back(IdTable<Signal>::value_type(tmp.id, tmp));
   }
+  signals.insert(std::move(entries));
 
   std::cout << "load signals complete. element num: " << signals.size() << std::endl;
 } /* void VectorMap::load_signals() */
 
 void VectorMap::load_whitelines(const vector_map::WhiteLineArray& msg)
 {
+  std::vector<IdTable<WhiteLine>::value_type> entries;
+  entries.reserve(msg.data.size());
   for (const auto& white_line : msg.data)
   {
     WhiteLine tmp;
@@ -134,14 +152,17 @@ void VectorMap::load_whitelines(const vector_map::WhiteLineArray& msg)
     tmp.type   = white_line.type;
     tmp.linkid = white_line.linkid;
 
-    whitelines.insert(std::map<int, WhiteLine>::value_type(tmp.id, tmp));
+    entries.push_back(IdTable<WhiteLine>::value_type(tmp.id, tmp));
   }
+  whitelines.insert(std::move(entries));
 
   std::cout << "load whitelines complete." << std::endl;
 } /* void VectorMap::load_whitelines() */
 
 void VectorMap::load_dtlanes(const vector_map::DTLaneArray& msg)
 {
+  std::vector<IdTable<DTLane>::value_type> entries;
+  entries.reserve(msg.data.size());
   for (const auto& dtlane : msg.data)
   {
     DTLane tmp;
@@ -156,8 +177,204 @@ void VectorMap::load_dtlanes(const vector_map::DTLaneArray& msg)
     tmp.lw    = dtlane.lw;
     tmp.rw    = dtlane.rw;
 
-    dtlanes.insert(std::map<int, DTLane>::value_type(tmp.did, tmp));
+    entries.push_back(IdTable<DTLane>::value_type(tmp.did, tmp));
   }
+  dtlanes.insert(std::move(entries));
 
   std::cout << "load dtlanes complete." << std::endl;
 } /* void VectorMap::load_dtlanes() */
+
+void SpatialIndex::clear()
+{
+  cells_.clear();
+  min_cx_ = min_cy_ = 0;
+  max_cx_ = max_cy_ = -1;
+}
+
+void SpatialIndex::insert(const int id, const double x, const double y)
+{
+  int cx = toCell(x);
+  int cy = toCell(y);
+  if (cells_.empty())
+  {
+    min_cx_ = max_cx_ = cx;
+    min_cy_ = max_cy_ = cy;
+  }
+  else
+  {
+    min_cx_ = std::min(min_cx_, cx);
+    max_cx_ = std::max(max_cx_, cx);
+    min_cy_ = std::min(min_cy_, cy);
+    max_cy_ = std::max(max_cy_, cy);
+  }
+  cells_[toCellKey(cx, cy)].push_back(Entry{ id, x, y });
+}
+
+std::vector<int> SpatialIndex::findInRadius(const double x, const double y, const double radius) const
+{
+  std::vector<int> ids;
+  if (cells_.empty() || radius < 0)
+    return ids;
+
+  int cx_begin = std::max(toCell(x - radius), min_cx_);
+  int cx_end = std::min(toCell(x + radius), max_cx_);
+  int cy_begin = std::max(toCell(y - radius), min_cy_);
+  int cy_end = std::min(toCell(y + radius), max_cy_);
+  double squared_radius = radius * radius;
+  for (int cx = cx_begin; cx <= cx_end; ++cx)
+  {
+    for (int cy = cy_begin; cy <= cy_end; ++cy)
+    {
+      auto cell = cells_.find(toCellKey(cx, cy));
+      if (cell == cells_.end())
+        continue;
+      for (const auto& entry : cell->second)
+      {
+        double dx = entry.x - x;
+        double dy = entry.y - y;
+        if (dx * dx + dy * dy <= squared_radius)
+          ids.push_back(entry.id);
+      }
+    }
+  }
+  return ids;
+}
+
+bool SpatialIndex::findNearest(const double x, const double y, int* id) const
+{
+  if (cells_.empty() || id == nullptr)
+    return false;
+
+  // visit the cells ring by ring around the query cell. Every point in ring r is at least
+  // (r - 1) cells away, so the search ends once the best distance is below that bound.
+  int cx = toCell(x);
+  int cy = toCell(y);
+  int max_ring = std::max(std::max(std::abs(cx - min_cx_), std::abs(cx - max_cx_)),
+                          std::max(std::abs(cy - min_cy_), std::abs(cy - max_cy_)));
+  double best = std::numeric_limits<double>::max();
+  bool found = false;
+  for (int ring = 0; ring <= max_ring; ++ring)
+  {
+    if (found)
+    {
+      double bound = (ring - 1) * cell_size_;
+      if (bound * bound >= best)
+        break;
+    }
+    for (int ix = cx - ring; ix <= cx + ring; ++ix)
+    {
+      // inner rows of the ring only have their two border cells
+      int step = (ix == cx - ring || ix == cx + ring) ? 1 : 2 * ring;
+      for (int iy = cy - ring; iy <= cy + ring; iy += step)
+      {
+        auto cell = cells_.find(toCellKey(ix, iy));
+        if (cell == cells_.end())
+          continue;
+        for (const auto& entry : cell->second)
+        {
+          double dx = entry.x - x;
+          double dy = entry.y - y;
+          double squared_distance = dx * dx + dy * dy;
+          if (squared_distance < best)
+          {
+            best = squared_distance;
+            *id = entry.id;
+            found = true;
+          }
+        }
+      }
+    }
+  }
+  return found;
+}
+
+const SpatialIndex& VectorMap::pointIndex() const
+{
+  const uint64_t revision = points.revision();
+  if (point_index_revision_ != revision)
+  {
+    point_index_.clear();
+    for (const auto& point : points)
+      point_index_.insert(point.first, point.second.bx, point.second.ly);
+    point_index_revision_ = revision;
+  }
+  return point_index_;
+}
+
+const SpatialIndex& VectorMap::signalIndex() const
+{
+  const uint64_t revision = points.revision() + vectors.revision() + signals.revision();
+  if (signal_index_revision_ != revision)
+  {
+    signal_index_.clear();
+    for (const auto& signal : signals)
+    {
+      auto vector = vectors.find(signal.second.vid);
+      if (vector == vectors.end())
+        continue;
+      auto point = points.find(vector->second.pid);
+      if (point == points.end())
+        continue;
+      signal_index_.insert(signal.first, point->second.bx, point->second.ly);
+    }
+    signal_index_revision_ = revision;
+  }
+  return signal_index_;
+}
+
+const SpatialIndex& VectorMap::laneIndex() const
+{
+  const uint64_t revision = points.revision() + dtlanes.revision() + lanes.revision();
+  if (lane_index_revision_ != revision)
+  {
+    lane_index_.clear();
+    for (const auto& lane : lanes)
+    {
+      auto dtlane = dtlanes.find(lane.second.did);
+      if (dtlane == dtlanes.end())
+        continue;
+      auto point = points.find(dtlane->second.pid);
+      if (point == points.end())
+        continue;
+      lane_index_.insert(lane.first, point->second.bx, point->second.ly);
+    }
+    lane_index_revision_ = revision;
+  }
+  return lane_index_;
+}
+
+std::vector<int> VectorMap::findPointsInRadius(const double x, const double y, const double radius) const
+{
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  return pointIndex().findInRadius(x, y, radius);
+}
+
+std::vector<int> VectorMap::findSignalsInRadius(const double x, const double y, const double radius) const
+{
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  return signalIndex().findInRadius(x, y, radius);
+}
+
+std::vector<int> VectorMap::findLanesInRadius(const double x, const double y, const double radius) const
+{
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  return laneIndex().findInRadius(x, y, radius);
+}
+
+bool VectorMap::findNearestPoint(const double x, const double y, int* pid) const
+{
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  return pointIndex().findNearest(x, y, pid);
+}
+
+bool VectorMap::findNearestSignal(const double x, const double y, int* id) const
+{
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  return signalIndex().findNearest(x, y, id);
+}
+
+bool VectorMap::findNearestLane(const double x, const double y, int* lnid) const
+{
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  return laneIndex().findNearest(x, y, lnid);
+}
@@ -0,0 +1,350 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "libvectormap/vector_map.h"
+
+class LibVectorMapTestSuite : public ::testing::Test
+{
+public:
+  LibVectorMapTestSuite() {}
+  ~LibVectorMapTestSuite() {}
+};
+
+namespace
+{
+std::vector<IdTable<int>::value_type> createEntries(const std::vector<int>& ids, const int overwritten = -1)
+{
+  // the element at index overwritten gets a negative value, to tell it from the other ones of its id
+  std::vector<IdTable<int>::value_type> entries;
+  for (size_t i = 0; i < ids.size(); ++i)
+    entries.push_back(IdTable<int>::value_type(ids[i], static_cast<int>(i) == overwritten ? -1 : ids[i] * 10));
+  return entries;
+}
+
+void expectSameAsMap(const IdTable<int>& table, const std::map<int, int>& reference)
+{
+  ASSERT_EQ(reference.size(), table.size());
+  auto it = table.begin();
+  for (const auto& element : reference)
+  {
+    ASSERT_EQ(element.first, it->first);
+    ASSERT_EQ(element.second, it->second);
+    ASSERT_EQ(1u, table.count(element.first));
+    ASSERT_EQ(element.second, table.at(element.first));
+    ++it;
+  }
+  ASSERT_TRUE(it == table.end());
+}
+}  // namespace
+
+TEST_F(LibVectorMapTestSuite, IdTableBulkInsert)
+{
+  // dense and sparse ids, the first of duplicated ids wins as with std::map
+  for (const int stride : {1, 1000})
+  {
+    std::vector<int> ids = {5, 3, 9, 3, 1, 7};
+    for (auto& id : ids)
+      id *= stride;
+
+    IdTable<int> table;
+    std::map<int, int> reference;
+    auto entries = createEntries(ids, 3);
+    reference.insert(entries.begin(), entries.end());
+    table.insert(std::move(entries));
+    expectSameAsMap(table, reference);
+
+    // ids already present are not overwritten by a later load
+    auto more = createEntries({4 * stride, 5 * stride}, 1);
+    reference.insert(more.begin(), more.end());
+    table.insert(std::move(more));
+    expectSameAsMap(table, reference);
+
+    ASSERT_EQ(0u, table.count(2 * stride));
+    ASSERT_TRUE(table.find(2 * stride) == table.end());
+    ASSERT_THROW(table.at(2 * stride), std::out_of_range);
+  }
+
+  // a present id after new ids that sort before it, with a sparse table
+  IdTable<int> table;
+  std::map<int, int> reference;
+  auto entries = createEntries({1000, 5000, 9000});
+  reference.insert(entries.begin(), entries.end());
+  table.insert(std::move(entries));
+
+  std::vector<int> ids;
+  for (int id = 1; id <= 20; ++id)
+    ids.push_back(id);
+  ids.push_back(1000);
+  auto more = createEntries(ids, 20);
+  reference.insert(more.begin(), more.end());
+  table.insert(std::move(more));
+  expectSameAsMap(table, reference);
+  ASSERT_EQ(23u, table.size());
+  ASSERT_EQ(10000, table.at(1000));
+}
+
+TEST_F(LibVectorMapTestSuite, IdTableSingleInsert)
+{
+  IdTable<int> table;
+  std::map<int, int> reference;
+  table.insert(createEntries({10, 20, 30}));
+  reference.insert({{10, 100}, {20, 200}, {30, 300}});
+
+  auto inserted = table.insert(IdTable<int>::value_type(25, 250));
+  ASSERT_TRUE(inserted.second);
+  ASSERT_EQ(25, inserted.first->first);
+  reference.insert(std::make_pair(25, 250));
+
+  auto present = table.insert(IdTable<int>::value_type(20, -1));
+  ASSERT_FALSE(present.second);
+  ASSERT_EQ(200, present.first->second);
+
+  table[40] = 400;
+  reference[40] = 400;
+  ASSERT_EQ(0, table[5]);
+  reference[5];
+  table.at(10) = 101;
+  reference.at(10) = 101;
+  expectSameAsMap(table, reference);
+}
+
+TEST_F(LibVectorMapTestSuite, IdTableReferenceStability)
+{
+  // references taken before inserting missing ids still point to the same elements
+  std::mt19937 gen(7);
+  std::uniform_int_distribution<int> id_dist(0, 100000);
+  IdTable<int> table;
+  std::vector<int> ids;
+  for (int i = 0; i < 1000; ++i)
+    ids.push_back(2 * id_dist(gen) + 1);
+  table.insert(createEntries(ids));
+
+  std::vector<std::pair<int, int*>> refs;
+  for (const auto id : ids)
+    refs.push_back(std::make_pair(id, &table[id]));
+
+  std::map<int, int> reference(table.begin(), table.end());
+  for (int i = 0; i < 5000; ++i)
+  {
+    // even ids, before, between and after the loaded odd ones
+    const int id = 2 * (id_dist(gen) - 20000);
+    table[id] = id;
+    reference.insert(std::make_pair(id, id));
+  }
+  expectSameAsMap(table, reference);
+
+  for (const auto& ref : refs)
+  {
+    ASSERT_EQ(&table.at(ref.first), ref.second);
+    ASSERT_EQ(ref.first * 10, *ref.second);
+  }
+}
+
+TEST_F(LibVectorMapTestSuite, IdTableLargeLookup)
+{
+  const int n = 200000;
+  const int n_queries = 200000;
+  std::vector<std::pair<int, int>> values;
+  for (int i = 0; i < n; ++i)
+    values.push_back(std::make_pair(i * 2 + 1, i));
+  std::vector<int> queries;
+  std::mt19937 gen(11);
+  std::uniform_int_distribution<int> id_dist(0, 2 * n);
+  for (int i = 0; i < n_queries; ++i)
+    queries.push_back(id_dist(gen));
+
+  std::map<int, int> reference(values.begin(), values.end());
+  IdTable<int> table;
+  table.insert(std::vector<IdTable<int>::value_type>(values.begin(), values.end()));
+
+  for (const auto id : queries)
+  {
+    auto it = reference.find(id);
+    auto table_it = static_cast<const IdTable<int>&>(table).find(id);
+    ASSERT_EQ(it == reference.end(), table_it == table.end()) << "id " << id;
+    if (it != reference.end())
+    {
+      ASSERT_EQ(it->second, table_it->second);
+    }
+  }
+
+  // growing by missing ids past the end keeps the direct lookup
+  for (int i = 0; i < 10000; ++i)
+  {
+    table[2 * n + 1 + i] = i;
+    reference[2 * n + 1 + i] = i;
+  }
+  expectSameAsMap(table, reference);
+}
+
+namespace
+{
+vector_map::Point createPoint(const int pid, const double x, const double y)
+{
+  // libvectormap swaps bx and ly
+  vector_map::Point point;
+  point.pid = pid;
+  point.bx = y;
+  point.ly = x;
+  return point;
+}
+
+std::vector<int> findInRadiusBruteForce(const std::vector<std::pair<double, double>>& points, const double x,
+                                        const double y, const double radius)
+{
+  std::vector<int> ids;
+  for (size_t i = 0; i < points.size(); ++i)
+  {
+    double dx = points[i].first - x;
+    double dy = points[i].second - y;
+    if (dx * dx + dy * dy <= radius * radius)
+      ids.push_back(static_cast<int>(i));
+  }
+  return ids;
+}
+
+double squaredDistance(const std::pair<double, double>& point, const double x, const double y)
+{
+  double dx = point.first - x;
+  double dy = point.second - y;
+  return dx * dx + dy * dy;
+}
+}  // namespace
+
+TEST_F(LibVectorMapTestSuite, SpatialIndexQueries)
+{
+  SpatialIndex index(5.0);
+  int id = -1;
+  ASSERT_FALSE(index.findNearest(0, 0, &id));
+  ASSERT_TRUE(index.findInRadius(0, 0, 100).empty());
+
+  std::mt19937 gen(3);
+  std::uniform_real_distribution<double> coordinate(-100, 100);
+  std::vector<std::pair<double, double>> points;
+  for (int i = 0; i < 500; ++i)
+  {
+    points.push_back(std::make_pair(coordinate(gen), coordinate(gen)));
+    index.insert(i, points.back().first, points.back().second);
+  }
+
+  // query points inside and far outside of the indexed area
+  std::uniform_real_distribution<double> query_coordinate(-300, 300);
+  for (int i = 0; i < 200; ++i)
+  {
+    double x = query_coordinate(gen);
+    double y = query_coordinate(gen);
+    for (const double radius : {0.0, 3.0, 12.5, 80.0})
+    {
+      std::vector<int> ids = index.findInRadius(x, y, radius);
+      std::sort(ids.begin(), ids.end());
+      ASSERT_EQ(findInRadiusBruteForce(points, x, y, radius), ids);
+    }
+
+    double best = std::numeric_limits<double>::max();
+    for (const auto& point : points)
+      best = std::min(best, squaredDistance(point, x, y));
+    ASSERT_TRUE(index.findNearest(x, y, &id));
+    ASSERT_DOUBLE_EQ(best, squaredDistance(points.at(id), x, y));
+  }
+
+  ASSERT_TRUE(index.findInRadius(0, 0, -1).empty());
+  index.clear();
+  ASSERT_TRUE(index.empty());
+  ASSERT_FALSE(index.findNearest(0, 0, &id));
+}
+
+TEST_F(LibVectorMapTestSuite, VectorMapSpatialQueries)
+{
+  VectorMap vmap;
+  vector_map::PointArray points;
+  points.data.push_back(createPoint(1, 0, 0));
+  points.data.push_back(createPoint(2, 50, 0));
+  points.data.push_back(createPoint(3, 0, 50));
+  vmap.load_points(points);
+
+  vector_map::VectorArray vectors;
+  vector_map::Vector vector;
+  vector.vid = 10;
+  vector.pid = 2;
+  vectors.data.push_back(vector);
+  vmap.load_vectors(vectors);
+
+  vector_map::SignalArray signals;
+  vector_map::Signal signal;
+  signal.id = 100;
+  signal.vid = 10;
+  signals.data.push_back(signal);
+  vmap.load_signals(signals);
+
+  vector_map::DTLaneArray dtlanes;
+  vector_map::DTLane dtlane;
+  dtlane.did = 20;
+  dtlane.pid = 3;
+  dtlanes.data.push_back(dtlane);
+  vmap.load_dtlanes(dtlanes);
+
+  vector_map::LaneArray lanes;
+  vector_map::Lane lane;
+  lane.lnid = 200;
+  lane.did = 20;
+  lanes.data.push_back(lane);
+  vmap.load_lanes(lanes);
+
+  int id = -1;
+  ASSERT_TRUE(vmap.findNearestPoint(45, 5, &id));
+  ASSERT_EQ(2, id);
+  ASSERT_EQ(std::vector<int>({1}), vmap.findPointsInRadius(1, 1, 5));
+  ASSERT_TRUE(vmap.findNearestSignal(0, 0, &id));
+  ASSERT_EQ(100, id);
+  ASSERT_EQ(std::vector<int>({100}), vmap.findSignalsInRadius(50, 1, 2));
+  ASSERT_TRUE(vmap.findNearestLane(0, 0, &id));
+  ASSERT_EQ(200, id);
+  ASSERT_TRUE(vmap.findLanesInRadius(50, 0, 10).empty());
+
+  // the indices follow changes made through the tables
+  vmap.points[4].bx = 100;
+  vmap.points[4].ly = 100;
+  ASSERT_TRUE(vmap.findNearestPoint(90, 90, &id));
+  ASSERT_EQ(4, id);
+
+  vmap.points.at(3).bx = 50;
+  vmap.points.at(3).ly = 50;
+  ASSERT_TRUE(vmap.findNearestLane(49, 49, &id));
+  ASSERT_EQ(200, id);
+  ASSERT_EQ(std::vector<int>({200}), vmap.findLanesInRadius(50, 50, 1));
+
+  vmap.vectors.at(10).pid = 1;
+  ASSERT_EQ(std::vector<int>({100}), vmap.findSignalsInRadius(0, 0, 1));
+  ASSERT_TRUE(vmap.findSignalsInRadius(50, 0, 1).empty());
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "LibVectorMapTestNode");
+  return RUN_ALL_TESTS();
+}
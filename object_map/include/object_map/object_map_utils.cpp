@@ -73,46 +73,8 @@ namespace object_map
   std::vector<geometry_msgs::Point>
   SearchAreaPoints(const vector_map::Area &in_area, const vector_map::VectorMap &in_vectormap)
   {
-    std::vector<geometry_msgs::Point> area_points;
-    std::vector<geometry_msgs::Point> area_points_empty;
-
-    if (in_area.aid == 0)
-      return area_points_empty;
-
-    vector_map_msgs::Line line = in_vectormap.findByKey(vector_map::Key<vector_map_msgs::Line>(in_area.slid));
-    // must set beginning line
-    if (line.lid == 0 || line.blid != 0)
-      return area_points_empty;
-
-    // Search all lines in in_area
-    while (line.flid != 0)
-    {
-      vector_map_msgs::Point bp = in_vectormap.findByKey(vector_map::Key<vector_map_msgs::Point>(line.bpid));
-      if (bp.pid == 0)
-        return area_points_empty;
-
-      vector_map_msgs::Point fp = in_vectormap.findByKey(vector_map::Key<vector_map_msgs::Point>(line.fpid));
-      if (fp.pid == 0)
-        return area_points_empty;
-
-      // 2 points of line
-      area_points.push_back(vector_map::convertPointToGeomPoint(bp));
-      area_points.push_back(vector_map::convertPointToGeomPoint(fp));
-
-      line = in_vectormap.findByKey(vector_map::Key<vector_map_msgs::Line>(line.flid));
-      if (line.lid == 0)
-        return area_points_empty;
-    }
-
-    vector_map_msgs::Point bp = in_vectormap.findByKey(vector_map::Key<vector_map_msgs::Point>(line.bpid));
-    vector_map_msgs::Point fp = in_vectormap.findByKey(vector_map::Key<vector_map_msgs::Point>(line.fpid));
-    if (bp.pid == 0 || fp.pid == 0)
-      return area_points_empty;
-
-    area_points.push_back(vector_map::convertPointToGeomPoint(bp));
-    area_points.push_back(vector_map::convertPointToGeomPoint(fp));
-
-    return area_points;
+    // outline of the area from the vector map geometry cache, empty if the area or its lines are incomplete
+    return in_vectormap.findPolyline(in_area)->points;
   }
 
   void FillPolygonAreas(grid_map::GridMap &out_grid_map, const std::vector<std::vector<geometry_msgs::Point>> &in_area_points,
@@ -80,9 +80,11 @@ namespace object_map
 
   /*!
    * Extracts all the points forming in_area inside in_vectormap
+   * Each vertex is listed once, the point shared by two consecutive lines is not repeated (the begin and end
+   * points of every line used to be listed in pairs). A closed outline ends with its first point again.
    * @param[in] in_area Area to extract its points
    * @param[in] in_vectormap VectorMap object to which in_area belongs
-   * @return Array of points forming in_area
+   * @return Array of points forming in_area, empty if the area or one of its lines or points is missing
    */
   std::vector<geometry_msgs::Point>
   SearchAreaPoints(const vector_map::Area &in_area, const vector_map::VectorMap &in_vectormap);
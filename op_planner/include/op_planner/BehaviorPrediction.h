@@ -14,6 +14,7 @@
 #include "PlannerH.h"
 #include "op_utility/UtilityH.h"
 #include "PassiveDecisionMaker.h"
+#include "PlannerCycleRecorder.h"
 
 namespace PlannerHNS
 {
@@ -32,6 +33,15 @@ namespace PlannerHNS
 #define BEH_MIN_PARTICLE_NUM 0
 #define KEEP_PERCENTAGE 0.85
 
+//KLD-sampling bound and the state space bins used to measure the particles spread
+#define BEH_KLD_EPSILON 0.25
+#define BEH_KLD_Z 1.28 // 90% quantile
+#define BEH_KLD_POSE_BIN 1.0
+#define BEH_KLD_ANGLE_BIN 0.2
+#define BEH_KLD_VEL_BIN 1.0
+//forward and stop probabilities closer than this keep the maximum number of particles
+#define BEH_ADAPTIVE_DECISION_MARGIN 0.5
+
 #define MAX_PREDICTION_SPEED 10.0
 
 #define POSE_FACTOR 0.1
@@ -53,7 +63,7 @@ namespace PlannerHNS
 
 typedef boost::mt19937 ENG;
 typedef boost::normal_distribution<double> NormalDIST;
-typedef boost::variate_generator<ENG, NormalDIST> VariatGEN;
+typedef boost::variate_generator<ENG&, NormalDIST> VariatGEN;
 
 class TrajectoryTracker;
 
@@ -79,9 +89,11 @@ public:
   double ind_w;
   TrajectoryTracker* pTraj;
   int original_index;
+  int path_index; //warm start on pTraj->trajectory, -1 when unknown
 
   Particle()
   {
+    path_index = -1;
     prev_time_diff = 0;
     vel_prev_big = 0;
     original_index = 0;
@@ -111,10 +123,12 @@ public:
   BEH_STATE_TYPE best_beh;
   double best_p;
   std::vector<int> ids;
+  std::vector<int> sorted_ids; //ids sorted for the matching lookups
   std::vector<int> path_ids;
   WayPoint path_last_pose;
   double rms_error;
   std::vector<WayPoint> trajectory;
+  PassivePathContext path_context;
 
   std::vector<Particle> m_ForwardPart;
   std::vector<Particle> m_StopPart;
@@ -129,6 +143,10 @@ public:
   int nAliveLeft;
   int nAliveRight;
 
+  //particles sampled for the forward and stop behaviors in the current step, 0 before the first sampling
+  int nTargetForward;
+  int nTargetStop;
+
   double pStop;
   double pYield;
   double pForward;
@@ -153,6 +171,8 @@ public:
     nAliveForward = 0;
     nAliveLeft = 0;
     nAliveRight = 0;
+    nTargetForward = 0;
+    nTargetStop = 0;
 
     pStop  = 0;
     pYield = 0;
@@ -182,16 +202,20 @@ public:
 
     rms_error = 0;
     ids = obj.ids;
+    sorted_ids = obj.sorted_ids;
     path_ids = obj.path_ids;
     path_last_pose = obj.path_last_pose;
     beh = obj.beh;
     index = obj.index;
     trajectory = obj.trajectory;
+    path_context = obj.path_context;
     nAliveStop = obj.nAliveStop;
     nAliveYield = obj.nAliveYield;
     nAliveForward = obj.nAliveForward;
     nAliveLeft = obj.nAliveLeft;
     nAliveRight = obj.nAliveRight;
+    nTargetForward = obj.nTargetForward;
+    nTargetStop = obj.nTargetStop;
 
     pStop  = obj.pStop;
     pYield = obj.pYield;
@@ -243,6 +267,8 @@ public:
       }
     }
 
+    sorted_ids = ids;
+    std::sort(sorted_ids.begin(), sorted_ids.end());
     path_last_pose = path.at(path.size()-1);
 
     nAliveStop = 0;
@@ -250,6 +276,8 @@ public:
     nAliveForward = 0;
     nAliveLeft = 0;
     nAliveRight = 0;
+    nTargetForward = 0;
+    nTargetStop = 0;
 
     pStop  = 0;
     pYield = 0;
@@ -284,7 +312,22 @@ public:
       }
     }
 
+    sorted_ids = ids;
+    std::sort(sorted_ids.begin(), sorted_ids.end());
     path_last_pose = _path.at(_path.size()-1);
+
+    //warm starts refer to the old trajectory
+    ResetPathIndices(m_ForwardPart);
+    ResetPathIndices(m_StopPart);
+    ResetPathIndices(m_YieldPart);
+    ResetPathIndices(m_LeftPart);
+    ResetPathIndices(m_RightPart);
+  }
+
+  void ResetPathIndices(std::vector<Particle>& particles)
+  {
+    for(unsigned int i = 0; i < particles.size(); i++)
+      particles.at(i).path_index = -1;
   }
 
   double CalcMatchingPercentage(const std::vector<PlannerHNS::WayPoint>& _path)
@@ -318,14 +361,8 @@ public:
     int nEqualities = 0;
     for(unsigned int i=0; i < _ids.size(); i++)
     {
-      for(unsigned int j=0; j < ids.size(); j++)
-      {
-        if(_ids.at(i) == ids.at(j))
-        {
-          nEqualities++;
-          break;
-        }
-      }
+      if(std::binary_search(sorted_ids.begin(), sorted_ids.end(), _ids.at(i)))
+        nEqualities++;
     }
 
     double rms_val = 0;
@@ -367,7 +404,7 @@ public:
 
   void InsertNewParticle(const Particle& p)
   {
-    if(p.beh == PlannerHNS::BEH_STOPPING_STATE && nAliveStop < BEH_PARTICLES_NUM)
+    if(p.beh == PlannerHNS::BEH_STOPPING_STATE && nAliveStop < nTargetStop)
     {
       m_StopPart.push_back(p);
       m_StopPart.at(m_StopPart.size()-1).pTraj = this;
@@ -379,7 +416,7 @@ public:
       m_YieldPart.at(m_YieldPart.size()-1).pTraj = this;
       nAliveYield++;
     }
-    else if(p.beh == PlannerHNS::BEH_FORWARD_STATE && nAliveForward < BEH_PARTICLES_NUM)
+    else if(p.beh == PlannerHNS::BEH_FORWARD_STATE && nAliveForward < nTargetForward)
     {
       m_ForwardPart.push_back(p);
       m_ForwardPart.at(m_ForwardPart.size()-1).pTraj = this;
@@ -399,6 +436,21 @@ public:
     }
   }
 
+  //keeps the nMax highest weight particles, used when the number of particles is reduced
+  void TrimParticles(std::vector<Particle>& particles, int& nAlive, const int& nMax)
+  {
+    if(nMax < 0 || (int)particles.size() <= nMax) return;
+
+    std::sort(particles.begin(), particles.end(), IsHigherWeight);
+    particles.resize(nMax);
+    nAlive = particles.size();
+  }
+
+  static bool IsHigherWeight(const Particle& p1, const Particle& p2)
+  {
+    return p1.w > p2.w;
+  }
+
   void DeleteParticle(const Particle& p, const int& _i)
   {
     if(p.beh == PlannerHNS::BEH_STOPPING_STATE && nAliveStop > BEH_MIN_PARTICLE_NUM)
@@ -479,7 +531,9 @@ public:
   void CalcProbabilities()
   {
     best_beh = PlannerHNS::BEH_STOPPING_STATE;
-    pStop  = (double)nAliveStop/(double)BEH_PARTICLES_NUM;
+    pStop = 0;
+    if(nTargetStop > 0)
+      pStop  = (double)nAliveStop/(double)nTargetStop;
     best_p = pStop;
 
     pYield = (double)nAliveYield/(double)BEH_PARTICLES_NUM;
@@ -489,7 +543,9 @@ public:
       best_beh = PlannerHNS::BEH_YIELDING_STATE;
     }
 
-    pForward = (double)nAliveForward/(double)BEH_PARTICLES_NUM;
+    pForward = 0;
+    if(nTargetForward > 0)
+      pForward = (double)nAliveForward/(double)nTargetForward;
     if(pForward > best_p)
     {
       best_p = pForward;
@@ -785,6 +841,14 @@ public:
   BehaviorPrediction();
   virtual ~BehaviorPrediction();
   void DoOneStep(const std::vector<DetectedObject>& obj_list, const WayPoint& currPose, const double& minSpeed, const double& maxDeceleration, RoadNetwork& map);
+  //each DoOneStep reseeds the particle generator, the next cycle with seed and the following ones with seeds
+  //derived from it. Without a seed the clock is used.
+  void SetRandomSeed(const unsigned int& seed);
+  unsigned int GetRandomSeed() const;
+  //seed of the last DoOneStep, setting it as random seed replays that cycle's sampling
+  unsigned int GetCycleSeed() const;
+  //when set, each DoOneStep writes its inputs, the cycle seed and the predicted objects as a prediction only cycle
+  void SetCycleRecorder(PlannerCycleRecorder* pRecorder);
 
 public:
   std::vector<PassiveDecisionMaker*> m_d_makers;
@@ -794,6 +858,9 @@ public:
   bool m_bUseFixedPrediction;
   bool m_bStepByStep;
   bool m_bParticleFilter;
+  //particles per trajectory and behavior, adaptive (KLD-sampling) between the two when min < max
+  int m_MinParticlesNum;
+  int m_MaxParticlesNum;
   //std::vector<DetectedObject> m_PredictedObjects;
   //std::vector<DetectedObject*> m_PredictedObjectsII;
 
@@ -809,6 +876,11 @@ public:
   bool m_bCanDecide;
   bool m_bFirstMove;
   bool m_bDebugOut;
+  unsigned int m_RandomSeed;
+  unsigned int m_CycleSeed;
+  unsigned int m_nCyclesSinceSeed;
+  ENG m_RandomEngine;
+  PlannerCycleRecorder* m_pCycleRecorder;
 
 
 protected:
@@ -838,6 +910,8 @@ protected:
   void RemoveWeakParticles(ObjParticles* pParts);
   void FindBest(ObjParticles* pParts);
   void CalculateAveragesAndProbabilities(ObjParticles* pParts);
+  void UpdateParticlesNum(ObjParticles* pParts);
+  int CalcKLDParticlesNum(const std::vector<Particle>& particles);
 
   static bool sort_weights(const Particle* p1, const Particle* p2)
   {
@@ -848,31 +922,6 @@ protected:
   {
     return p1.second > p2.second;
   }
-
-
-public:
-  //move to CPP later
-  void DeleteFromList(std::vector<ObjParticles*>& delete_me, const ObjParticles* pElement)
-  {
-    for(unsigned int k = 0; k < delete_me.size(); k++)
-    {
-      if(delete_me.at(k) == pElement)
-      {
-        delete_me.erase(delete_me.begin()+k);
-        return;
-      }
-    }
-  }
-
-  void DeleteTheRest(std::vector<ObjParticles*>& delete_me)
-  {
-    for(unsigned int k = 0; k < delete_me.size(); k++)
-    {
-      delete delete_me.at(k);
-    }
-
-    delete_me.clear();
-  }
 };
 
 
@@ -23,6 +23,7 @@ public:
   ControllerParams m_ControlParams;
   std::vector<WayPoint> m_Path;
   PlannerHNS::RoadNetwork m_Map;
+  PlannerHNS::RoadNetwork* m_pMap; //used instead of m_Map when set, many agents can share one map
 
   double m_MaxLaneSearchDistance;
   int m_iCurrentTotalPathId;
@@ -80,9 +81,9 @@ protected:
 
 
 
-  std::vector<PlannerHNS::WayPoint> t_centerTrajectorySmoothed;
   std::vector<std::vector<WayPoint> > m_TotalOriginalPath;
   std::vector<std::vector<WayPoint> > m_TotalPath;
+  std::vector<ClosestPointInfo> m_TotalPathClosePoints; //closest point on each original path at the last extraction, cleared with a new global path
   PlannerHNS::PlanningParams m_params;
 
 };
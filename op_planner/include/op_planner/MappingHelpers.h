@@ -11,6 +11,7 @@
 
 #include <math.h>
 #include "RoadNetwork.h"
+#include "RoadNetworkSnapshot.h"
 #include "op_utility/UtilityH.h"
 #include "op_utility/DataRW.h"
 #include "tinyxml.h"
@@ -70,6 +71,11 @@ public:
 
   static void UpdateMapWithOccupancyGrid(OccupancyToGridMap& map_info, const std::vector<int>& data, RoadNetwork& map, std::vector<WayPoint*>& updated_list);
 
+  //same costs as above, published as a new layer of the versioned map instead of written into the map points,
+  //updated_ids stays empty when a new base map is set during the update
+  static std::shared_ptr<const RoadNetworkSnapshot> UpdateMapWithOccupancyGrid(OccupancyToGridMap& map_info,
+      const std::vector<int>& data, VersionedRoadNetwork& map, std::vector<int>& updated_ids);
+
   static bool GetWayPoint(const int& id, const int& laneID,const double& refVel, const int& did,
       const std::vector<UtilityHNS::AisanCenterLinesFileReader::AisanCenterLine>& dtpoints,
       const std::vector<UtilityHNS::AisanPointsFileReader::AisanPoints>& points,
@@ -10,6 +10,7 @@
 
 #include "RoadNetwork.h"
 #include <math.h>
+#include <vector>
 
 
 namespace PlannerHNS {
@@ -74,6 +75,98 @@ public:
   }
 };
 
+//2D rigid transform p' = R(p + pre) + post. Does the work of a translation, rotation, translation chain of Mat3
+//in one pass without the zero and one multiplications of the full 3x3 products.
+//ToFrame and FromFrame give the same values as the Mat3 pairs they replace.
+class RigidTransform2D
+{
+public:
+  double c;
+  double s;
+  double preX;
+  double preY;
+  double postX;
+  double postY;
+
+  RigidTransform2D()
+  {
+    c = 1; s = 0;
+    preX = preY = 0;
+    postX = postY = 0;
+  }
+
+  RigidTransform2D(const double& rotation_angle, const double& pre_x, const double& pre_y, const double& post_x,
+      const double& post_y)
+  {
+    c = cos(rotation_angle);
+    s = sin(rotation_angle);
+    preX = pre_x;
+    preY = pre_y;
+    postX = post_x;
+    postY = post_y;
+  }
+
+  //from the global frame to the frame at (x, y) with heading a, replaces Mat3(-x, -y) then Mat3(-a)
+  static RigidTransform2D ToFrame(const double& x, const double& y, const double& a)
+  {
+    return RigidTransform2D(-a, -x, -y, 0, 0);
+  }
+
+  //from the frame at (x, y) with heading a to the global frame, replaces Mat3(a) then Mat3(x, y)
+  static RigidTransform2D FromFrame(const double& x, const double& y, const double& a)
+  {
+    return RigidTransform2D(a, 0, 0, x, y);
+  }
+
+  RigidTransform2D Inverse() const
+  {
+    RigidTransform2D inv;
+    inv.c = c;
+    inv.s = -s;
+    inv.preX = -postX;
+    inv.preY = -postY;
+    inv.postX = -preX;
+    inv.postY = -preY;
+    return inv;
+  }
+
+  //this transform applied after t
+  RigidTransform2D operator * (const RigidTransform2D& t) const
+  {
+    RigidTransform2D r;
+    r.c = c*t.c - s*t.s;
+    r.s = s*t.c + c*t.s;
+    r.preX = t.preX;
+    r.preY = t.preY;
+    double x = t.postX + preX;
+    double y = t.postY + preY;
+    r.postX = c*x - s*y + postX;
+    r.postY = s*x + c*y + postY;
+    return r;
+  }
+
+  void Apply(double& x, double& y) const
+  {
+    double _x = x + preX;
+    double _y = y + preY;
+    x = c*_x - s*_y + postX;
+    y = s*_x + c*_y + postY;
+  }
+
+  GPSPoint operator * (GPSPoint v) const
+  {
+    Apply(v.x, v.y);
+    return v;
+  }
+
+  //in place, for contours and borders built in the local frame
+  void Apply(std::vector<GPSPoint>& points) const
+  {
+    for(unsigned int i = 0; i < points.size(); i++)
+      Apply(points[i].x, points[i].y);
+  }
+};
+
 } /* namespace PlannerHNS */
 
 #endif /* MATRIXOPERATIONS_H_ */
@@ -0,0 +1,52 @@
+
+/// \file ObstacleDistanceField.h
+/// \brief Distance field over a grid around the vehicle, gives the nearest obstacle contour point of any position
+
+#ifndef OBSTACLEDISTANCEFIELD_H_
+#define OBSTACLEDISTANCEFIELD_H_
+
+#include <vector>
+
+#include "RoadNetwork.h"
+
+namespace PlannerHNS
+{
+
+//Square grid centered at the vehicle, aligned with the map axes. Each cell keeps the contour point nearest to it,
+//found with an exact euclidean distance transform, so building costs the same for any number of points.
+//The returned clearance is the distance to that point, at most 2*sqrt(2)*res more than the exact nearest distance.
+class ObstacleDistanceField
+{
+public:
+  double res;
+  double originX;
+  double originY;
+  int width;
+
+  ObstacleDistanceField()
+  {
+    res = 0;
+    originX = originY = 0;
+    width = 0;
+  }
+
+  //grid from center - half_size to center + half_size, points outside of it are ignored
+  void Build(const GPSPoint& center, const double& half_size, const double& _res, const std::vector<WayPoint>& points);
+
+  //distance to the nearest point and its index in the points given to Build,
+  //DBL_MAX and -1 when the position is outside the grid or there are no points
+  double GetClearance(const double& x, const double& y, int& point_index) const;
+
+private:
+  std::vector<GPSPoint> m_Points;
+  std::vector<int> m_Nearest;
+  std::vector<int> m_Seeds;
+  std::vector<double> m_ColumnDist;
+  std::vector<int> m_ColumnNearest;
+  std::vector<double> m_Envelope;
+  std::vector<int> m_EnvelopeCells;
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* OBSTACLEDISTANCEFIELD_H_ */
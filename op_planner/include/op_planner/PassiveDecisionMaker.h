@@ -15,6 +15,39 @@
 namespace PlannerHNS
 {
 
+class StopLineEvent
+{
+public:
+  int stopLineID;
+  int stopSignID;
+  int trafficLightID;
+  RelativeInfo info; //stop line position relative to the path
+
+  StopLineEvent()
+  {
+    stopLineID = -1;
+    stopSignID = -1;
+    trafficLightID = -1;
+  }
+};
+
+//Everything about one predicted trajectory that is the same for all of its particles,
+//built once per trajectory so a particle step does not walk the path again.
+class PassivePathContext
+{
+public:
+  std::vector<double> arc_length; //distance along the path at each waypoint
+  std::vector<StopLineEvent> stop_lines; //stop lines in path order
+  std::vector<int> next_stop_line; //first stop_lines entry at or after each waypoint, size of stop_lines if none
+  std::vector<int> next_turn; //first waypoint at or after each waypoint with a turn action, -1 if none
+  RelativeInfo start_info; //path start relative to the path
+
+  void Init(const std::vector<WayPoint>& path);
+  double GetExactDistance(const RelativeInfo& p1, const RelativeInfo& p2) const;
+  double GetDistanceToClosestStopLine(const RelativeInfo& info, const double& giveUpDistance, int& stopLineID, int& stopSignID, int& trafficLightID) const;
+  LIGHT_INDICATOR GetIndicator(const std::vector<WayPoint>& path, const RelativeInfo& info, const double& searchDistance) const;
+};
+
 class PassiveDecisionMaker
 {
 public:
@@ -24,11 +57,14 @@ public:
   virtual ~PassiveDecisionMaker();
   PlannerHNS::BehaviorState MoveStep(const double& dt, PlannerHNS::WayPoint& currPose, const std::vector<WayPoint>& path, const CAR_BASIC_INFO& carInfo);
   PlannerHNS::ParticleInfo MoveStepSimple(const double& dt, PlannerHNS::WayPoint& currPose, const std::vector<WayPoint>& path, const CAR_BASIC_INFO& carInfo);
+  //pathIndex is the caller's warm start for the closest point search, -1 searches the whole path
+  PlannerHNS::ParticleInfo MoveStepSimple(const double& dt, PlannerHNS::WayPoint& currPose, const std::vector<WayPoint>& path, const PassivePathContext& context, int& pathIndex, const CAR_BASIC_INFO& carInfo);
 
 private:
   double GetVelocity(PlannerHNS::WayPoint& currPose, const std::vector<WayPoint>& path, const CAR_BASIC_INFO& carInfo, const RelativeInfo& info);
   double GetSteerAngle(PlannerHNS::WayPoint& currPose, const std::vector<WayPoint>& path, const RelativeInfo& info);
   bool CheckForStopLine(PlannerHNS::WayPoint& currPose, const std::vector<WayPoint>& path, const CAR_BASIC_INFO& carInfo);
+  bool CheckForStopLine(PlannerHNS::WayPoint& currPose, const PassivePathContext& context, const RelativeInfo& info, const CAR_BASIC_INFO& carInfo);
 
 };
 
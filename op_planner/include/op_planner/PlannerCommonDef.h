@@ -102,6 +102,7 @@ public:
   double width;
   double max_acceleration;
   double max_deceleration;
+  double max_lateral_acceleration;
 
   CAR_BASIC_INFO()
   {
@@ -121,6 +122,7 @@ public:
     width          = 1.82;
     max_acceleration    = 1.5; // m/s2
     max_deceleration    = -1.5; // 1/3 G
+    max_lateral_acceleration = 1.5; // m/s2
   }
 
   double CalcMaxSteeringAngle()
@@ -0,0 +1,132 @@
+
+/// \file PlannerCycleRecorder.h
+/// \brief Record the inputs and outputs of local planner cycles to a binary file and read them back for offline replay
+
+
+#ifndef PLANNERCYCLERECORDER_H_
+#define PLANNERCYCLERECORDER_H_
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "RoadNetwork.h"
+#include "PlannerCommonDef.h"
+
+namespace PlannerHNS
+{
+
+#define PLANNER_CYCLE_FILE_VERSION 3
+
+class PredictionParams
+{
+public:
+  double minSpeed;
+  double maxDeceleration;
+  double maxLaneDetectionDistance;
+  double predictionDistance;
+  bool bGenerateBranches;
+  bool bUseFixedPrediction;
+  bool bParticleFilter;
+  bool bStepByStep; //fixed particle time step, wall clock steps can't be replayed exactly
+  unsigned int randomSeed; //seed of this cycle's particles, see BehaviorPrediction::SetRandomSeed
+
+  PredictionParams()
+  {
+    minSpeed = 0;
+    maxDeceleration = -3;
+    maxLaneDetectionDistance = 0.5;
+    predictionDistance = 25;
+    bGenerateBranches = false;
+    bUseFixedPrediction = true;
+    bParticleFilter = false;
+    bStepByStep = false;
+    randomSeed = 0;
+  }
+};
+
+//Everything that BehaviorPrediction, TrajectoryDynamicCosts and DecisionMaker consumed in one planning cycle,
+//plus what they produced so a replay can be checked against it.
+class PlannerCycle
+{
+public:
+  double dt;
+  WayPoint currPose;
+  VehicleState vehicleState;
+  int goalID;
+  bool bEmergencyStop;
+  int currTrajectoryIndex;
+  int currLaneIndex;
+
+  PlanningParams params;
+  CAR_BASIC_INFO carInfo;
+  ControllerParams ctrlParams;
+  PredictionParams predictionParams;
+
+  bool bNewGlobalPath;
+  std::vector<std::vector<WayPoint> > globalPaths;
+  std::vector<std::vector<std::vector<WayPoint> > > rollOuts; //trajectory evaluator input, per global path
+  std::vector<std::vector<WayPoint> > totalPaths;
+  std::vector<std::vector<WayPoint> > decisionRollOuts; //behavior selector input, DecisionMaker::m_RollOuts
+  std::vector<TrafficLight> trafficLights;
+  std::vector<DetectedObject> detectedObjects; //prediction input
+  std::vector<DetectedObject> predictedObjects; //trajectory evaluator input
+
+  bool bHasTrajectoryCost;
+  TrajectoryCost trajectoryCost;
+  bool bHasBehavior;
+  BehaviorState behavior;
+
+  //Lanes referenced by the recorded waypoints, only ids, speeds and stop lines are kept.
+  //Shared so that copies of a cycle keep valid pLane pointers.
+  std::shared_ptr<std::vector<Lane> > pLanes;
+
+  PlannerCycle()
+  {
+    dt = 0;
+    goalID = 0;
+    bEmergencyStop = false;
+    currTrajectoryIndex = -1;
+    currLaneIndex = -1;
+    bNewGlobalPath = false;
+    bHasTrajectoryCost = false;
+    bHasBehavior = false;
+  }
+};
+
+class PlannerCycleRecorder
+{
+public:
+  PlannerCycleRecorder();
+  virtual ~PlannerCycleRecorder();
+
+  bool Open(const std::string& fileName);
+  void Close();
+  bool IsOpen() const;
+  bool Write(const PlannerCycle& cycle);
+
+private:
+  std::ofstream m_File;
+  std::string m_Buffer;
+};
+
+class PlannerCycleReader
+{
+public:
+  PlannerCycleReader();
+  virtual ~PlannerCycleReader();
+
+  bool Open(const std::string& fileName);
+  void Close();
+  bool IsOpen() const;
+  bool Read(PlannerCycle& cycle);
+
+private:
+  std::ifstream m_File;
+  std::string m_Buffer;
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* PLANNERCYCLERECORDER_H_ */
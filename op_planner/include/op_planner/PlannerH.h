@@ -10,6 +10,7 @@
 #define LANE_CHANGE_SMOOTH_FACTOR_DISTANCE 8 // meters
 
 #include "RoadNetwork.h"
+#include "RoadNetworkSnapshot.h"
 
 namespace PlannerHNS
 {
@@ -32,9 +33,11 @@ public:
         std::vector<std::vector<std::vector<WayPoint> > >& rollOutsPaths,
         std::vector<WayPoint>& sampledPoints);
 
+  //pCosts: dynamic action costs for the search, map has to be its base map or a copy of it
   double PlanUsingDP(const WayPoint& carPos,const WayPoint& goalPos,
       const double& maxPlanningDistance, const bool bEnableLaneChange, const std::vector<int>& globalPath,
-      RoadNetwork& map, std::vector<std::vector<WayPoint> >& paths, std::vector<WayPoint*>* all_cell_to_delete = 0);
+      RoadNetwork& map, std::vector<std::vector<WayPoint> >& paths, std::vector<WayPoint*>* all_cell_to_delete = 0,
+      const RoadNetworkSnapshot* pCosts = 0);
 
    double PlanUsingDPRandom(const WayPoint& start,
         const double& maxPlanningDistance,
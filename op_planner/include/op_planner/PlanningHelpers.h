@@ -9,6 +9,8 @@
 #define PLANNINGHELPERS_H_
 
 #include "RoadNetwork.h"
+#include "RoadNetworkSnapshot.h"
+#include "PlannerCommonDef.h"
 #include "op_utility/UtilityH.h"
 #include "op_utility/DataRW.h"
 #include "tinyxml.h"
@@ -24,6 +26,7 @@ namespace PlannerHNS {
 #define LANE_CHANGE_COST 3.0 // meters
 #define BACKUP_STRAIGHT_PLAN_DISTANCE 75 //meters
 #define LANE_CHANGE_MIN_DISTANCE 5
+#define MAX_PROFILE_SMOOTHING_ITERATIONS 1000
 
 class PlanningHelpers
 {
@@ -37,6 +40,9 @@ public:
 
   static bool GetRelativeInfo(const std::vector<WayPoint>& trajectory, const WayPoint& p, RelativeInfo& info, const int& prevIndex = 0);
 
+  //same as GetRelativeInfo but with the index of the next trajectory point already known
+  static bool GetRelativeInfoFromIndex(const std::vector<WayPoint>& trajectory, const WayPoint& p, const int& iFront, RelativeInfo& info);
+
   static bool GetRelativeInfoRange(const std::vector<std::vector<WayPoint> >& trajectories, const WayPoint& p, const double& searchDistance, RelativeInfo& info);
 
   static bool GetRelativeInfoLimited(const std::vector<WayPoint>& trajectory, const WayPoint& p, RelativeInfo& info, const int& prevIndex = 0);
@@ -51,7 +57,15 @@ public:
 
   static int GetClosestNextPointIndexFastV2(const std::vector<WayPoint>& trajectory, const WayPoint& p, const int& prevIndex = 0);
 
-  static int GetClosestNextPointIndexDirectionFast(const std::vector<WayPoint>& trajectory, const WayPoint& p, const int& prevIndex = 0);
+  //searches around startIndex only, for poses that move continuously along the trajectory
+  static int GetClosestNextPointIndexLocal(const std::vector<WayPoint>& trajectory, const WayPoint& p, const int& startIndex);
+
+  //searches from prevIndex to endIndex, -1 searches to the end of the trajectory
+  static int GetClosestNextPointIndexDirectionFast(const std::vector<WayPoint>& trajectory, const WayPoint& p, const int& prevIndex = 0, const int& endIndex = -1);
+
+  //searches searchDistance along the trajectory from the last result in info, and falls back to the whole trajectory
+  //when there is no last result, the pose moved backward or past the searched part, or its distance to the trajectory grew
+  static int GetClosestNextPointIndexDirectionWarm(const std::vector<WayPoint>& trajectory, const WayPoint& p, const double& searchDistance, ClosestPointInfo& info);
 
   static int GetClosestNextPointIndexDirectionFastV2(const std::vector<WayPoint>& trajectory, const WayPoint& p, const int& prevIndex = 0);
 
@@ -71,6 +85,12 @@ public:
 
   static void FixPathDensity(std::vector<WayPoint>& path, const double& distanceDensity);
 
+  // Resamples path at exact arc length steps of distanceDensity into fixedPath, interpolating position, heading and velocity
+  static void FixPathDensity(const std::vector<WayPoint>& path, const double& distanceDensity, std::vector<WayPoint>& fixedPath);
+
+  // Same as above for the part path[start..end], without copying it out first
+  static void FixPathDensity(const std::vector<WayPoint>& path, const int& start, const int& end, const double& distanceDensity, std::vector<WayPoint>& fixedPath);
+
   static void SmoothPath(std::vector<WayPoint>& path, double weight_data =0.25,double weight_smooth = 0.25,double tolerance = 0.01);
 
   static double CalcCircle(const GPSPoint& pt1, const GPSPoint& pt2, const GPSPoint& pt3, GPSPoint& center);
@@ -87,14 +107,21 @@ public:
 
   static double GetAccurateDistanceOnTrajectory(std::vector<WayPoint>& path, const int& start_index, const WayPoint& p);
 
+  // prevIndex is where the search for the closest point starts, 0 searches the whole path
   static void ExtractPartFromPointToDistance(const std::vector<WayPoint>& originalPath, const WayPoint& pos, const double& minDistance,
-      const double& pathDensity, std::vector<WayPoint>& extractedPath, const double& SmoothDataWeight, const double& SmoothWeight, const double& SmoothTolerance);
+      const double& pathDensity, std::vector<WayPoint>& extractedPath, const double& SmoothDataWeight, const double& SmoothWeight, const double& SmoothTolerance,
+      const int& prevIndex = 0);
 
   static void ExtractPartFromPointToDistanceFast(const std::vector<WayPoint>& originalPath, const WayPoint& pos, const double& minDistance,
-        const double& pathDensity, std::vector<WayPoint>& extractedPath, const double& SmoothDataWeight, const double& SmoothWeight, const double& SmoothTolerance);
+        const double& pathDensity, std::vector<WayPoint>& extractedPath, const double& SmoothDataWeight, const double& SmoothWeight, const double& SmoothTolerance,
+        const int& prevIndex = 0);
 
   static void ExtractPartFromPointToDistanceDirectionFast(const std::vector<WayPoint>& originalPath, const WayPoint& pos, const double& minDistance,
-      const double& pathDensity, std::vector<WayPoint>& extractedPath);
+      const double& pathDensity, std::vector<WayPoint>& extractedPath, const int& prevIndex = 0);
+
+  // Same as above with the closest point search warm started from closeInfo, which is updated for the next call on the same path
+  static void ExtractPartFromPointToDistanceDirectionFast(const std::vector<WayPoint>& originalPath, const WayPoint& pos, const double& minDistance,
+      const double& pathDensity, std::vector<WayPoint>& extractedPath, ClosestPointInfo& closeInfo);
 
   static void CalculateRollInTrajectories(const WayPoint& carPos, const double& speed, const std::vector<WayPoint>& originalCenter, int& start_index,
       int& end_index, std::vector<double>& end_laterals ,
@@ -111,21 +138,31 @@ public:
 
   static void SmoothWayPointsDirections(std::vector<WayPoint>& path_in, double weight_data, double weight_smooth, double tolerance  = 0.1);
 
+  // Same profile as GenerateSpeedProfile, limited by the highest point speed of the path and the default vehicle limits.
   static void SmoothGlobalPathSpeed(std::vector<WayPoint>& path);
 
+  // Curvature based speeds smoothed iteratively with SmoothSpeedProfiles, no acceleration limits.
+  // Kept for callers outside the planner, use GenerateSpeedProfile instead.
   static void GenerateRecommendedSpeed(std::vector<WayPoint>& path, const double& max_speed, const double& speedProfileFactor);
 
+  // Speed limit per point from max speed, map speed and lateral acceleration, then one forward (acceleration)
+  // and one backward (deceleration) pass. Linear time, no iterative smoothing. A negative point speed (v) means
+  // no map speed, 0 and above limits the point. Angles and costs of the path are not updated.
+  static void GenerateSpeedProfile(std::vector<WayPoint>& path, const PlanningParams& params, const CAR_BASIC_INFO& carInfo);
+
 //  static WayPoint* BuildPlanningSearchTree(Lane* l, const WayPoint& prevWayPointIndex,
 //      const WayPoint& startPos, const WayPoint& goalPos,
 //      const std::vector<int>& globalPath, const double& DistanceLimit,
 //      int& nMaxLeftBranches, int& nMaxRightBranches,
 //      std::vector<WayPoint*>& all_cells_to_delete );
 
+  //when pCosts is set the action costs are read through its layers instead of from the map points
   static WayPoint* BuildPlanningSearchTreeV2(WayPoint* pStart,
       const WayPoint& goalPos,
       const std::vector<int>& globalPath, const double& DistanceLimit,
       const bool& bEnableLaneChange,
-      std::vector<WayPoint*>& all_cells_to_delete );
+      std::vector<WayPoint*>& all_cells_to_delete,
+      const RoadNetworkSnapshot* pCosts = 0);
 
   static WayPoint* BuildPlanningSearchTreeStraight(WayPoint* pStart,
       const double& DistanceLimit,
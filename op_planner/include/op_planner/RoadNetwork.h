@@ -491,6 +491,19 @@ public:
   }
 };
 
+class ClosestPointInfo //closest point search result kept between steps to warm start the next search
+{
+public:
+  int index; // -1 before the first search
+  double distance;
+
+  ClosestPointInfo()
+  {
+    index = -1;
+    distance = 0;
+  }
+};
+
 class Boundary //represent wayarea in vector map
 {
 public:
@@ -1311,6 +1324,20 @@ public:
     //printf("Error Getting Cell with Info: P(%f,%f) , C(%d,%d), index = %d \n", p.x, p.y, row, col, index);
     return false;
   }
+
+  //Batch versions of GetCellIndexFromPoint for points in global coordinates. The grid transform is computed once
+  //for all points, and large inputs are split over threads. Indices of points outside the grid are -1.
+  void GetCellIndicesFromPoints(const std::vector<GPSPoint>& points, const int& data_size, std::vector<int>& indices) const;
+  void GetCellIndicesFromPoints(const std::vector<WayPoint>& points, const int& data_size, std::vector<int>& indices) const;
+
+  //Cell values of points in global coordinates, out_value for points outside the grid
+  void GetCellValuesFromPoints(const std::vector<GPSPoint>& points, const std::vector<int>& data, std::vector<int>& values, const int& out_value = -1) const;
+  void GetCellValuesFromPoints(const std::vector<WayPoint>& points, const std::vector<int>& data, std::vector<int>& values, const int& out_value = -1) const;
+
+  //Grow the cells that equal value by radius cells in every direction, so that point queries on the result
+  //include a safety margin without scanning neighbour cells for each query
+  void DilateCells(const std::vector<int>& data, const int& value, const int& radius, std::vector<int>& dilated) const;
+
 private:
 
   int get2dIndex(const int& r,const int& c)
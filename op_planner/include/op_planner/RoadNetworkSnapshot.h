@@ -0,0 +1,98 @@
+
+/// \file RoadNetworkSnapshot.h
+/// \brief Versioned read only snapshots of a RoadNetwork with dynamic action cost layers on top of it
+
+#ifndef ROADNETWORKSNAPSHOT_H_
+#define ROADNETWORKSNAPSHOT_H_
+
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "RoadNetwork.h"
+
+namespace PlannerHNS
+{
+
+//above this number of layers a new layer takes in the layers below it, keeps the lookups short
+#define MAP_OVERLAY_MAX_DEPTH 8
+
+typedef std::vector<std::pair<ACTION_TYPE, double> > ActionCosts;
+
+//action costs by waypoint id
+typedef std::unordered_map<int, ActionCosts> ActionCostsMap;
+
+//One published set of action cost changes. Only the changed waypoints are stored, the rest is found in the
+//layers below. A layer never changes once published, newer changes go into a new layer.
+class MapCostOverlay
+{
+public:
+  unsigned long version;
+  unsigned int depth;
+  ActionCostsMap actionCosts;
+  std::shared_ptr<const MapCostOverlay> pParent;
+
+  MapCostOverlay()
+  {
+    version = 0;
+    depth = 0;
+  }
+
+  //the costs of the newest layer that has the waypoint, 0 if none has it
+  const ActionCosts* Find(const int& id) const;
+};
+
+//Consistent view of the map: the base map and the cost layers of one version. Holding the snapshot keeps
+//them alive, so it can be read from any thread while newer versions are published.
+class RoadNetworkSnapshot
+{
+public:
+  unsigned long version;
+  std::shared_ptr<const RoadNetwork> pMap;
+  std::shared_ptr<const MapCostOverlay> pOverlay;
+
+  RoadNetworkSnapshot()
+  {
+    version = 0;
+  }
+
+  //the waypoint costs with the layers applied, the waypoint must be from pMap or a copy of one
+  const ActionCosts& GetActionCosts(const WayPoint& wp) const;
+  double GetTotalActionCost(const WayPoint& wp) const;
+
+  //copy of the waypoint with the layer costs written in, for code that reads WayPoint::actionCost
+  WayPoint GetWayPoint(const WayPoint& wp) const;
+};
+
+//Read-copy-update holder of the current map snapshot. Readers take the current snapshot and never wait for
+//writers, writers build a new snapshot next to the old one and swap it in. Several writers can publish at
+//the same time, a writer that loses the swap rebuilds its layer on the newer snapshot and tries again.
+class VersionedRoadNetwork
+{
+public:
+  VersionedRoadNetwork();
+
+  std::shared_ptr<const RoadNetworkSnapshot> GetSnapshot() const;
+
+  //new base map, drops the cost layers of the previous map
+  std::shared_ptr<const RoadNetworkSnapshot> SetMap(const std::shared_ptr<const RoadNetwork>& pMap);
+
+  //publishes the costs as a new layer, waypoints not in the list keep their current costs
+  std::shared_ptr<const RoadNetworkSnapshot> PublishActionCosts(const ActionCostsMap& costs);
+
+  //publishes the costs as a new layer on top of pBase only, returns 0 when another version was published after
+  //pBase, for writers that build the costs from the snapshot they publish on
+  std::shared_ptr<const RoadNetworkSnapshot> PublishActionCosts(const std::shared_ptr<const RoadNetworkSnapshot>& pBase,
+      const ActionCostsMap& costs);
+
+private:
+  std::shared_ptr<const RoadNetworkSnapshot> m_pSnapshot;
+
+  std::shared_ptr<const RoadNetworkSnapshot> CreateLayer(const RoadNetworkSnapshot& current, const ActionCostsMap& costs) const;
+  bool Swap(std::shared_ptr<const RoadNetworkSnapshot>& expected, const std::shared_ptr<const RoadNetworkSnapshot>& next);
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* ROADNETWORKSNAPSHOT_H_ */
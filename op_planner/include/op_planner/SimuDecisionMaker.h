@@ -13,6 +13,25 @@
 namespace PlannerHNS
 {
 
+//Inputs and outputs of one simulated agent for one tick
+class SimuAgentStep
+{
+public:
+  PlannerHNS::VehicleState desiredStatus;
+  int goalID;
+  std::vector<TrafficLight> trafficLights;
+  std::vector<PlannerHNS::DetectedObject> objects;
+  bool bEmergencyStop;
+
+  PlannerHNS::VehicleState currStatus;
+  PlannerHNS::BehaviorState behavior;
+
+  SimuAgentStep()
+  {
+    goalID = -1;
+    bEmergencyStop = false;
+  }
+};
 
 class SimuDecisionMaker: public PlannerHNS::DecisionMaker
 {
@@ -50,6 +69,19 @@ public:
       const std::vector<TrafficLight>& trafficLight,
       const std::vector<PlannerHNS::DetectedObject>& objects,
       const bool& bEmergencyStop);
+
+  //LocalizeStep then DoOneStep with the inputs of the step, the results are written back into it
+  void Step(const double& dt, SimuAgentStep& step);
+
+  //Advances all agents one tick, agents[i] with steps[i]. Agents only touch their own state and read the map,
+  //so they run in parallel and give the same results as calling Step for each one in order.
+  //Agents that should not keep a copy of the map each can point m_pMap to the same one.
+  static void StepAgents(const double& dt, const std::vector<SimuDecisionMaker*>& agents, std::vector<SimuAgentStep>& steps);
+
+private:
+  //roll-out scratch, kept between steps so each agent reuses its own memory
+  std::vector<std::vector<std::vector<PlannerHNS::WayPoint> > > m_GeneratedRollOuts;
+  std::vector<PlannerHNS::WayPoint> m_SampledPoints;
 };
 
 }
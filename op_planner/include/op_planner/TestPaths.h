@@ -0,0 +1,53 @@
+
+/// \file TestPaths.h
+/// \brief Synthetic paths shared by the op_planner and op_simu tests
+
+#ifndef TESTPATHS_H_
+#define TESTPATHS_H_
+
+#include <math.h>
+#include <vector>
+
+#include "RoadNetwork.h"
+
+namespace PlannerHNS
+{
+
+namespace TestPaths
+{
+
+// Straight line, a 90 degrees left arc of the given radius, then another straight line.
+// Only the positions are set.
+inline std::vector<WayPoint> CreateArcPath(const double& straight_length, const double& radius, const double& density)
+{
+  std::vector<WayPoint> path;
+  WayPoint p;
+  for(double d = 0; d < straight_length; d += density)
+  {
+    p.pos.x = d;
+    p.pos.y = 0;
+    path.push_back(p);
+  }
+
+  double arc_step = density / radius;
+  for(double a = 0; a < M_PI_2; a += arc_step)
+  {
+    p.pos.x = straight_length + radius * sin(a);
+    p.pos.y = radius - radius * cos(a);
+    path.push_back(p);
+  }
+
+  for(double d = 0; d < straight_length; d += density)
+  {
+    p.pos.x = straight_length + radius;
+    p.pos.y = radius + d;
+    path.push_back(p);
+  }
+  return path;
+}
+
+} /* namespace TestPaths */
+
+} /* namespace PlannerHNS */
+
+#endif /* TESTPATHS_H_ */
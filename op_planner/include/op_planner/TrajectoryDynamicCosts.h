@@ -11,6 +11,7 @@
 #include "RoadNetwork.h"
 #include "PlannerCommonDef.h"
 #include "PlanningHelpers.h"
+#include "ObstacleDistanceField.h"
 
 using namespace std;
 
@@ -51,6 +52,10 @@ public:
   double m_LateralSkipDistance;
   double m_CollisionTimeDiff;
 
+  //static costs from a distance field of the contour points instead of checking each point against each roll-out
+  bool m_bUseDistanceField;
+  double m_DistanceFieldResolution;
+  ObstacleDistanceField m_DistanceField;
 
 
 private:
@@ -59,6 +64,7 @@ private:
   void NormalizeCosts(vector<TrajectoryCost>& trajectoryCosts);
   void CalculateLateralAndLongitudinalCosts(vector<TrajectoryCost>& trajectoryCosts, const vector<vector<vector<WayPoint> > >& rollOuts, const vector<vector<WayPoint> >& totalPaths, const WayPoint& currState, const vector<WayPoint>& contourPoints, const PlanningParams& params, const CAR_BASIC_INFO& carInfo, const VehicleState& vehicleState);
   void CalculateLateralAndLongitudinalCostsStatic(vector<TrajectoryCost>& trajectoryCosts, const vector<vector<WayPoint> >& rollOuts, const vector<WayPoint>& totalPaths, const WayPoint& currState, const vector<WayPoint>& contourPoints, const PlanningParams& params, const CAR_BASIC_INFO& carInfo, const VehicleState& vehicleState);
+  void CalculateLateralAndLongitudinalCostsDistanceField(vector<TrajectoryCost>& trajectoryCosts, const vector<vector<WayPoint> >& rollOuts, const WayPoint& currState, const vector<WayPoint>& contourPoints, const PlanningParams& params, const CAR_BASIC_INFO& carInfo, const VehicleState& vehicleState);
   void CalculateTransitionCosts(vector<TrajectoryCost>& trajectoryCosts, const int& currTrajectoryIndex, const PlanningParams& params);
   
   void CalculateIntersectionVelocities(const std::vector<WayPoint>& path, const DetectedObject& obj, const WayPoint& currPose, const CAR_BASIC_INFO& carInfo, const double& c_lateral_d, WayPoint& collisionPoint, TrajectoryCost& trajectoryCosts);
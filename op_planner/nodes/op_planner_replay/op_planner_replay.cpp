@@ -0,0 +1,274 @@
+
+/// \file op_planner_replay.cpp
+/// \brief Headless replay of recorded planner cycles, reports per stage timing and checks outputs against the recording
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "op_planner/BehaviorPrediction.h"
+#include "op_planner/DecisionMaker.h"
+#include "op_planner/MappingHelpers.h"
+#include "op_planner/PlannerCycleRecorder.h"
+#include "op_planner/TrajectoryDynamicCosts.h"
+#include "op_utility/UtilityH.h"
+
+namespace
+{
+
+const double OUTPUT_TOLERANCE = 1e-6;
+
+void PrintUsage()
+{
+  std::cout << "Usage: op_planner_replay <recording> [--map <kml file or vector map folder>] [--repeat <n>] [--no-check]" << std::endl;
+  std::cout << "  Replays recorded planner cycles through BehaviorPrediction, TrajectoryDynamicCosts and DecisionMaker." << std::endl;
+  std::cout << "  Each stage gets its recorded inputs, so the stages are independent of each other's replayed outputs." << std::endl;
+  std::cout << "  Predictions are checked against the recording when they were recorded with fixed particle steps," << std::endl;
+  std::cout << "  this needs the map that the recording was made with." << std::endl;
+}
+
+void PrintTimings(const std::string& name, std::vector<double> times)
+{
+  std::cout << std::left << std::setw(12) << name;
+  if(times.size() == 0)
+  {
+    std::cout << "not run" << std::endl;
+    return;
+  }
+
+  std::sort(times.begin(), times.end());
+  double sum = 0;
+  for(unsigned int i = 0; i < times.size(); i++)
+    sum += times.at(i);
+
+  //times are in seconds, reported in milliseconds
+  std::cout << std::fixed << std::setprecision(3)
+      << "n: " << times.size()
+      << ", mean: " << sum / times.size() * 1000.0
+      << ", p50: " << times.at(times.size() * 50 / 100) * 1000.0
+      << ", p90: " << times.at(times.size() * 90 / 100) * 1000.0
+      << ", p99: " << times.at(times.size() * 99 / 100) * 1000.0
+      << ", max: " << times.back() * 1000.0 << " ms" << std::endl;
+}
+
+bool SameTrajectoryCost(const PlannerHNS::TrajectoryCost& a, const PlannerHNS::TrajectoryCost& b)
+{
+  return a.index == b.index && a.bBlocked == b.bBlocked && a.lane_index == b.lane_index
+      && fabs(a.closest_obj_distance - b.closest_obj_distance) < OUTPUT_TOLERANCE
+      && fabs(a.closest_obj_velocity - b.closest_obj_velocity) < OUTPUT_TOLERANCE;
+}
+
+bool SamePredictedObjects(const std::vector<PlannerHNS::DetectedObject>& a, const std::vector<PlannerHNS::DetectedObject>& b)
+{
+  if(a.size() != b.size())
+    return false;
+
+  for(unsigned int i = 0; i < a.size(); i++)
+  {
+    if(a.at(i).id != b.at(i).id || a.at(i).predTrajectories.size() != b.at(i).predTrajectories.size())
+      return false;
+
+    for(unsigned int t = 0; t < a.at(i).predTrajectories.size(); t++)
+    {
+      const std::vector<PlannerHNS::WayPoint>& path_a = a.at(i).predTrajectories.at(t);
+      const std::vector<PlannerHNS::WayPoint>& path_b = b.at(i).predTrajectories.at(t);
+      if(path_a.size() != path_b.size())
+        return false;
+
+      for(unsigned int j = 0; j < path_a.size(); j++)
+      {
+        if(fabs(path_a.at(j).pos.x - path_b.at(j).pos.x) >= OUTPUT_TOLERANCE
+            || fabs(path_a.at(j).pos.y - path_b.at(j).pos.y) >= OUTPUT_TOLERANCE)
+          return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool SameBehavior(const PlannerHNS::BehaviorState& a, const PlannerHNS::BehaviorState& b)
+{
+  return a.state == b.state && a.iTrajectory == b.iTrajectory && a.indicator == b.indicator
+      && a.bNewPlan == b.bNewPlan
+      && fabs(a.maxVelocity - b.maxVelocity) < OUTPUT_TOLERANCE
+      && fabs(a.followDistance - b.followDistance) < OUTPUT_TOLERANCE
+      && fabs(a.stopDistance - b.stopDistance) < OUTPUT_TOLERANCE;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  std::string recording;
+  std::string map_path;
+  int repeat = 1;
+  bool bCheck = true;
+
+  for(int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if(arg == "--map" && i + 1 < argc)
+      map_path = argv[++i];
+    else if(arg == "--repeat" && i + 1 < argc)
+      repeat = std::max(1, atoi(argv[++i]));
+    else if(arg == "--no-check")
+      bCheck = false;
+    else if(arg == "-h" || arg == "--help")
+    {
+      PrintUsage();
+      return 0;
+    }
+    else if(recording.empty())
+      recording = arg;
+    else
+    {
+      PrintUsage();
+      return 2;
+    }
+  }
+
+  if(recording.empty())
+  {
+    PrintUsage();
+    return 2;
+  }
+
+  std::vector<PlannerHNS::PlannerCycle> cycles;
+  PlannerHNS::PlannerCycleReader reader;
+  if(!reader.Open(recording))
+  {
+    std::cout << "Can't open recording " << recording << std::endl;
+    return 2;
+  }
+  PlannerHNS::PlannerCycle cycle;
+  while(reader.Read(cycle))
+    cycles.push_back(cycle);
+  reader.Close();
+
+  std::cout << "Loaded " << cycles.size() << " cycles from " << recording << std::endl;
+  if(cycles.size() == 0)
+    return 2;
+
+  PlannerHNS::RoadNetwork map;
+  if(!map_path.empty())
+  {
+    if(map_path.size() > 4 && map_path.compare(map_path.size() - 4, 4, ".kml") == 0)
+      PlannerHNS::MappingHelpers::LoadKML(map_path, map);
+    else
+      PlannerHNS::MappingHelpers::ConstructRoadNetworkFromDataFiles(map_path, map);
+  }
+
+  std::vector<double> prediction_times, costs_times, decision_times;
+  int nPredictionMismatches = 0, nCostMismatches = 0, nBehaviorMismatches = 0;
+  struct timespec t;
+
+  for(int r = 0; r < repeat; r++)
+  {
+    //fresh planner objects for every pass, the stages keep state between cycles
+    PlannerHNS::BehaviorPrediction prediction;
+    PlannerHNS::TrajectoryDynamicCosts trajectory_costs;
+    PlannerHNS::DecisionMaker decision_maker;
+    bool bDecisionInitialized = false;
+
+    const PlannerHNS::PredictionParams& pred_params = cycles.front().predictionParams;
+    prediction.m_MaxLaneDetectionDistance = pred_params.maxLaneDetectionDistance;
+    prediction.m_PredictionDistance = pred_params.predictionDistance;
+    prediction.m_bGenerateBranches = pred_params.bGenerateBranches;
+    prediction.m_bUseFixedPrediction = pred_params.bUseFixedPrediction;
+    prediction.m_bParticleFilter = pred_params.bParticleFilter;
+    prediction.m_bStepByStep = true; //fixed particle time step instead of wall clock
+
+    for(unsigned int i = 0; i < cycles.size(); i++)
+    {
+      const PlannerHNS::PlannerCycle& c = cycles.at(i);
+
+      if(c.detectedObjects.size() > 0)
+      {
+        //every cycle samples from its own recorded seed
+        prediction.SetRandomSeed(c.predictionParams.randomSeed);
+        UtilityHNS::UtilityH::GetTickCount(t);
+        prediction.DoOneStep(c.detectedObjects, c.currPose, c.predictionParams.minSpeed, c.predictionParams.maxDeceleration, map);
+        prediction_times.push_back(UtilityHNS::UtilityH::GetTimeDiffNow(t));
+
+        //particles moved by wall clock steps can't be reproduced
+        bool bDeterministic = c.predictionParams.bStepByStep || !c.predictionParams.bParticleFilter;
+        if(bCheck && bDeterministic)
+        {
+          std::vector<PlannerHNS::DetectedObject> predicted;
+          for(unsigned int j = 0; j < prediction.m_ParticleInfo_II.size(); j++)
+            predicted.push_back(prediction.m_ParticleInfo_II.at(j)->obj);
+
+          if(!SamePredictedObjects(predicted, c.predictedObjects))
+          {
+            if(r == 0)
+              std::cout << "Cycle " << i << " predictions differ, recorded objects: " << c.predictedObjects.size()
+                  << ", replayed objects: " << predicted.size() << std::endl;
+            nPredictionMismatches++;
+          }
+        }
+      }
+
+      if(c.rollOuts.size() > 0)
+      {
+        UtilityHNS::UtilityH::GetTickCount(t);
+        PlannerHNS::TrajectoryCost tc = trajectory_costs.DoOneStep(c.rollOuts, c.totalPaths, c.currPose,
+            c.currTrajectoryIndex, c.currLaneIndex, c.params, c.carInfo, c.vehicleState, c.predictedObjects);
+        costs_times.push_back(UtilityHNS::UtilityH::GetTimeDiffNow(t));
+
+        if(bCheck && c.bHasTrajectoryCost && !SameTrajectoryCost(tc, c.trajectoryCost))
+        {
+          if(r == 0)
+            std::cout << "Cycle " << i << " trajectory cost differs, recorded index: " << c.trajectoryCost.index
+                << ", replayed index: " << tc.index << std::endl;
+          nCostMismatches++;
+        }
+      }
+
+      //cycles written by the prediction recorder hook carry nothing for the decision maker
+      if(!c.bHasBehavior && c.decisionRollOuts.size() == 0 && c.globalPaths.size() == 0)
+        continue;
+
+      if(!bDecisionInitialized)
+      {
+        decision_maker.Init(c.ctrlParams, c.params, c.carInfo);
+        bDecisionInitialized = true;
+      }
+
+      if(c.bNewGlobalPath)
+        decision_maker.SetNewGlobalPath(c.globalPaths);
+
+      decision_maker.m_RollOuts = c.decisionRollOuts;
+
+      UtilityHNS::UtilityH::GetTickCount(t);
+      PlannerHNS::BehaviorState beh = decision_maker.DoOneStep(c.dt, c.currPose, c.vehicleState, c.goalID,
+          c.trafficLights, c.trajectoryCost, c.bEmergencyStop);
+      decision_times.push_back(UtilityHNS::UtilityH::GetTimeDiffNow(t));
+
+      if(bCheck && c.bHasBehavior && !SameBehavior(beh, c.behavior))
+      {
+        if(r == 0)
+          std::cout << "Cycle " << i << " behavior differs, recorded state: " << c.behavior.state
+              << ", replayed state: " << beh.state << std::endl;
+        nBehaviorMismatches++;
+      }
+    }
+  }
+
+  std::cout << std::endl << "Stage timings over " << repeat << " pass(es):" << std::endl;
+  PrintTimings("Prediction", prediction_times);
+  PrintTimings("Costs", costs_times);
+  PrintTimings("Decision", decision_times);
+
+  if(!bCheck)
+    return 0;
+
+  std::cout << std::endl << "Prediction mismatches: " << nPredictionMismatches
+      << ", trajectory cost mismatches: " << nCostMismatches
+      << ", behavior mismatches: " << nBehaviorMismatches << std::endl;
+
+  return (nPredictionMismatches > 0 || nCostMismatches > 0 || nBehaviorMismatches > 0) ? 1 : 0;
+}
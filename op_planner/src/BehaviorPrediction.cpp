@@ -10,6 +10,8 @@
 #include "op_planner/MappingHelpers.h"
 #include "op_planner/PlanningHelpers.h"
 #include "op_planner/MatrixOperations.h"
+#include <unordered_map>
+#include <unordered_set>
 
 
 namespace PlannerHNS
@@ -24,10 +26,16 @@ BehaviorPrediction::BehaviorPrediction()
   m_bStepByStep = false;
   m_bCanDecide = true;
   m_bParticleFilter = false;
+  m_MinParticlesNum = BEH_PARTICLES_NUM;
+  m_MaxParticlesNum = BEH_PARTICLES_NUM;
   UtilityHNS::UtilityH::GetTickCount(m_GenerationTimer);
   UtilityHNS::UtilityH::GetTickCount(m_ResamplingTimer);
   m_bFirstMove = true;
   m_bDebugOut = false;
+  m_pCycleRecorder = nullptr;
+  timespec _time;
+  UtilityHNS::UtilityH::GetTickCount(_time);
+  SetRandomSeed(_time.tv_nsec);
 }
 
 BehaviorPrediction::~BehaviorPrediction()
@@ -36,52 +44,91 @@ BehaviorPrediction::~BehaviorPrediction()
 
 void BehaviorPrediction::FilterObservations(const std::vector<DetectedObject>& obj_list, RoadNetwork& map, std::vector<DetectedObject>& filtered_list)
 {
+  //first slot of each id in filtered_list
+  std::unordered_map<int, unsigned int> filtered_index;
+  for(unsigned int ip=0; ip < filtered_list.size(); ip++)
+    filtered_index.insert(std::make_pair(filtered_list.at(ip).id, ip));
+
+  std::unordered_set<int> curr_ids;
   for(unsigned int i=0; i < obj_list.size(); i++)
   {
+    curr_ids.insert(obj_list.at(i).id);
+
     if(obj_list.at(i).t == SIDEWALK || obj_list.at(i).center.v < 1.0)
       continue;
 
-    bool bFound = false;
-    int found_index = 0;
-    for(unsigned int ip=0; ip < filtered_list.size(); ip++)
+    std::unordered_map<int, unsigned int>::iterator it = filtered_index.find(obj_list.at(i).id);
+    if(it != filtered_index.end())
     {
-      if(filtered_list.at(ip).id == obj_list.at(i).id)
-      {
-        found_index = ip;
-        bFound = true;
-        break;
-      }
+      filtered_list.at(it->second) = obj_list.at(i);
     }
-
-    if(bFound)
-      filtered_list.at(found_index) = obj_list.at(i);
     else
+    {
+      filtered_index.insert(std::make_pair(obj_list.at(i).id, filtered_list.size()));
       filtered_list.push_back(obj_list.at(i));
+    }
   }
 
-  for(int ip=0; ip < (int)filtered_list.size(); ip++)
+  //clean the objects that are not observed anymore, in one pass that keeps the order
+  unsigned int n_kept = 0;
+  for(unsigned int ip=0; ip < filtered_list.size(); ip++)
   {
-    //check for cleaning
-    bool bRevFound = false;
-    for(unsigned int ic=0; ic < obj_list.size(); ic++)
-    {
-      if(filtered_list.at(ip).id == obj_list.at(ic).id)
-      {
-        bRevFound = true;
-        break;
-      }
-    }
+    if(curr_ids.find(filtered_list.at(ip).id) == curr_ids.end())
+      continue;
 
-    if(!bRevFound)
-    {
-      filtered_list.erase(filtered_list.begin()+ip);
-      ip--;
-    }
+    if(n_kept != ip)
+      filtered_list.at(n_kept) = filtered_list.at(ip);
+    n_kept++;
   }
+  filtered_list.erase(filtered_list.begin()+n_kept, filtered_list.end());
+}
+
+void BehaviorPrediction::SetRandomSeed(const unsigned int& seed)
+{
+  m_RandomSeed = seed;
+  m_CycleSeed = seed;
+  m_nCyclesSinceSeed = 0;
+  m_RandomEngine.seed(seed);
+}
+
+unsigned int BehaviorPrediction::GetRandomSeed() const
+{
+  return m_RandomSeed;
+}
+
+unsigned int BehaviorPrediction::GetCycleSeed() const
+{
+  return m_CycleSeed;
+}
+
+void BehaviorPrediction::SetCycleRecorder(PlannerCycleRecorder* pRecorder)
+{
+  m_pCycleRecorder = pRecorder;
 }
 
 void BehaviorPrediction::DoOneStep(const std::vector<DetectedObject>& obj_list, const WayPoint& currPose, const double& minSpeed, const double& maxDeceleration, RoadNetwork& map)
 {
+  //a fresh seed per cycle, so that one cycle replays from its recorded seed whatever ran before it
+  m_CycleSeed = m_RandomSeed + m_nCyclesSinceSeed * 2654435761u;
+  m_nCyclesSinceSeed++;
+  m_RandomEngine.seed(m_CycleSeed);
+
+  PlannerCycle cycle;
+  if(m_pCycleRecorder != nullptr && m_pCycleRecorder->IsOpen())
+  {
+    cycle.currPose = currPose;
+    cycle.detectedObjects = obj_list;
+    cycle.predictionParams.minSpeed = minSpeed;
+    cycle.predictionParams.maxDeceleration = maxDeceleration;
+    cycle.predictionParams.maxLaneDetectionDistance = m_MaxLaneDetectionDistance;
+    cycle.predictionParams.predictionDistance = m_PredictionDistance;
+    cycle.predictionParams.bGenerateBranches = m_bGenerateBranches;
+    cycle.predictionParams.bUseFixedPrediction = m_bUseFixedPrediction;
+    cycle.predictionParams.bParticleFilter = m_bParticleFilter;
+    cycle.predictionParams.bStepByStep = m_bStepByStep;
+    cycle.predictionParams.randomSeed = m_CycleSeed;
+  }
+
   if(!m_bUseFixedPrediction && maxDeceleration !=0)
     m_PredictionDistance = -pow(currPose.v, 2)/(maxDeceleration);
 
@@ -92,6 +139,13 @@ void BehaviorPrediction::DoOneStep(const std::vector<DetectedObject>& obj_list,
   {
     ParticleFilterSteps(m_ParticleInfo_II);
   }
+
+  if(m_pCycleRecorder != nullptr && m_pCycleRecorder->IsOpen())
+  {
+    for(unsigned int i=0; i < m_ParticleInfo_II.size(); i++)
+      cycle.predictedObjects.push_back(m_ParticleInfo_II.at(i)->obj);
+    m_pCycleRecorder->Write(cycle);
+  }
 }
 
 void BehaviorPrediction::CalculateCollisionTimes(const double& minSpeed)
@@ -111,40 +165,36 @@ void BehaviorPrediction::ExtractTrajectoriesFromMap(const std::vector<DetectedOb
   PlannerH planner;
   m_temp_list_ii.clear();
 
-  std::vector<ObjParticles*> delete_me_list = old_obj_list;
+  //first old object of each id, objects with the same id are chained in list order
+  std::unordered_map<int, int> first_old;
+  std::vector<int> next_old(old_obj_list.size(), -1);
+  for(int ip = (int)old_obj_list.size()-1; ip >= 0; ip--)
+  {
+    std::unordered_map<int, int>::iterator it = first_old.find(old_obj_list.at(ip)->obj.id);
+    if(it != first_old.end())
+    {
+      next_old.at(ip) = it->second;
+      it->second = ip;
+    }
+    else
+    {
+      first_old.insert(std::make_pair(old_obj_list.at(ip)->obj.id, ip));
+    }
+  }
 
+  std::vector<bool> bMatched(old_obj_list.size(), false);
   for(unsigned int i=0; i < curr_obj_list.size(); i++)
   {
-    bool bMatch = false;
-    for(unsigned int ip=0; ip < old_obj_list.size(); ip++)
+    std::unordered_map<int, int>::iterator it = first_old.find(curr_obj_list.at(i).id);
+    if(it != first_old.end() && it->second >= 0)
     {
-      if(old_obj_list.at(ip)->obj.id == curr_obj_list.at(i).id)
-      {
-        bool bFound = false;
-        for(unsigned int k=0; k < m_temp_list_ii.size(); k++)
-        {
-          if(m_temp_list_ii.at(k) == old_obj_list.at(ip))
-          {
-            bFound = true;
-            break;
-          }
-        }
-
-        if(!bFound)
-        {
-          old_obj_list.at(ip)->obj = curr_obj_list.at(i);
-          m_temp_list_ii.push_back(old_obj_list.at(ip));
-        }
-
-        DeleteFromList(delete_me_list, old_obj_list.at(ip));
-
-        old_obj_list.erase(old_obj_list.begin()+ip);
-        bMatch = true;
-        break;
-      }
+      int ip = it->second;
+      it->second = next_old.at(ip);
+      bMatched.at(ip) = true;
+      old_obj_list.at(ip)->obj = curr_obj_list.at(i);
+      m_temp_list_ii.push_back(old_obj_list.at(ip));
     }
-
-    if(!bMatch)
+    else
     {
       ObjParticles* pNewObj = new  ObjParticles();
       pNewObj->obj = curr_obj_list.at(i);
@@ -152,7 +202,12 @@ void BehaviorPrediction::ExtractTrajectoriesFromMap(const std::vector<DetectedOb
     }
   }
 
-  DeleteTheRest(delete_me_list);
+  for(unsigned int ip=0; ip < old_obj_list.size(); ip++)
+  {
+    if(!bMatched.at(ip))
+      delete old_obj_list.at(ip);
+  }
+
   old_obj_list.clear();
   old_obj_list = m_temp_list_ii;
 
@@ -221,6 +276,7 @@ void BehaviorPrediction::ParticleFilterSteps(std::vector<ObjParticles*>& part_in
     RemoveWeakParticles(part_info.at(i));
     CalculateAveragesAndProbabilities(part_info.at(i));
     FindBest(part_info.at(i));
+    UpdateParticlesNum(part_info.at(i));
   }
 }
 
@@ -537,19 +593,14 @@ void BehaviorPrediction::FindBest(ObjParticles* pParts)
 
 void BehaviorPrediction::SamplesFreshParticles(ObjParticles* pParts)
 {
-  timespec _time;
-  UtilityHNS::UtilityH::GetTickCount(_time);
-  srand(_time.tv_nsec);
-
-  ENG eng(_time.tv_nsec);
   NormalDIST dist_x(0, MOTION_POSE_ERROR);
-  VariatGEN gen_x(eng, dist_x);
+  VariatGEN gen_x(m_RandomEngine, dist_x);
   NormalDIST vel(MOTION_VEL_ERROR, MOTION_VEL_ERROR);
-  VariatGEN gen_v(eng, vel);
+  VariatGEN gen_v(m_RandomEngine, vel);
   NormalDIST ang(0, MOTION_ANGLE_ERROR);
-  VariatGEN gen_a(eng, ang);
+  VariatGEN gen_a(m_RandomEngine, ang);
 //  NormalDIST acl(0, MEASURE_ACL_ERROR);
-//  VariatGEN gen_acl(eng, acl);
+//  VariatGEN gen_acl(m_RandomEngine, acl);
 
   Particle p;
   p.pose = pParts->obj.center;
@@ -577,10 +628,18 @@ void BehaviorPrediction::SamplesFreshParticles(ObjParticles* pParts)
     unsigned int point_index = 0;
     p.pose = PlanningHelpers::GetFollowPointOnTrajectory(pParts->m_TrajectoryTracker.at(t)->trajectory, info, PREDICTION_DISTANCE_PERCENTAGE*m_PredictionDistance, point_index);
 
-    if(pParts->m_TrajectoryTracker.at(t)->beh == PlannerHNS::BEH_FORWARD_STATE && pParts->m_TrajectoryTracker.at(t)->nAliveForward < BEH_PARTICLES_NUM)
+    TrajectoryTracker* pTrack = pParts->m_TrajectoryTracker.at(t);
+    if(pTrack->nTargetForward <= 0)
+      pTrack->nTargetForward = m_MaxParticlesNum;
+    if(pTrack->nTargetStop <= 0)
+      pTrack->nTargetStop = m_MaxParticlesNum;
+    pTrack->TrimParticles(pTrack->m_ForwardPart, pTrack->nAliveForward, pTrack->nTargetForward);
+    pTrack->TrimParticles(pTrack->m_StopPart, pTrack->nAliveStop, pTrack->nTargetStop);
+
+    if(pTrack->beh == PlannerHNS::BEH_FORWARD_STATE && pTrack->nAliveForward < pTrack->nTargetForward)
     {
       p.beh = PlannerHNS::BEH_FORWARD_STATE;
-      int nPs = BEH_PARTICLES_NUM - pParts->m_TrajectoryTracker.at(t)->nAliveForward;
+      int nPs = pTrack->nTargetForward - pTrack->nAliveForward;
 
       for(unsigned int i=0; i < nPs; i++)
       {
@@ -594,10 +653,10 @@ void BehaviorPrediction::SamplesFreshParticles(ObjParticles* pParts)
       }
     }
 
-    if(ENABLE_STOP_BEHAVIOR_GEN == 1 && pParts->m_TrajectoryTracker.at(t)->nAliveStop <   BEH_PARTICLES_NUM)
+    if(ENABLE_STOP_BEHAVIOR_GEN == 1 && pTrack->nAliveStop < pTrack->nTargetStop)
     {
       p.beh = PlannerHNS::BEH_STOPPING_STATE;
-      int nPs = BEH_PARTICLES_NUM - pParts->m_TrajectoryTracker.at(t)->nAliveStop;
+      int nPs = pTrack->nTargetStop - pTrack->nAliveStop;
 
       for(unsigned int i=0; i < nPs; i++)
       {
@@ -613,6 +672,68 @@ void BehaviorPrediction::SamplesFreshParticles(ObjParticles* pParts)
   }
 }
 
+void BehaviorPrediction::UpdateParticlesNum(ObjParticles* pParts)
+{
+  for(unsigned int t=0; t < pParts->m_TrajectoryTracker.size(); t++)
+  {
+    TrajectoryTracker* pTrack = pParts->m_TrajectoryTracker.at(t);
+    //fixed number of particles, or the object is ambiguous between its trajectories or behaviors
+    if(m_MinParticlesNum >= m_MaxParticlesNum || !m_bCanDecide
+        || fabs(pTrack->pForward - pTrack->pStop) < BEH_ADAPTIVE_DECISION_MARGIN)
+    {
+      pTrack->nTargetForward = m_MaxParticlesNum;
+      pTrack->nTargetStop = m_MaxParticlesNum;
+    }
+    else
+    {
+      pTrack->nTargetForward = CalcKLDParticlesNum(pTrack->m_ForwardPart);
+      pTrack->nTargetStop = CalcKLDParticlesNum(pTrack->m_StopPart);
+    }
+  }
+}
+
+int BehaviorPrediction::CalcKLDParticlesNum(const std::vector<Particle>& particles)
+{
+  //occupied bins of (x, y, a, v), few particles each so a linear search is enough
+  std::vector<int> bins;
+  int k = 0;
+  for(unsigned int i = 0; i < particles.size(); i++)
+  {
+    const Particle& p = particles.at(i);
+    int bin[4];
+    bin[0] = floor(p.pose.pos.x / BEH_KLD_POSE_BIN);
+    bin[1] = floor(p.pose.pos.y / BEH_KLD_POSE_BIN);
+    bin[2] = floor(p.pose.pos.a / BEH_KLD_ANGLE_BIN);
+    bin[3] = floor(p.vel / BEH_KLD_VEL_BIN);
+
+    bool bFound = false;
+    for(int j = 0; j < k && !bFound; j++)
+      bFound = std::equal(bin, bin + 4, bins.begin() + j*4);
+
+    if(!bFound)
+    {
+      bins.insert(bins.end(), bin, bin + 4);
+      k++;
+    }
+  }
+
+  int nMin = std::max(1, m_MinParticlesNum);
+  if(k <= 1)
+    return nMin;
+
+  //Fox's bound on the number of samples for a KL distance below epsilon with probability 1-delta
+  double a = 2.0 / (9.0 * (k - 1));
+  double c = 1.0 - a + sqrt(a) * BEH_KLD_Z;
+  int n = ceil((k - 1) / (2.0 * BEH_KLD_EPSILON) * c * c * c);
+
+  if(n < nMin)
+    n = nMin;
+  if(n > m_MaxParticlesNum)
+    n = m_MaxParticlesNum;
+
+  return n;
+}
+
 void BehaviorPrediction::CollectParticles(ObjParticles* pParts)
 {
   pParts->m_AllParticles.clear();
@@ -666,9 +787,15 @@ void BehaviorPrediction::MoveParticles(ObjParticles* pParts)
   carInfo.turning_radius = 7.2;
   carInfo.wheel_base = carInfo.length*0.75;
 
+  PlannerHNS::PlanningParams params;
+  params.maxSpeed = carInfo.max_speed_forward;
+  params.speedProfileFactor = 1.0;
+
   for(unsigned int t=0; t < pParts->m_TrajectoryTracker.size(); t++)
   {
-    PlanningHelpers::GenerateRecommendedSpeed(pParts->m_TrajectoryTracker.at(t)->trajectory, carInfo.max_speed_forward, 1.0);
+    PlanningHelpers::CalcAngleAndCostAndCurvatureAnd2D(pParts->m_TrajectoryTracker.at(t)->trajectory);
+    PlanningHelpers::GenerateSpeedProfile(pParts->m_TrajectoryTracker.at(t)->trajectory, params, carInfo);
+    pParts->m_TrajectoryTracker.at(t)->path_context.Init(pParts->m_TrajectoryTracker.at(t)->trajectory);
   }
 
 //  std::cout << "Motion Status------ " << std::endl;
@@ -686,7 +813,7 @@ void BehaviorPrediction::MoveParticles(ObjParticles* pParts)
     if(USE_OPEN_PLANNER_MOVE == 0)
       {
       p->pose.v = pParts->obj.center.v;
-      curr_part_info = decision_make.MoveStepSimple(dt, p->pose, p->pTraj->trajectory,carInfo);
+      curr_part_info = decision_make.MoveStepSimple(dt, p->pose, p->pTraj->trajectory, p->pTraj->path_context, p->path_index, carInfo);
       if(p->prev_time_diff > ACCELERATION_CALC_TIME)
       {
         p->acc_raw = (curr_part_info.vel - p->vel_prev_big)/p->prev_time_diff;
@@ -19,6 +19,7 @@ DecisionMaker::DecisionMaker()
 {
   m_iCurrentTotalPathId = 0;
   pLane = 0;
+  m_pMap = 0;
   m_pCurrentBehaviorState = 0;
   m_pGoToGoalState = 0;
   m_pStopState= 0;
@@ -72,6 +73,8 @@ void DecisionMaker::Init(const ControllerParams& ctrlParams, const PlannerHNS::P
     m_pidFollowing.Init(0.05, 0.05, 0.01);
     m_pidFollowing.Setlimit(m_params.minFollowingDistance, 0);
 
+    m_TotalPathClosePoints.clear();
+
     InitBehaviorStates();
 
     if(m_pCurrentBehaviorState)
@@ -248,7 +251,7 @@ void DecisionMaker::InitBehaviorStates()
   if(!pPathLane)
   {
     std::cout << "Performance Alert: Can't Find Lane Information in Global Path, Searching the Map :( " << std::endl;
-    pMapLane  = MappingHelpers::GetClosestLaneFromMap(state, m_Map, search_distance);
+    pMapLane  = MappingHelpers::GetClosestLaneFromMap(state, m_pMap ? *m_pMap : m_Map, search_distance);
   }
 
   if(pPathLane)
@@ -283,6 +286,7 @@ void DecisionMaker::InitBehaviorStates()
    {
      m_pCurrentBehaviorState->GetCalcParams()->bNewGlobalPath = true;
      m_TotalOriginalPath = globalPath;
+     m_TotalPathClosePoints.clear();
    }
  }
 
@@ -461,12 +465,12 @@ void DecisionMaker::InitBehaviorStates()
 {
    PlannerHNS::BehaviorState beh;
    state = currPose;
-   m_TotalPath.clear();
+   //extracted in place, the paths keep their memory from the previous step
+   m_TotalPath.resize(m_TotalOriginalPath.size());
+   m_TotalPathClosePoints.resize(m_TotalOriginalPath.size());
   for(unsigned int i = 0; i < m_TotalOriginalPath.size(); i++)
   {
-    t_centerTrajectorySmoothed.clear();
-    PlannerHNS::PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(m_TotalOriginalPath.at(i), state, m_params.horizonDistance ,  m_params.pathDensity , t_centerTrajectorySmoothed);
-    m_TotalPath.push_back(t_centerTrajectorySmoothed);
+    PlannerHNS::PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(m_TotalOriginalPath.at(i), state, m_params.horizonDistance ,  m_params.pathDensity , m_TotalPath.at(i), m_TotalPathClosePoints.at(i));
   }
 
   if(m_TotalPath.size()==0) return beh;
@@ -252,10 +252,7 @@ void LocalPlannerH::ReInitializePlanner(const WayPoint& start_pose)
 
  void LocalPlannerH::TransformPoint(const PlannerHNS::WayPoint& refPose, PlannerHNS::GPSPoint& p)
  {
-   PlannerHNS::Mat3 rotationMat(refPose.pos.a);
-   PlannerHNS::Mat3 translationMat(refPose.pos.x, refPose.pos.y);
-  p = rotationMat*p;
-  p = translationMat*p;
+   PlannerHNS::RigidTransform2D::FromFrame(refPose.pos.x, refPose.pos.y, refPose.pos.a).Apply(p.x, p.y);
  }
 
  bool LocalPlannerH::GetNextTrafficLight(const int& prevTrafficLightId, const std::vector<PlannerHNS::TrafficLight>& trafficLights, PlannerHNS::TrafficLight& trafficL)
@@ -723,9 +720,10 @@ void LocalPlannerH::ReInitializePlanner(const WayPoint& start_pose)
        m_PrevBrakingWayPoint = 0;
        PlanningHelpers::FixPathDensity(m_TotalOriginalPath.at(m_iCurrentTotalPathId), m_pCurrentBehaviorState->m_pParams->pathDensity);
        PlanningHelpers::SmoothPath(m_TotalOriginalPath.at(m_iCurrentTotalPathId), 0.49, 0.25, 0.05);
-       
-      PlanningHelpers::GenerateRecommendedSpeed(m_TotalOriginalPath.at(m_iCurrentTotalPathId), m_CarInfo.max_speed_forward, m_pCurrentBehaviorState->m_pParams->speedProfileFactor);
+       PlanningHelpers::CalcAngleAndCost(m_TotalOriginalPath.at(m_iCurrentTotalPathId));
+      //stop at the end of the path, the backward pass of the profile spreads the braking over the decel limit
       m_TotalOriginalPath.at(m_iCurrentTotalPathId).at(m_TotalOriginalPath.at(m_iCurrentTotalPathId).size()-1).v = 0;
+      PlanningHelpers::GenerateSpeedProfile(m_TotalOriginalPath.at(m_iCurrentTotalPathId), *m_pCurrentBehaviorState->m_pParams, m_CarInfo);
 
     }
 
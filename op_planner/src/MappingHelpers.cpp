@@ -2225,48 +2225,99 @@ void MappingHelpers::LinkTrafficLightsAndStopLinesConData(const std::vector<Util
   }
 }
 
-void MappingHelpers::UpdateMapWithOccupancyGrid(OccupancyToGridMap& map_info, const std::vector<int>& data, RoadNetwork& map, std::vector<WayPoint*>& updated_list)
+//map points that fall on grid cells with the value 0, MAP and POINT are const for read only maps
+template<class MAP, class POINT>
+static void GetMapPointsOnZeroCells(OccupancyToGridMap& map_info, const std::vector<int>& data, MAP& map,
+    std::vector<POINT*>& zero_points)
 {
-  PlannerHNS::Mat3 rotationMat(- map_info.center.pos.a);
-  PlannerHNS::Mat3 translationMat(-map_info.center.pos.x, -map_info.center.pos.y);
-  updated_list.clear();
+  zero_points.clear();
 
+  std::vector<POINT*> map_points;
+  std::vector<GPSPoint> positions;
   for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
   {
     for(unsigned int i =0; i < map.roadSegments.at(rs).Lanes.size(); i++)
     {
       for(unsigned int p= 0; p < map.roadSegments.at(rs).Lanes.at(i).points.size(); p++)
       {
-        WayPoint* pWP = &map.roadSegments.at(rs).Lanes.at(i).points.at(p);
+        map_points.push_back(&map.roadSegments.at(rs).Lanes.at(i).points.at(p));
+        positions.push_back(map_points.back()->pos);
+      }
+    }
+  }
 
-        GPSPoint relative_point = pWP->pos;
-        relative_point = translationMat * relative_point;
-        relative_point = rotationMat *relative_point;
+  std::vector<int> cell_values;
+  map_info.GetCellValuesFromPoints(positions, data, cell_values, -1);
 
-        int cell_value = 0;
-        if(map_info.GetCellIndexFromPoint(relative_point, data, cell_value) == true)
-        {
-          if(cell_value == 0)
-          {
-            bool bFound = false;
-            for(unsigned int i_action=0; i_action < pWP->actionCost.size(); i_action++)
-            {
-              if(pWP->actionCost.at(i_action).first == FORWARD_ACTION)
-              {
-                pWP->actionCost.at(i_action).second = 100;
-                bFound = true;
-              }
-            }
+  for(unsigned int p = 0; p < map_points.size(); p++)
+  {
+    if(cell_values.at(p) == 0)
+      zero_points.push_back(map_points.at(p));
+  }
+}
 
-            if(!bFound)
-              pWP->actionCost.push_back(make_pair(FORWARD_ACTION, 100));
+static void SetForwardActionCost(std::vector<std::pair<ACTION_TYPE, double> >& action_costs, const double& cost)
+{
+  bool bFound = false;
+  for(unsigned int i_action=0; i_action < action_costs.size(); i_action++)
+  {
+    if(action_costs.at(i_action).first == FORWARD_ACTION)
+    {
+      action_costs.at(i_action).second = cost;
+      bFound = true;
+    }
+  }
 
-            updated_list.push_back(pWP);
-          }
-        }
-      }
+  if(!bFound)
+    action_costs.push_back(make_pair(FORWARD_ACTION, cost));
+}
+
+void MappingHelpers::UpdateMapWithOccupancyGrid(OccupancyToGridMap& map_info, const std::vector<int>& data, RoadNetwork& map, std::vector<WayPoint*>& updated_list)
+{
+  GetMapPointsOnZeroCells(map_info, data, map, updated_list);
+
+  for(unsigned int p = 0; p < updated_list.size(); p++)
+    SetForwardActionCost(updated_list.at(p)->actionCost, 100);
+}
+
+std::shared_ptr<const RoadNetworkSnapshot> MappingHelpers::UpdateMapWithOccupancyGrid(OccupancyToGridMap& map_info,
+    const std::vector<int>& data, VersionedRoadNetwork& map, std::vector<int>& updated_ids)
+{
+  updated_ids.clear();
+
+  //the grid lookup only depends on the base map, it is done once
+  std::shared_ptr<const RoadNetworkSnapshot> pSnapshot = map.GetSnapshot();
+  const std::shared_ptr<const RoadNetwork> pMap = pSnapshot->pMap;
+  std::vector<const WayPoint*> map_points;
+  GetMapPointsOnZeroCells(map_info, data, *pMap, map_points);
+
+  if(map_points.size() == 0)
+    return pSnapshot;
+
+  //the costs are built from the snapshot they are published on, so changes another writer published in between
+  //are kept. When a new base map was set the points belong to the old map and nothing is published.
+  while(pSnapshot->pMap == pMap)
+  {
+    ActionCostsMap costs;
+    for(unsigned int p = 0; p < map_points.size(); p++)
+    {
+      ActionCosts action_costs = pSnapshot->GetActionCosts(*map_points.at(p));
+      SetForwardActionCost(action_costs, 100);
+      costs[map_points.at(p)->id] = action_costs;
     }
+
+    std::shared_ptr<const RoadNetworkSnapshot> pNext = map.PublishActionCosts(pSnapshot, costs);
+    if(pNext)
+    {
+      for(unsigned int p = 0; p < map_points.size(); p++)
+        updated_ids.push_back(map_points.at(p)->id);
+      return pNext;
+    }
+
+    pSnapshot = map.GetSnapshot();
   }
+
+  return pSnapshot;
 }
 
 void MappingHelpers::ConstructRoadNetworkFromROSMessageV2(const std::vector<UtilityHNS::AisanLanesFileReader::AisanLane>& lanes_data,
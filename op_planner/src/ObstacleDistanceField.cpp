@@ -0,0 +1,144 @@
+
+/// \file ObstacleDistanceField.cpp
+/// \brief Distance field over a grid around the vehicle, gives the nearest obstacle contour point of any position
+
+#include "op_planner/ObstacleDistanceField.h"
+#include <math.h>
+#include <float.h>
+
+namespace PlannerHNS
+{
+
+void ObstacleDistanceField::Build(const GPSPoint& center, const double& half_size, const double& _res,
+    const std::vector<WayPoint>& points)
+{
+  res = _res > 0 ? _res : 0.25;
+  width = ceil(2.0 * half_size / res);
+  if(width < 1)
+    width = 1;
+  originX = center.x - width * res / 2.0;
+  originY = center.y - width * res / 2.0;
+
+  const int nCells = width * width;
+  m_Nearest.assign(nCells, -1);
+  m_Points.resize(points.size());
+
+  //seed cells, one point per cell is enough for the error bound
+  std::vector<int>& seeds = m_Seeds;
+  seeds.assign(nCells, -1);
+  for(unsigned int i = 0; i < points.size(); i++)
+  {
+    m_Points.at(i) = points.at(i).pos;
+    double fc = (points.at(i).pos.x - originX) / res;
+    double fr = (points.at(i).pos.y - originY) / res;
+    if(!(fc >= 0 && fc < width && fr >= 0 && fr < width))
+      continue;
+    int cell = (int)fr * width + (int)fc;
+    if(seeds[cell] < 0)
+      seeds[cell] = i;
+  }
+
+  //columns, squared distance in cells to the nearest seed above or below, and the point of that seed
+  const double inf = DBL_MAX;
+  m_ColumnDist.assign(nCells, inf);
+  m_ColumnNearest.assign(nCells, -1);
+  for(int c = 0; c < width; c++)
+  {
+    int last = -1;
+    for(int r = 0; r < width; r++)
+    {
+      if(seeds[r * width + c] >= 0)
+        last = r;
+      if(last >= 0)
+      {
+        m_ColumnDist[r * width + c] = (double)(r - last) * (r - last);
+        m_ColumnNearest[r * width + c] = seeds[last * width + c];
+      }
+    }
+
+    last = -1;
+    for(int r = width - 1; r >= 0; r--)
+    {
+      if(seeds[r * width + c] >= 0)
+        last = r;
+      if(last >= 0)
+      {
+        double d = (double)(last - r) * (last - r);
+        if(d < m_ColumnDist[r * width + c])
+        {
+          m_ColumnDist[r * width + c] = d;
+          m_ColumnNearest[r * width + c] = seeds[last * width + c];
+        }
+      }
+    }
+  }
+
+  //rows, lower envelope of the column parabolas (Felzenszwalb and Huttenlocher)
+  m_Envelope.resize(width + 1);
+  m_EnvelopeCells.resize(width);
+  for(int r = 0; r < width; r++)
+  {
+    const double* f = &m_ColumnDist[r * width];
+    int k = -1;
+    for(int q = 0; q < width; q++)
+    {
+      if(f[q] == inf)
+        continue;
+
+      if(k < 0)
+      {
+        k = 0;
+        m_EnvelopeCells[0] = q;
+        m_Envelope[0] = -inf;
+        m_Envelope[1] = inf;
+        continue;
+      }
+
+      double s = 0;
+      while(true)
+      {
+        int v = m_EnvelopeCells[k];
+        s = ((f[q] + (double)q * q) - (f[v] + (double)v * v)) / (2.0 * (q - v));
+        if(s > m_Envelope[k])
+          break;
+        k--;
+      }
+      k++;
+      m_EnvelopeCells[k] = q;
+      m_Envelope[k] = s;
+      m_Envelope[k + 1] = inf;
+    }
+
+    if(k < 0)
+      continue;
+
+    k = 0;
+    for(int q = 0; q < width; q++)
+    {
+      while(m_Envelope[k + 1] < q)
+        k++;
+      m_Nearest[r * width + q] = m_ColumnNearest[r * width + m_EnvelopeCells[k]];
+    }
+  }
+}
+
+double ObstacleDistanceField::GetClearance(const double& x, const double& y, int& point_index) const
+{
+  point_index = -1;
+  if(width <= 0)
+    return DBL_MAX;
+
+  double fc = (x - originX) / res;
+  double fr = (y - originY) / res;
+  if(!(fc >= 0 && fc < width && fr >= 0 && fr < width))
+    return DBL_MAX;
+
+  point_index = m_Nearest[(int)fr * width + (int)fc];
+  if(point_index < 0)
+    return DBL_MAX;
+
+  const GPSPoint& p = m_Points[point_index];
+  return hypot(p.y - y, p.x - x);
+}
+
+} /* namespace PlannerHNS */
@@ -0,0 +1,190 @@
+
+/// \file OccupancyToGridMap.cpp
+/// \brief Batch point queries and dilation for OccupancyToGridMap
+
+#include "op_planner/RoadNetwork.h"
+#include <math.h>
+#include <algorithm>
+
+namespace PlannerHNS
+{
+
+//below this number of points (or cells per row/column) the thread start up costs more than it saves
+#define OCCUPANCY_PARALLEL_MIN_ITEMS 2048
+
+//Same cell as GetCellIndexFromPoint. Its neighbour scan only finds a cell for points that are at most
+//one cell outside the grid, and the first cell it finds is the clamped one.
+static inline int GetClampedCellIndex(const double& x, const double& y, const double& res, const int& width,
+    const int& length)
+{
+  const double fc = x / res;
+  const double fr = y / res;
+  //also keeps the int conversions below in range
+  if(!(fr >= -1 && fr < length + 1 && fc >= -1 && fc < width + 1))
+    return -1;
+
+  //floor without the libm call, the values are small here
+  int col = (int)fc;
+  int row = (int)fr;
+  if(fc < col) col--;
+  if(fr < row) row--;
+
+  if(row < 0) row = 0;
+  if(row >= length) row = length - 1;
+  if(col < 0) col = 0;
+  if(col >= width) col = width - 1;
+  if(row < 0 || col < 0)
+    return -1;
+
+  return row * width + col;
+}
+
+static inline const GPSPoint& GetPos(const GPSPoint& p)
+{
+  return p;
+}
+
+static inline const GPSPoint& GetPos(const WayPoint& p)
+{
+  return p.pos;
+}
+
+template <class T>
+static void CellIndicesFromPoints(const OccupancyToGridMap& grid, const std::vector<T>& points, const int& data_size,
+    std::vector<int>& indices)
+{
+  indices.resize(points.size());
+
+  //translation then rotation by the negative center heading, in one step
+  const double c = cos(grid.center.pos.a);
+  const double s = sin(grid.center.pos.a);
+  const double cx = grid.center.pos.x;
+  const double cy = grid.center.pos.y;
+  const int n = points.size();
+
+  if(data_size < grid.width * grid.length)
+  {
+    //short data, keep the exact neighbour search of GetCellIndexFromPoint
+    OccupancyToGridMap g = grid;
+    std::vector<int> cells(data_size);
+    for(int i = 0; i < data_size; i++)
+      cells.at(i) = i;
+
+    for(int i = 0; i < n; i++)
+    {
+      const GPSPoint& p = GetPos(points.at(i));
+      GPSPoint rel;
+      rel.x = c * (p.x - cx) + s * (p.y - cy);
+      rel.y = -s * (p.x - cx) + c * (p.y - cy);
+      int cell = -1;
+      if(!g.GetCellIndexFromPoint(rel, cells, cell))
+        cell = -1;
+      indices.at(i) = cell;
+    }
+    return;
+  }
+
+  #pragma omp parallel for if(n > OCCUPANCY_PARALLEL_MIN_ITEMS)
+  for(int i = 0; i < n; i++)
+  {
+    const GPSPoint& p = GetPos(points.at(i));
+    const double dx = p.x - cx;
+    const double dy = p.y - cy;
+    indices[i] = GetClampedCellIndex(c * dx + s * dy, -s * dx + c * dy, grid.res, grid.width, grid.length);
+  }
+}
+
+template <class T>
+static void CellValuesFromPoints(const OccupancyToGridMap& grid, const std::vector<T>& points, const std::vector<int>& data,
+    std::vector<int>& values, const int& out_value)
+{
+  CellIndicesFromPoints(grid, points, data.size(), values);
+  const int n = values.size();
+  for(int i = 0; i < n; i++)
+    values[i] = values[i] < 0 ? out_value : data[values[i]];
+}
+
+void OccupancyToGridMap::GetCellIndicesFromPoints(const std::vector<GPSPoint>& points, const int& data_size,
+    std::vector<int>& indices) const
+{
+  CellIndicesFromPoints(*this, points, data_size, indices);
+}
+
+void OccupancyToGridMap::GetCellIndicesFromPoints(const std::vector<WayPoint>& points, const int& data_size,
+    std::vector<int>& indices) const
+{
+  CellIndicesFromPoints(*this, points, data_size, indices);
+}
+
+void OccupancyToGridMap::GetCellValuesFromPoints(const std::vector<GPSPoint>& points, const std::vector<int>& data,
+    std::vector<int>& values, const int& out_value) const
+{
+  CellValuesFromPoints(*this, points, data, values, out_value);
+}
+
+void OccupancyToGridMap::GetCellValuesFromPoints(const std::vector<WayPoint>& points, const std::vector<int>& data,
+    std::vector<int>& values, const int& out_value) const
+{
+  CellValuesFromPoints(*this, points, data, values, out_value);
+}
+
+void OccupancyToGridMap::DilateCells(const std::vector<int>& data, const int& value, const int& radius,
+    std::vector<int>& dilated) const
+{
+  dilated = data;
+  const int nCells = width * length;
+  if(radius <= 0 || width <= 0 || length <= 0 || (int)data.size() < nCells)
+    return;
+
+  //separable square dilation, a running count of matching cells in the window of each row then each column
+  std::vector<unsigned char> rows_mask(nCells, 0);
+
+  #pragma omp parallel for if(nCells > OCCUPANCY_PARALLEL_MIN_ITEMS * 16)
+  for(int r = 0; r < length; r++)
+  {
+    const int* row = &data[r * width];
+    unsigned char* out = &rows_mask[r * width];
+    int count = 0;
+    for(int c = 0; c < radius && c < width; c++)
+      count += row[c] == value;
+    for(int c = 0; c < width; c++)
+    {
+      if(c + radius < width)
+        count += row[c + radius] == value;
+      if(c - radius - 1 >= 0)
+        count -= row[c - radius - 1] == value;
+      out[c] = count > 0;
+    }
+  }
+
+  //columns pass row by row with one running count per column, in blocks of columns for the threads
+  const int block = 256;
+  const int nBlocks = (width + block - 1) / block;
+  #pragma omp parallel for if(nCells > OCCUPANCY_PARALLEL_MIN_ITEMS * 16)
+  for(int b = 0; b < nBlocks; b++)
+  {
+    const int c0 = b * block;
+    const int c1 = std::min(width, c0 + block);
+    std::vector<int> counts(c1 - c0, 0);
+    for(int r = 0; r < radius && r < length; r++)
+      for(int c = c0; c < c1; c++)
+        counts[c - c0] += rows_mask[r * width + c];
+
+    for(int r = 0; r < length; r++)
+    {
+      if(r + radius < length)
+        for(int c = c0; c < c1; c++)
+          counts[c - c0] += rows_mask[(r + radius) * width + c];
+      if(r - radius - 1 >= 0)
+        for(int c = c0; c < c1; c++)
+          counts[c - c0] -= rows_mask[(r - radius - 1) * width + c];
+      for(int c = c0; c < c1; c++)
+      {
+        if(counts[c - c0] > 0)
+          dilated[r * width + c] = value;
+      }
+    }
+  }
+}
+
+} /* namespace PlannerHNS */
@@ -14,6 +14,115 @@
 namespace PlannerHNS
 {
 
+void PassivePathContext::Init(const std::vector<WayPoint>& path)
+{
+  arc_length.assign(path.size(), 0);
+  for(unsigned int i=1; i < path.size(); i++)
+    arc_length.at(i) = arc_length.at(i-1) + hypot(path.at(i).pos.y - path.at(i-1).pos.y, path.at(i).pos.x - path.at(i-1).pos.x);
+
+  stop_lines.clear();
+  next_stop_line.assign(path.size(), 0);
+  for(unsigned int i=0; i < path.size(); i++)
+  {
+    next_stop_line.at(i) = stop_lines.size();
+    if(path.at(i).stopLineID > 0 && path.at(i).pLane)
+    {
+      for(unsigned int j = 0; j < path.at(i).pLane->stopLines.size(); j++)
+      {
+        const StopLine& stop_line = path.at(i).pLane->stopLines.at(j);
+        if(stop_line.id == path.at(i).stopLineID)
+        {
+          StopLineEvent event;
+          event.stopLineID = stop_line.id;
+          event.stopSignID = stop_line.stopSignID;
+          event.trafficLightID = stop_line.trafficLightID;
+          WayPoint stopLineWP;
+          stopLineWP.pos = stop_line.points.at(0);
+          PlanningHelpers::GetRelativeInfo(path, stopLineWP, event.info);
+          stop_lines.push_back(event);
+        }
+      }
+    }
+  }
+
+  //the indicator search of GetIndicatorsFromPath never looks at the last two waypoints
+  next_turn.assign(path.size(), -1);
+  for(int i = (int)path.size()-3; i >= 0; i--)
+  {
+    if(path.at(i).actionCost.size() > 0 &&
+        (path.at(i).actionCost.at(0).first == LEFT_TURN_ACTION || path.at(i).actionCost.at(0).first == RIGHT_TURN_ACTION))
+      next_turn.at(i) = i;
+    else
+      next_turn.at(i) = next_turn.at(i+1);
+  }
+
+  start_info = RelativeInfo();
+  if(path.size() > 0)
+    PlanningHelpers::GetRelativeInfo(path, path.at(0), start_info);
+}
+
+double PassivePathContext::GetExactDistance(const RelativeInfo& p1, const RelativeInfo& p2) const
+{
+  //same as PlanningHelpers::GetExactDistanceOnTrajectory with the segment sums taken from arc_length
+  if(arc_length.size() == 0) return 0;
+
+  if(p2.iFront == p1.iFront && p2.iBack == p1.iBack)
+    return p2.to_front_distance - p1.to_front_distance;
+  else if(p2.iBack >= p1.iFront)
+    return p1.to_front_distance + p2.from_back_distance + arc_length.at(p2.iBack) - arc_length.at(p1.iFront);
+  else if(p2.iFront <= p1.iBack)
+    return -(p1.from_back_distance + p2.to_front_distance + arc_length.at(p1.iBack) - arc_length.at(p2.iFront));
+  else
+    return 0;
+}
+
+double PassivePathContext::GetDistanceToClosestStopLine(const RelativeInfo& info, const double& giveUpDistance, int& stopLineID, int& stopSignID, int& trafficLightID) const
+{
+  trafficLightID = stopSignID = stopLineID = -1;
+
+  if(info.iBack < 0 || info.iBack >= (int)next_stop_line.size()) return -1;
+
+  for(unsigned int i = next_stop_line.at(info.iBack); i < stop_lines.size(); i++)
+  {
+    stopLineID = stop_lines.at(i).stopLineID;
+    double localDistance = GetExactDistance(info, stop_lines.at(i).info);
+    if(localDistance > giveUpDistance)
+    {
+      stopSignID = stop_lines.at(i).stopSignID;
+      trafficLightID = stop_lines.at(i).trafficLightID;
+      return localDistance;
+    }
+  }
+
+  return -1;
+}
+
+LIGHT_INDICATOR PassivePathContext::GetIndicator(const std::vector<WayPoint>& path, const RelativeInfo& info, const double& searchDistance) const
+{
+  //same result as PlanningHelpers::GetIndicatorsFromPath for the pose that info was computed from
+  if(path.size() < 2 || info.iFront < 0 || info.iFront >= (int)next_turn.size())
+    return INDICATOR_NONE;
+
+  int iTurn = next_turn.at(info.iFront);
+  if(iTurn >= 0 && (iTurn == info.iFront || arc_length.at(iTurn) - arc_length.at(info.iFront) <= searchDistance))
+  {
+    if(path.at(iTurn).actionCost.at(0).first == LEFT_TURN_ACTION)
+      return INDICATOR_LEFT;
+    else
+      return INDICATOR_RIGHT;
+  }
+
+  if(info.perp_point.actionCost.size() > 0)
+  {
+    if(info.perp_point.actionCost.at(0).first == LEFT_TURN_ACTION)
+      return INDICATOR_LEFT;
+    else if(info.perp_point.actionCost.at(0).first == RIGHT_TURN_ACTION)
+      return INDICATOR_RIGHT;
+  }
+
+  return INDICATOR_NONE;
+}
+
 PassiveDecisionMaker::PassiveDecisionMaker()
 {
 }
@@ -78,6 +187,24 @@ PassiveDecisionMaker::~PassiveDecisionMaker()
   return false;
  }
 
+ bool PassiveDecisionMaker::CheckForStopLine(PlannerHNS::WayPoint& currPose, const PassivePathContext& context, const RelativeInfo& info, const CAR_BASIC_INFO& carInfo)
+ {
+   double minStoppingDistance = -pow(currPose.v, 2)/(carInfo.max_deceleration);
+   double critical_long_front_distance =  carInfo.wheel_base/2.0 + carInfo.length/2.0;
+
+  int stopLineID = -1;
+  int stopSignID = -1;
+  int trafficLightID = -1;
+  double distanceToClosestStopLine = context.GetDistanceToClosestStopLine(info, 0, stopLineID, stopSignID, trafficLightID) - critical_long_front_distance;
+
+  if(distanceToClosestStopLine > -2 && distanceToClosestStopLine < minStoppingDistance)
+  {
+    return true;
+  }
+
+  return false;
+ }
+
  PlannerHNS::BehaviorState PassiveDecisionMaker::MoveStep(const double& dt, PlannerHNS::WayPoint& currPose, const std::vector<WayPoint>& path, const CAR_BASIC_INFO& carInfo)
  {
    PlannerHNS::BehaviorState beh;
@@ -112,14 +239,27 @@ PassiveDecisionMaker::~PassiveDecisionMaker()
  }
 
  PlannerHNS::ParticleInfo PassiveDecisionMaker::MoveStepSimple(const double& dt, PlannerHNS::WayPoint& currPose, const std::vector<WayPoint>& path, const CAR_BASIC_INFO& carInfo)
+  {
+    PassivePathContext context;
+    context.Init(path);
+    int pathIndex = -1;
+    return MoveStepSimple(dt, currPose, path, context, pathIndex, carInfo);
+  }
+
+ PlannerHNS::ParticleInfo PassiveDecisionMaker::MoveStepSimple(const double& dt, PlannerHNS::WayPoint& currPose, const std::vector<WayPoint>& path, const PassivePathContext& context, int& pathIndex, const CAR_BASIC_INFO& carInfo)
   {
     PlannerHNS::ParticleInfo beh;
     if(path.size() == 0) return beh;
 
+    if(pathIndex < 0 || pathIndex >= (int)path.size())
+      pathIndex = PlanningHelpers::GetClosestNextPointIndexFast(path, currPose);
+    else
+      pathIndex = PlanningHelpers::GetClosestNextPointIndexLocal(path, currPose, pathIndex);
+
     RelativeInfo info;
-    PlanningHelpers::GetRelativeInfo(path, currPose, info);
+    PlanningHelpers::GetRelativeInfoFromIndex(path, currPose, pathIndex, info);
 
-    bool bStopLine = CheckForStopLine(currPose, path, carInfo);
+    bool bStopLine = CheckForStopLine(currPose, context, info, carInfo);
     if(bStopLine)
       beh.state = PlannerHNS::STOPPING_STATE;
     else
@@ -127,12 +267,8 @@ PassiveDecisionMaker::~PassiveDecisionMaker()
 
     double average_braking_distance = -pow(currPose.v, 2)/(carInfo.max_deceleration) + 15.0;
 
+   beh.indicator = context.GetIndicator(path, context.start_info, average_braking_distance);
 
-   PlannerHNS::WayPoint startPose = path.at(0);
-   beh.indicator = PlanningHelpers::GetIndicatorsFromPath(path, startPose, average_braking_distance);
-
-
-   double speed = 0;
    if(info.iFront < path.size())
    {
      beh.vel = path.at(info.iFront).v;
@@ -0,0 +1,688 @@
+
+/// \file PlannerCycleRecorder.cpp
+/// \brief Record the inputs and outputs of local planner cycles to a binary file and read them back for offline replay
+
+#include "op_planner/PlannerCycleRecorder.h"
+
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <stdint.h>
+#include <type_traits>
+
+namespace PlannerHNS
+{
+
+namespace
+{
+
+const char PLANNER_CYCLE_FILE_MAGIC[4] = {'O', 'P', 'P', 'C'};
+
+//Files store the parameter classes as raw bytes, their sizes are part of the header
+//so that a file written by a different build is rejected instead of misread.
+struct FileHeader
+{
+  char magic[4];
+  uint32_t version;
+  uint32_t planningParamsSize;
+  uint32_t carInfoSize;
+  uint32_t ctrlParamsSize;
+  uint32_t predictionParamsSize;
+};
+
+FileHeader CreateHeader()
+{
+  FileHeader header;
+  memcpy(header.magic, PLANNER_CYCLE_FILE_MAGIC, sizeof(header.magic));
+  header.version = PLANNER_CYCLE_FILE_VERSION;
+  header.planningParamsSize = sizeof(PlanningParams);
+  header.carInfoSize = sizeof(CAR_BASIC_INFO);
+  header.ctrlParamsSize = sizeof(ControllerParams);
+  header.predictionParamsSize = sizeof(PredictionParams);
+  return header;
+}
+
+class CycleWriter
+{
+public:
+  std::string& buffer;
+  std::map<const Lane*, int> laneIndex;
+
+  explicit CycleWriter(std::string& _buffer) : buffer(_buffer)
+  {
+  }
+
+  template <typename T>
+  void WriteRaw(const T& value)
+  {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void WriteInt(const int& value) { WriteRaw(static_cast<int32_t>(value)); }
+  void WriteDouble(const double& value) { WriteRaw(value); }
+  void WriteBool(const bool& value) { WriteRaw(static_cast<uint8_t>(value)); }
+  void WriteSize(const size_t& value) { WriteRaw(static_cast<uint32_t>(value)); }
+
+  void WriteString(const std::string& value)
+  {
+    WriteSize(value.size());
+    buffer.append(value);
+  }
+
+  void WriteIntVector(const std::vector<int>& values)
+  {
+    WriteSize(values.size());
+    for(unsigned int i = 0; i < values.size(); i++)
+      WriteInt(values.at(i));
+  }
+
+  void WritePoint(const GPSPoint& p)
+  {
+    WriteDouble(p.x);
+    WriteDouble(p.y);
+    WriteDouble(p.z);
+    WriteDouble(p.a);
+  }
+
+  void WritePoints(const std::vector<GPSPoint>& points)
+  {
+    WriteSize(points.size());
+    for(unsigned int i = 0; i < points.size(); i++)
+      WritePoint(points.at(i));
+  }
+
+  void CollectLanes(const std::vector<WayPoint>& path)
+  {
+    for(unsigned int i = 0; i < path.size(); i++)
+    {
+      if(path.at(i).pLane && laneIndex.find(path.at(i).pLane) == laneIndex.end())
+      {
+        int index = laneIndex.size();
+        laneIndex[path.at(i).pLane] = index;
+      }
+    }
+  }
+
+  void WriteLanes()
+  {
+    std::vector<const Lane*> lanes(laneIndex.size());
+    for(std::map<const Lane*, int>::iterator it = laneIndex.begin(); it != laneIndex.end(); it++)
+      lanes.at(it->second) = it->first;
+
+    WriteSize(lanes.size());
+    for(unsigned int i = 0; i < lanes.size(); i++)
+    {
+      const Lane* pLane = lanes.at(i);
+      WriteInt(pLane->id);
+      WriteInt(pLane->roadId);
+      WriteInt(pLane->num);
+      WriteDouble(pLane->speed);
+      WriteDouble(pLane->width);
+      WriteInt(pLane->type);
+      WriteSize(pLane->stopLines.size());
+      for(unsigned int j = 0; j < pLane->stopLines.size(); j++)
+      {
+        const StopLine& stop_line = pLane->stopLines.at(j);
+        WriteInt(stop_line.id);
+        WriteInt(stop_line.laneId);
+        WriteInt(stop_line.roadId);
+        WriteInt(stop_line.trafficLightID);
+        WriteInt(stop_line.stopSignID);
+        WriteInt(stop_line.linkID);
+        WritePoints(stop_line.points);
+      }
+    }
+  }
+
+  void WriteWayPoint(const WayPoint& wp)
+  {
+    WritePoint(wp.pos);
+    WriteDouble(wp.v);
+    WriteDouble(wp.cost);
+    WriteDouble(wp.timeCost);
+    WriteDouble(wp.collisionCost);
+    WriteDouble(wp.laneChangeCost);
+    WriteInt(wp.laneId);
+    WriteInt(wp.id);
+    WriteInt(wp.LeftPointId);
+    WriteInt(wp.RightPointId);
+    WriteInt(wp.LeftLnId);
+    WriteInt(wp.RightLnId);
+    WriteInt(wp.stopLineID);
+    WriteInt(wp.bDir);
+    WriteInt(wp.state);
+    WriteInt(wp.beh_state);
+    WriteInt(wp.iOriginalIndex);
+    WriteInt(wp.originalMapID);
+    WriteInt(wp.gid);
+    WriteSize(wp.actionCost.size());
+    for(unsigned int i = 0; i < wp.actionCost.size(); i++)
+    {
+      WriteInt(wp.actionCost.at(i).first);
+      WriteDouble(wp.actionCost.at(i).second);
+    }
+
+    std::map<const Lane*, int>::const_iterator it = laneIndex.find(wp.pLane);
+    WriteInt(it == laneIndex.end() ? -1 : it->second);
+  }
+
+  void WritePath(const std::vector<WayPoint>& path)
+  {
+    WriteSize(path.size());
+    for(unsigned int i = 0; i < path.size(); i++)
+      WriteWayPoint(path.at(i));
+  }
+
+  void WritePaths(const std::vector<std::vector<WayPoint> >& paths)
+  {
+    WriteSize(paths.size());
+    for(unsigned int i = 0; i < paths.size(); i++)
+      WritePath(paths.at(i));
+  }
+
+  void WriteObject(const DetectedObject& obj)
+  {
+    WriteInt(obj.id);
+    WriteString(obj.label);
+    WriteInt(obj.t);
+    WriteWayPoint(obj.center);
+    WriteWayPoint(obj.predicted_center);
+    WriteInt(obj.predicted_behavior);
+    WritePath(obj.centers_list);
+    WritePoints(obj.contour);
+    WritePaths(obj.predTrajectories);
+    WriteDouble(obj.w);
+    WriteDouble(obj.l);
+    WriteDouble(obj.h);
+    WriteDouble(obj.distance_to_center);
+    WriteDouble(obj.actual_speed);
+    WriteDouble(obj.actual_yaw);
+    WriteBool(obj.bDirection);
+    WriteBool(obj.bVelocity);
+    WriteInt(obj.acceleration);
+    WriteInt(obj.acceleration_desc);
+    WriteDouble(obj.acceleration_raw);
+    WriteInt(obj.indicator_state);
+    WriteInt(obj.originalID);
+    WriteInt(obj.behavior_state);
+  }
+
+  void WriteObjects(const std::vector<DetectedObject>& objects)
+  {
+    WriteSize(objects.size());
+    for(unsigned int i = 0; i < objects.size(); i++)
+      WriteObject(objects.at(i));
+  }
+
+  void WriteTrafficLight(const TrafficLight& light)
+  {
+    WriteInt(light.id);
+    WritePoint(light.pos);
+    WriteInt(light.lightState);
+    WriteDouble(light.stoppingDistance);
+    WriteIntVector(light.laneIds);
+    WriteInt(light.linkID);
+  }
+
+  void WriteTrajectoryCost(const TrajectoryCost& tc)
+  {
+    WriteInt(tc.index);
+    WriteInt(tc.relative_index);
+    WriteDouble(tc.closest_obj_velocity);
+    WriteDouble(tc.distance_from_center);
+    WriteDouble(tc.priority_cost);
+    WriteDouble(tc.transition_cost);
+    WriteDouble(tc.closest_obj_cost);
+    WriteDouble(tc.cost);
+    WriteDouble(tc.closest_obj_distance);
+    WriteInt(tc.lane_index);
+    WriteDouble(tc.lane_change_cost);
+    WriteDouble(tc.lateral_cost);
+    WriteDouble(tc.longitudinal_cost);
+    WriteBool(tc.bBlocked);
+    WriteSize(tc.lateral_costs.size());
+    for(unsigned int i = 0; i < tc.lateral_costs.size(); i++)
+    {
+      WriteInt(tc.lateral_costs.at(i).first);
+      WriteDouble(tc.lateral_costs.at(i).second);
+    }
+  }
+
+  void WriteBehavior(const BehaviorState& beh)
+  {
+    WriteInt(beh.state);
+    WriteDouble(beh.maxVelocity);
+    WriteDouble(beh.minVelocity);
+    WriteDouble(beh.stopDistance);
+    WriteDouble(beh.followVelocity);
+    WriteDouble(beh.followDistance);
+    WriteInt(beh.indicator);
+    WriteBool(beh.bNewPlan);
+    WriteInt(beh.iTrajectory);
+  }
+};
+
+class CycleReader
+{
+public:
+  const std::string& buffer;
+  size_t offset;
+  bool bValid;
+  std::vector<Lane>* pLanes;
+
+  explicit CycleReader(const std::string& _buffer) : buffer(_buffer), offset(0), bValid(true), pLanes(0)
+  {
+  }
+
+  template <typename T>
+  T ReadRaw()
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable types are read as raw bytes");
+    T value = T();
+    if(!bValid || offset + sizeof(T) > buffer.size())
+    {
+      bValid = false;
+      return value;
+    }
+    memcpy(&value, buffer.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return value;
+  }
+
+  int ReadInt() { return ReadRaw<int32_t>(); }
+  double ReadDouble() { return ReadRaw<double>(); }
+  bool ReadBool() { return ReadRaw<uint8_t>() != 0; }
+
+  //sizes can never exceed the bytes left, this keeps a corrupted file from allocating huge vectors
+  size_t ReadSize()
+  {
+    size_t size = ReadRaw<uint32_t>();
+    if(size > buffer.size() - offset)
+    {
+      bValid = false;
+      return 0;
+    }
+    return size;
+  }
+
+  void ReadString(std::string& value)
+  {
+    size_t size = ReadSize();
+    value.assign(buffer, offset, size);
+    offset += size;
+  }
+
+  void ReadIntVector(std::vector<int>& values)
+  {
+    values.resize(ReadSize());
+    for(unsigned int i = 0; i < values.size(); i++)
+      values.at(i) = ReadInt();
+  }
+
+  void ReadPoint(GPSPoint& p)
+  {
+    p.x = ReadDouble();
+    p.y = ReadDouble();
+    p.z = ReadDouble();
+    p.a = ReadDouble();
+  }
+
+  void ReadPoints(std::vector<GPSPoint>& points)
+  {
+    points.resize(ReadSize());
+    for(unsigned int i = 0; i < points.size(); i++)
+      ReadPoint(points.at(i));
+  }
+
+  void ReadLanes(std::vector<Lane>& lanes)
+  {
+    lanes.resize(ReadSize());
+    for(unsigned int i = 0; i < lanes.size(); i++)
+    {
+      Lane& lane = lanes.at(i);
+      lane.id = ReadInt();
+      lane.roadId = ReadInt();
+      lane.num = ReadInt();
+      lane.speed = ReadDouble();
+      lane.width = ReadDouble();
+      lane.type = (LaneType)ReadInt();
+      lane.stopLines.resize(ReadSize());
+      for(unsigned int j = 0; j < lane.stopLines.size(); j++)
+      {
+        StopLine& stop_line = lane.stopLines.at(j);
+        stop_line.id = ReadInt();
+        stop_line.laneId = ReadInt();
+        stop_line.roadId = ReadInt();
+        stop_line.trafficLightID = ReadInt();
+        stop_line.stopSignID = ReadInt();
+        stop_line.linkID = ReadInt();
+        ReadPoints(stop_line.points);
+        stop_line.pLane = &lane;
+      }
+    }
+    pLanes = &lanes;
+  }
+
+  void ReadWayPoint(WayPoint& wp)
+  {
+    ReadPoint(wp.pos);
+    wp.v = ReadDouble();
+    wp.cost = ReadDouble();
+    wp.timeCost = ReadDouble();
+    wp.collisionCost = ReadDouble();
+    wp.laneChangeCost = ReadDouble();
+    wp.laneId = ReadInt();
+    wp.id = ReadInt();
+    wp.LeftPointId = ReadInt();
+    wp.RightPointId = ReadInt();
+    wp.LeftLnId = ReadInt();
+    wp.RightLnId = ReadInt();
+    wp.stopLineID = ReadInt();
+    wp.bDir = (DIRECTION_TYPE)ReadInt();
+    wp.state = (STATE_TYPE)ReadInt();
+    wp.beh_state = (BEH_STATE_TYPE)ReadInt();
+    wp.iOriginalIndex = ReadInt();
+    wp.originalMapID = ReadInt();
+    wp.gid = ReadInt();
+    wp.actionCost.resize(ReadSize());
+    for(unsigned int i = 0; i < wp.actionCost.size(); i++)
+    {
+      wp.actionCost.at(i).first = (ACTION_TYPE)ReadInt();
+      wp.actionCost.at(i).second = ReadDouble();
+    }
+
+    int lane_index = ReadInt();
+    wp.pLane = 0;
+    if(pLanes && lane_index >= 0 && lane_index < (int)pLanes->size())
+      wp.pLane = &pLanes->at(lane_index);
+  }
+
+  void ReadPath(std::vector<WayPoint>& path)
+  {
+    path.resize(ReadSize());
+    for(unsigned int i = 0; i < path.size(); i++)
+      ReadWayPoint(path.at(i));
+  }
+
+  void ReadPaths(std::vector<std::vector<WayPoint> >& paths)
+  {
+    paths.resize(ReadSize());
+    for(unsigned int i = 0; i < paths.size(); i++)
+      ReadPath(paths.at(i));
+  }
+
+  void ReadObject(DetectedObject& obj)
+  {
+    obj.id = ReadInt();
+    ReadString(obj.label);
+    obj.t = (OBSTACLE_TYPE)ReadInt();
+    ReadWayPoint(obj.center);
+    ReadWayPoint(obj.predicted_center);
+    obj.predicted_behavior = (STATE_TYPE)ReadInt();
+    ReadPath(obj.centers_list);
+    ReadPoints(obj.contour);
+    ReadPaths(obj.predTrajectories);
+    obj.w = ReadDouble();
+    obj.l = ReadDouble();
+    obj.h = ReadDouble();
+    obj.distance_to_center = ReadDouble();
+    obj.actual_speed = ReadDouble();
+    obj.actual_yaw = ReadDouble();
+    obj.bDirection = ReadBool();
+    obj.bVelocity = ReadBool();
+    obj.acceleration = ReadInt();
+    obj.acceleration_desc = ReadInt();
+    obj.acceleration_raw = ReadDouble();
+    obj.indicator_state = (LIGHT_INDICATOR)ReadInt();
+    obj.originalID = ReadInt();
+    obj.behavior_state = (BEH_STATE_TYPE)ReadInt();
+  }
+
+  void ReadObjects(std::vector<DetectedObject>& objects)
+  {
+    objects.resize(ReadSize());
+    for(unsigned int i = 0; i < objects.size(); i++)
+      ReadObject(objects.at(i));
+  }
+
+  void ReadTrafficLight(TrafficLight& light)
+  {
+    light.id = ReadInt();
+    ReadPoint(light.pos);
+    light.lightState = (TrafficLightState)ReadInt();
+    light.stoppingDistance = ReadDouble();
+    ReadIntVector(light.laneIds);
+    light.linkID = ReadInt();
+  }
+
+  void ReadTrajectoryCost(TrajectoryCost& tc)
+  {
+    tc.index = ReadInt();
+    tc.relative_index = ReadInt();
+    tc.closest_obj_velocity = ReadDouble();
+    tc.distance_from_center = ReadDouble();
+    tc.priority_cost = ReadDouble();
+    tc.transition_cost = ReadDouble();
+    tc.closest_obj_cost = ReadDouble();
+    tc.cost = ReadDouble();
+    tc.closest_obj_distance = ReadDouble();
+    tc.lane_index = ReadInt();
+    tc.lane_change_cost = ReadDouble();
+    tc.lateral_cost = ReadDouble();
+    tc.longitudinal_cost = ReadDouble();
+    tc.bBlocked = ReadBool();
+    tc.lateral_costs.resize(ReadSize());
+    for(unsigned int i = 0; i < tc.lateral_costs.size(); i++)
+    {
+      tc.lateral_costs.at(i).first = ReadInt();
+      tc.lateral_costs.at(i).second = ReadDouble();
+    }
+  }
+
+  void ReadBehavior(BehaviorState& beh)
+  {
+    beh.state = (STATE_TYPE)ReadInt();
+    beh.maxVelocity = ReadDouble();
+    beh.minVelocity = ReadDouble();
+    beh.stopDistance = ReadDouble();
+    beh.followVelocity = ReadDouble();
+    beh.followDistance = ReadDouble();
+    beh.indicator = (LIGHT_INDICATOR)ReadInt();
+    beh.bNewPlan = ReadBool();
+    beh.iTrajectory = ReadInt();
+  }
+};
+
+}  // namespace
+
+PlannerCycleRecorder::PlannerCycleRecorder()
+{
+}
+
+PlannerCycleRecorder::~PlannerCycleRecorder()
+{
+  Close();
+}
+
+bool PlannerCycleRecorder::Open(const std::string& fileName)
+{
+  Close();
+  m_File.open(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if(!m_File.is_open())
+    return false;
+
+  FileHeader header = CreateHeader();
+  m_File.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  return m_File.good();
+}
+
+void PlannerCycleRecorder::Close()
+{
+  if(m_File.is_open())
+    m_File.close();
+}
+
+bool PlannerCycleRecorder::IsOpen() const
+{
+  return m_File.is_open();
+}
+
+bool PlannerCycleRecorder::Write(const PlannerCycle& cycle)
+{
+  if(!m_File.is_open())
+    return false;
+
+  m_Buffer.clear();
+  CycleWriter writer(m_Buffer);
+
+  for(unsigned int i = 0; i < cycle.globalPaths.size(); i++)
+    writer.CollectLanes(cycle.globalPaths.at(i));
+  for(unsigned int i = 0; i < cycle.rollOuts.size(); i++)
+    for(unsigned int j = 0; j < cycle.rollOuts.at(i).size(); j++)
+      writer.CollectLanes(cycle.rollOuts.at(i).at(j));
+  for(unsigned int i = 0; i < cycle.totalPaths.size(); i++)
+    writer.CollectLanes(cycle.totalPaths.at(i));
+  for(unsigned int i = 0; i < cycle.decisionRollOuts.size(); i++)
+    writer.CollectLanes(cycle.decisionRollOuts.at(i));
+  writer.WriteLanes();
+
+  writer.WriteDouble(cycle.dt);
+  writer.WriteWayPoint(cycle.currPose);
+  writer.WriteDouble(cycle.vehicleState.speed);
+  writer.WriteDouble(cycle.vehicleState.steer);
+  writer.WriteInt(cycle.vehicleState.shift);
+  writer.WriteInt(cycle.goalID);
+  writer.WriteBool(cycle.bEmergencyStop);
+  writer.WriteInt(cycle.currTrajectoryIndex);
+  writer.WriteInt(cycle.currLaneIndex);
+
+  writer.WriteRaw(cycle.params);
+  writer.WriteRaw(cycle.carInfo);
+  writer.WriteRaw(cycle.ctrlParams);
+  writer.WriteRaw(cycle.predictionParams);
+
+  writer.WriteBool(cycle.bNewGlobalPath);
+  writer.WritePaths(cycle.globalPaths);
+  writer.WriteSize(cycle.rollOuts.size());
+  for(unsigned int i = 0; i < cycle.rollOuts.size(); i++)
+    writer.WritePaths(cycle.rollOuts.at(i));
+  writer.WritePaths(cycle.totalPaths);
+  writer.WritePaths(cycle.decisionRollOuts);
+
+  writer.WriteSize(cycle.trafficLights.size());
+  for(unsigned int i = 0; i < cycle.trafficLights.size(); i++)
+    writer.WriteTrafficLight(cycle.trafficLights.at(i));
+
+  writer.WriteObjects(cycle.detectedObjects);
+  writer.WriteObjects(cycle.predictedObjects);
+
+  writer.WriteBool(cycle.bHasTrajectoryCost);
+  writer.WriteTrajectoryCost(cycle.trajectoryCost);
+  writer.WriteBool(cycle.bHasBehavior);
+  writer.WriteBehavior(cycle.behavior);
+
+  uint32_t size = m_Buffer.size();
+  m_File.write(reinterpret_cast<const char*>(&size), sizeof(size));
+  m_File.write(m_Buffer.data(), m_Buffer.size());
+  return m_File.good();
+}
+
+PlannerCycleReader::PlannerCycleReader()
+{
+}
+
+PlannerCycleReader::~PlannerCycleReader()
+{
+  Close();
+}
+
+bool PlannerCycleReader::Open(const std::string& fileName)
+{
+  Close();
+  m_File.open(fileName.c_str(), std::ios::in | std::ios::binary);
+  if(!m_File.is_open())
+    return false;
+
+  FileHeader header;
+  FileHeader expected = CreateHeader();
+  m_File.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if(!m_File.good() || memcmp(&header, &expected, sizeof(header)) != 0)
+  {
+    std::cout << "Planner cycle file " << fileName << " was written by an incompatible version" << std::endl;
+    Close();
+    return false;
+  }
+
+  return true;
+}
+
+void PlannerCycleReader::Close()
+{
+  if(m_File.is_open())
+    m_File.close();
+}
+
+bool PlannerCycleReader::IsOpen() const
+{
+  return m_File.is_open();
+}
+
+bool PlannerCycleReader::Read(PlannerCycle& cycle)
+{
+  if(!m_File.is_open())
+    return false;
+
+  uint32_t size = 0;
+  m_File.read(reinterpret_cast<char*>(&size), sizeof(size));
+  if(!m_File.good())
+    return false;
+
+  m_Buffer.resize(size);
+  m_File.read(&m_Buffer[0], size);
+  if(!m_File.good())
+    return false;
+
+  CycleReader reader(m_Buffer);
+  cycle = PlannerCycle();
+  cycle.pLanes = std::make_shared<std::vector<Lane> >();
+  reader.ReadLanes(*cycle.pLanes);
+
+  cycle.dt = reader.ReadDouble();
+  reader.ReadWayPoint(cycle.currPose);
+  cycle.vehicleState.speed = reader.ReadDouble();
+  cycle.vehicleState.steer = reader.ReadDouble();
+  cycle.vehicleState.shift = (SHIFT_POS)reader.ReadInt();
+  cycle.goalID = reader.ReadInt();
+  cycle.bEmergencyStop = reader.ReadBool();
+  cycle.currTrajectoryIndex = reader.ReadInt();
+  cycle.currLaneIndex = reader.ReadInt();
+
+  cycle.params = reader.ReadRaw<PlanningParams>();
+  cycle.carInfo = reader.ReadRaw<CAR_BASIC_INFO>();
+  cycle.ctrlParams = reader.ReadRaw<ControllerParams>();
+  cycle.predictionParams = reader.ReadRaw<PredictionParams>();
+
+  cycle.bNewGlobalPath = reader.ReadBool();
+  reader.ReadPaths(cycle.globalPaths);
+  cycle.rollOuts.resize(reader.ReadSize());
+  for(unsigned int i = 0; i < cycle.rollOuts.size(); i++)
+    reader.ReadPaths(cycle.rollOuts.at(i));
+  reader.ReadPaths(cycle.totalPaths);
+  reader.ReadPaths(cycle.decisionRollOuts);
+
+  cycle.trafficLights.resize(reader.ReadSize());
+  for(unsigned int i = 0; i < cycle.trafficLights.size(); i++)
+    reader.ReadTrafficLight(cycle.trafficLights.at(i));
+
+  reader.ReadObjects(cycle.detectedObjects);
+  reader.ReadObjects(cycle.predictedObjects);
+
+  cycle.bHasTrajectoryCost = reader.ReadBool();
+  reader.ReadTrajectoryCost(cycle.trajectoryCost);
+  cycle.bHasBehavior = reader.ReadBool();
+  reader.ReadBehavior(cycle.behavior);
+
+  return reader.bValid && reader.offset == m_Buffer.size();
+}
+
+} /* namespace PlannerHNS */
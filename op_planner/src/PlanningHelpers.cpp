@@ -85,6 +85,17 @@ bool PlanningHelpers::GetRelativeInfo(const std::vector<WayPoint>& trajectory, c
 {
   if(trajectory.size() < 2) return false;
 
+  int iFront = 1;
+  if(trajectory.size() > 2)
+    iFront = GetClosestNextPointIndexFast(trajectory, p, prevIndex);
+
+  return GetRelativeInfoFromIndex(trajectory, p, iFront, info);
+}
+
+bool PlanningHelpers::GetRelativeInfoFromIndex(const std::vector<WayPoint>& trajectory, const WayPoint& p, const int& iFront, RelativeInfo& info)
+{
+  if(trajectory.size() < 2) return false;
+
   WayPoint p0, p1;
   if(trajectory.size()==2)
   {
@@ -97,11 +108,11 @@ bool PlanningHelpers::GetRelativeInfo(const std::vector<WayPoint>& trajectory, c
   }
   else
   {
-    info.iFront = GetClosestNextPointIndexFast(trajectory, p, prevIndex);
-//    WayPoint p2 = p;
-//    int old_index = GetClosestNextPointIndex(trajectory, p2, prevIndex);
-//    if(old_index != info.iFront)
-//      cout << " Alert Alert !!!! fast: " << info.iFront << ", slow: " << old_index  << endl;
+    info.iFront = iFront;
+    if(info.iFront < 0)
+      info.iFront = 0;
+    else if(info.iFront > (int)trajectory.size()-1)
+      info.iFront = trajectory.size()-1;
 
     if(info.iFront > 0)
       info.iBack = info.iFront -1;
@@ -126,16 +137,12 @@ bool PlanningHelpers::GetRelativeInfo(const std::vector<WayPoint>& trajectory, c
   }
 
   WayPoint prevWP = p0;
-  Mat3 rotationMat(-p1.pos.a);
-  Mat3 translationMat(-p.pos.x, -p.pos.y);
-  Mat3 invRotationMat(p1.pos.a);
-  Mat3 invTranslationMat(p.pos.x, p.pos.y);
+  RigidTransform2D transform = RigidTransform2D::ToFrame(p.pos.x, p.pos.y, p1.pos.a);
+  RigidTransform2D invTransform = transform.Inverse();
 
-  p0.pos = translationMat*p0.pos;
-  p0.pos = rotationMat*p0.pos;
+  p0.pos = transform*p0.pos;
 
-  p1.pos = translationMat*p1.pos;
-  p1.pos = rotationMat*p1.pos;
+  p1.pos = transform*p1.pos;
 
   double m = (p1.pos.y-p0.pos.y)/(p1.pos.x-p0.pos.x);
   info.perp_distance = p1.pos.y - m*p1.pos.x; // solve for x = 0
@@ -149,8 +156,7 @@ bool PlanningHelpers::GetRelativeInfo(const std::vector<WayPoint>& trajectory, c
   info.perp_point.pos.x = 0; // on the same y axis of the car
   info.perp_point.pos.y = info.perp_distance; //perp distance between the car and the trajectory
 
-  info.perp_point.pos = invRotationMat  * info.perp_point.pos;
-  info.perp_point.pos = invTranslationMat  * info.perp_point.pos;
+  info.perp_point.pos = invTransform*info.perp_point.pos;
 
   info.from_back_distance = hypot(info.perp_point.pos.y - prevWP.pos.y, info.perp_point.pos.x - prevWP.pos.x);
 
@@ -200,16 +206,12 @@ bool PlanningHelpers::GetRelativeInfoLimited(const std::vector<WayPoint>& trajec
     }
 
     WayPoint prevWP = p0;
-    Mat3 rotationMat(-p1.pos.a);
-    Mat3 translationMat(-p.pos.x, -p.pos.y);
-    Mat3 invRotationMat(p1.pos.a);
-    Mat3 invTranslationMat(p.pos.x, p.pos.y);
+    RigidTransform2D transform = RigidTransform2D::ToFrame(p.pos.x, p.pos.y, p1.pos.a);
+    RigidTransform2D invTransform = transform.Inverse();
 
-    p0.pos = translationMat*p0.pos;
-    p0.pos = rotationMat*p0.pos;
+    p0.pos = transform*p0.pos;
 
-    p1.pos = translationMat*p1.pos;
-    p1.pos = rotationMat*p1.pos;
+    p1.pos = transform*p1.pos;
 
     double m = (p1.pos.y-p0.pos.y)/(p1.pos.x-p0.pos.x);
     info.perp_distance = p1.pos.y - m*p1.pos.x; // solve for x = 0
@@ -222,8 +224,7 @@ bool PlanningHelpers::GetRelativeInfoLimited(const std::vector<WayPoint>& trajec
     info.perp_point.pos.x = 0; // on the same y axis of the car
     info.perp_point.pos.y = info.perp_distance; //perp distance between the car and the _trajectory
 
-    info.perp_point.pos = invRotationMat  * info.perp_point.pos;
-    info.perp_point.pos = invTranslationMat  * info.perp_point.pos;
+    info.perp_point.pos = invTransform*info.perp_point.pos;
 
     info.from_back_distance = hypot(info.perp_point.pos.y - prevWP.pos.y, info.perp_point.pos.x - prevWP.pos.x);
 
@@ -275,16 +276,12 @@ bool PlanningHelpers::GetRelativeInfoLimited(const std::vector<WayPoint>& trajec
     }
 
     WayPoint prevWP = p0;
-    Mat3 rotationMat(-p1.pos.a);
-    Mat3 translationMat(-p.pos.x, -p.pos.y);
-    Mat3 invRotationMat(p1.pos.a);
-    Mat3 invTranslationMat(p.pos.x, p.pos.y);
+    RigidTransform2D transform = RigidTransform2D::ToFrame(p.pos.x, p.pos.y, p1.pos.a);
+    RigidTransform2D invTransform = transform.Inverse();
 
-    p0.pos = translationMat*p0.pos;
-    p0.pos = rotationMat*p0.pos;
+    p0.pos = transform*p0.pos;
 
-    p1.pos = translationMat*p1.pos;
-    p1.pos = rotationMat*p1.pos;
+    p1.pos = transform*p1.pos;
 
     double m = (p1.pos.y-p0.pos.y)/(p1.pos.x-p0.pos.x);
     info.perp_distance = p1.pos.y - m*p1.pos.x; // solve for x = 0
@@ -297,8 +294,7 @@ bool PlanningHelpers::GetRelativeInfoLimited(const std::vector<WayPoint>& trajec
     info.perp_point.pos.x = 0; // on the same y axis of the car
     info.perp_point.pos.y = info.perp_distance; //perp distance between the car and the trajectory
 
-    info.perp_point.pos = invRotationMat  * info.perp_point.pos;
-    info.perp_point.pos = invTranslationMat  * info.perp_point.pos;
+    info.perp_point.pos = invTransform*info.perp_point.pos;
 
     info.from_back_distance = hypot(info.perp_point.pos.y - prevWP.pos.y, info.perp_point.pos.x - prevWP.pos.x);
 
@@ -340,16 +336,12 @@ bool PlanningHelpers::GetThreePointsInfo(const WayPoint& p0, const WayPoint& p1,
   WayPoint first_p = p0;
   double angle_x = atan2(p1.pos.y-p0.pos.y, p1.pos.x-p0.pos.x);
 
-  Mat3 rotationMat(-angle_x);
-  Mat3 translationMat(-p2.pos.x, -p2.pos.y);
-  Mat3 invRotationMat(angle_x);
-  Mat3 invTranslationMat(p2.pos.x, p2.pos.y);
+  RigidTransform2D transform = RigidTransform2D::ToFrame(p2.pos.x, p2.pos.y, angle_x);
+  RigidTransform2D invTransform = transform.Inverse();
 
-  first_p.pos = translationMat*first_p.pos;
-  first_p.pos = rotationMat*first_p.pos;
+  first_p.pos = transform*first_p.pos;
 
-  perp_p.pos = translationMat*perp_p.pos;
-  perp_p.pos = rotationMat*perp_p.pos;
+  perp_p.pos = transform*perp_p.pos;
 
   if(perp_p.pos.x-first_p.pos.x == 0) return false;
 
@@ -364,8 +356,7 @@ bool PlanningHelpers::GetThreePointsInfo(const WayPoint& p0, const WayPoint& p1,
   perp_p.pos.x = 0; // on the same y axis of the car
   perp_p.pos.y = lat_d; //perp distance between the car and the trajectory
 
-  perp_p.pos = invRotationMat  * perp_p.pos;
-  perp_p.pos = invTranslationMat  * perp_p.pos;
+  perp_p.pos = invTransform*perp_p.pos;
 
   long_d = hypot(perp_p.pos.y - first_p.pos.y, perp_p.pos.x - first_p.pos.x);
 
@@ -688,7 +679,53 @@ int PlanningHelpers::GetClosestNextPointIndexFast(const vector<WayPoint>& trajec
     return min_index;
 }
 
-int PlanningHelpers::GetClosestNextPointIndexDirectionFast(const vector<WayPoint>& trajectory, const WayPoint& p,const int& prevIndex )
+int PlanningHelpers::GetClosestNextPointIndexLocal(const vector<WayPoint>& trajectory, const WayPoint& p, const int& startIndex)
+{
+  int size = (int)trajectory.size();
+
+  if(size < 2) return 0;
+
+  int min_index = startIndex;
+  if(min_index < 0) min_index = 0;
+  if(min_index > size-1) min_index = size-1;
+
+  //walk downhill on the distance from the warm start, forward first since objects mostly move forward
+  double minD = distance2pointsSqr(trajectory[min_index].pos, p.pos);
+  while(min_index < size-1)
+  {
+    double d = distance2pointsSqr(trajectory[min_index+1].pos, p.pos);
+    if(d >= minD) break;
+    minD = d;
+    min_index++;
+  }
+
+  while(min_index > 0)
+  {
+    double d = distance2pointsSqr(trajectory[min_index-1].pos, p.pos);
+    if(d >= minD) break;
+    minD = d;
+    min_index--;
+  }
+
+  if(min_index < size-1)
+  {
+    GPSPoint curr, next;
+    curr = trajectory[min_index].pos;
+    next = trajectory[min_index+1].pos;
+    GPSPoint v_1(p.pos.x - curr.x   ,p.pos.y - curr.y,0,0);
+    double norm1 = pointNorm(v_1);
+    GPSPoint v_2(next.x - curr.x,next.y - curr.y,0,0);
+    double norm2 = pointNorm(v_2);
+    double dot_pro = v_1.x*v_2.x + v_1.y*v_2.y;
+    double a = UtilityH::FixNegativeAngle(acos(dot_pro/(norm1*norm2)));
+    if(a <= M_PI_2)
+      min_index = min_index+1;
+  }
+
+  return min_index;
+}
+
+int PlanningHelpers::GetClosestNextPointIndexDirectionFast(const vector<WayPoint>& trajectory, const WayPoint& p,const int& prevIndex, const int& endIndex )
 {
   int size = (int)trajectory.size();
 
@@ -696,8 +733,9 @@ int PlanningHelpers::GetClosestNextPointIndexDirectionFast(const vector<WayPoint
 
   double d = 0, minD = DBL_MAX;
   int min_index  = prevIndex;
+  int last_index = (endIndex < 0 || endIndex >= size) ? size - 1 : endIndex;
 
-  for(unsigned int i=prevIndex; i< size; i++)
+  for(int i=prevIndex; i <= last_index; i++)
   {
     d  = distance2pointsSqr(trajectory[i].pos, p.pos);
     double angle_diff = UtilityH::AngleBetweenTwoAnglesPositive(trajectory[i].pos.a, p.pos.a)*RAD2DEG;
@@ -727,6 +765,64 @@ int PlanningHelpers::GetClosestNextPointIndexDirectionFast(const vector<WayPoint
   return min_index;
 }
 
+//distance to the closest point, which is the point at or the one before the closest next point index
+static double GetCloseIndexDistance(const vector<WayPoint>& trajectory, const WayPoint& p, const int& close_index)
+{
+  double d = distance2points(trajectory.at(close_index).pos, p.pos);
+  if(close_index > 0)
+    d = std::min(d, distance2points(trajectory.at(close_index-1).pos, p.pos));
+  return d;
+}
+
+int PlanningHelpers::GetClosestNextPointIndexDirectionWarm(const vector<WayPoint>& trajectory, const WayPoint& p, const double& searchDistance,
+    ClosestPointInfo& info)
+{
+  int size = (int)trajectory.size();
+  if(size < 2)
+  {
+    info = ClosestPointInfo();
+    return 0;
+  }
+
+  int close_index = -1;
+  if(info.index >= 0 && info.index < size)
+  {
+    //the last result can be the point after the closest one
+    int start = std::max(info.index - 1, 0);
+    if(start + 1 >= size)
+      start = size - 2;
+    GPSPoint curr = trajectory.at(start).pos;
+    GPSPoint next = trajectory.at(start+1).pos;
+    GPSPoint v_1(p.pos.x - curr.x, p.pos.y - curr.y, 0, 0);
+    GPSPoint v_2(next.x - curr.x, next.y - curr.y, 0, 0);
+    bool bMovedBack = start > 0 && v_1.x*v_2.x + v_1.y*v_2.y < 0;
+
+    int end = start;
+    double d = 0;
+    while(end + 1 < size && d < searchDistance)
+    {
+      d += distance2points(trajectory.at(end).pos, trajectory.at(end+1).pos);
+      end++;
+    }
+
+    if(!bMovedBack)
+    {
+      close_index = GetClosestNextPointIndexDirectionFast(trajectory, p, start, end);
+      //on the window end the pose can be farther on, and away from the path another part of it can be closer
+      bool bLeftWindow = close_index >= end && end + 1 < size;
+      if(bLeftWindow || GetCloseIndexDistance(trajectory, p, close_index) > info.distance + pointNorm(v_2))
+        close_index = -1;
+    }
+  }
+
+  if(close_index < 0)
+    close_index = GetClosestNextPointIndexDirectionFast(trajectory, p);
+
+  info.index = close_index;
+  info.distance = GetCloseIndexDistance(trajectory, p, close_index);
+  return close_index;
+}
+
 int PlanningHelpers::GetClosestPointIndex_obsolete(const vector<WayPoint>& trajectory, const WayPoint& p,const int& prevIndex )
 {
   if(trajectory.size() == 0 || prevIndex < 0) return 0;
@@ -786,19 +882,14 @@ WayPoint PlanningHelpers::GetPerpendicularOnTrajectory_obsolete(const vector<Way
     }
   }
 
-  Mat3 rotationMat(-p1.pos.a);
-  Mat3 translationMat(-p.pos.x, -p.pos.y);
-  Mat3 invRotationMat(p1.pos.a);
-  Mat3 invTranslationMat(p.pos.x, p.pos.y);
+  RigidTransform2D transform = RigidTransform2D::ToFrame(p.pos.x, p.pos.y, p1.pos.a);
+  RigidTransform2D invTransform = transform.Inverse();
 
-  p0.pos = translationMat*p0.pos;
-  p0.pos = rotationMat*p0.pos;
+  p0.pos = transform*p0.pos;
 
-  p1.pos = translationMat*p1.pos;
-  p1.pos = rotationMat*p1.pos;
+  p1.pos = transform*p1.pos;
 
-  p2.pos = translationMat*p2.pos;
-  p2.pos= rotationMat*p2.pos;
+  p2.pos = transform*p2.pos;
 
   double m = (p1.pos.y-p0.pos.y)/(p1.pos.x-p0.pos.x);
   double d = p1.pos.y - m*p1.pos.x; // solve for x = 0
@@ -808,8 +899,7 @@ WayPoint PlanningHelpers::GetPerpendicularOnTrajectory_obsolete(const vector<Way
   perp.pos.x = 0; // on the same y axis of the car
   perp.pos.y = d; //perp distance between the car and the trajectory
 
-  perp.pos = invRotationMat  * perp.pos;
-  perp.pos = invTranslationMat  * perp.pos;
+  perp.pos = invTransform*perp.pos;
 
   return perp;
 }
@@ -856,17 +946,13 @@ double PlanningHelpers::GetPerpDistanceToTrajectorySimple_obsolete(const vector<
   }
 
 
-  Mat3 rotationMat(-p1.pos.a);
-  Mat3 translationMat(-p.pos.x, -p.pos.y);
+  RigidTransform2D transform = RigidTransform2D::ToFrame(p.pos.x, p.pos.y, p1.pos.a);
 
-  p0.pos = translationMat*p0.pos;
-  p0.pos = rotationMat*p0.pos;
+  p0.pos = transform*p0.pos;
 
-  p1.pos = translationMat*p1.pos;
-  p1.pos = rotationMat*p1.pos;
+  p1.pos = transform*p1.pos;
 
-  p2.pos = translationMat*p2.pos;
-  p2.pos = rotationMat*p2.pos;
+  p2.pos = transform*p2.pos;
 
   double m = (p1.pos.y-p0.pos.y)/(p1.pos.x-p0.pos.x);
   double d = p1.pos.y - m*p1.pos.x;
@@ -883,14 +969,11 @@ double PlanningHelpers::GetPerpDistanceToTrajectorySimple_obsolete(const vector<
 double PlanningHelpers::GetPerpDistanceToVectorSimple_obsolete(const WayPoint& point1, const WayPoint& point2, const WayPoint& pose)
 {
   WayPoint p1 = point1, p2 = point2;
-  Mat3 rotationMat(-p1.pos.a);
-  Mat3 translationMat(-pose.pos.x, -pose.pos.y);
+  RigidTransform2D transform = RigidTransform2D::ToFrame(pose.pos.x, pose.pos.y, p1.pos.a);
 
-  p1.pos = translationMat*p1.pos;
-  p1.pos = rotationMat*p1.pos;
+  p1.pos = transform*p1.pos;
 
-  p2.pos = translationMat*p2.pos;
-  p2.pos = rotationMat*p2.pos;
+  p2.pos = transform*p2.pos;
 
   double m = (p2.pos.y-p1.pos.y)/(p2.pos.x-p1.pos.x);
   double d = p2.pos.y - m*p2.pos.x;
@@ -1143,49 +1226,93 @@ void PlanningHelpers::FixPathDensity(vector<WayPoint>& path, const double& dista
 {
   if(path.size() == 0 || distanceDensity==0) return;
 
-  double d = 0, a = 0;
-  double margin = distanceDensity*0.01;
-  double remaining = 0;
-  int nPoints = 0;
   vector<WayPoint> fixedPath;
-  fixedPath.push_back(path.at(0));
-  for(unsigned int si = 0, ei=1; ei < path.size(); )
+  FixPathDensity(path, distanceDensity, fixedPath);
+  path.swap(fixedPath);
+}
+
+void PlanningHelpers::FixPathDensity(const vector<WayPoint>& path, const double& distanceDensity, vector<WayPoint>& fixedPath)
+{
+  if(&path == &fixedPath)
+  {
+    FixPathDensity(fixedPath, distanceDensity);
+    return;
+  }
+
+  if(path.size() == 0)
   {
-    d += hypot(path.at(ei).pos.x- path.at(ei-1).pos.x, path.at(ei).pos.y- path.at(ei-1).pos.y) + remaining;
-    a = atan2(path.at(ei).pos.y - path.at(si).pos.y, path.at(ei).pos.x - path.at(si).pos.x);
+    fixedPath.clear();
+    return;
+  }
 
-    if(d < distanceDensity - margin ) // skip
-    {
-      ei++;
-      remaining = 0;
-    }
-    else if(d > (distanceDensity +  margin)) // skip
+  FixPathDensity(path, 0, path.size() - 1, distanceDensity, fixedPath);
+}
+
+void PlanningHelpers::FixPathDensity(const vector<WayPoint>& path, const int& start, const int& end,
+    const double& distanceDensity, vector<WayPoint>& fixedPath)
+{
+  fixedPath.clear();
+  if(start < 0 || end >= (int)path.size() || start > end) return;
+  if(distanceDensity <= 0)
+  {
+    fixedPath.assign(path.begin() + start, path.begin() + end + 1);
+    return;
+  }
+
+  double total_length = 0;
+  for(int i = start + 1; i <= end; i++)
+    total_length += hypot(path[i].pos.x - path[i-1].pos.x, path[i].pos.y - path[i-1].pos.y);
+
+  double margin = distanceDensity*0.01;
+  fixedPath.reserve(total_length / distanceDensity + 2);
+  fixedPath.push_back(path[start]);
+
+  double next_s = distanceDensity;
+  double seg_start_s = 0;
+  for(int i = start + 1; i <= end; i++)
+  {
+    const WayPoint& p0 = path[i-1];
+    const WayPoint& p1 = path[i];
+    double seg_length = hypot(p1.pos.x - p0.pos.x, p1.pos.y - p0.pos.y);
+    if(seg_length <= 0) continue;
+
+    double seg_end_s = seg_start_s + seg_length;
+    //the last sample is accepted when it is short of the path end by less than the margin
+    if(i == end)
+      seg_end_s += margin;
+
+    if(next_s <= seg_end_s)
     {
-      WayPoint pm = path.at(si);
-      nPoints = d  / distanceDensity;
-      for(int k = 0; k < nPoints; k++)
+      double da = UtilityH::SplitPositiveAngle(p1.pos.a - p0.pos.a);
+      while(next_s <= seg_end_s)
       {
-        pm.pos.x = pm.pos.x + distanceDensity * cos(a);
-        pm.pos.y = pm.pos.y + distanceDensity * sin(a);
+        //a sample that falls on p1 within the margin is p1 itself, with its ids and attributes
+        if(fabs(seg_start_s + seg_length - next_s) <= margin)
+        {
+          fixedPath.push_back(p1);
+          next_s += distanceDensity;
+          continue;
+        }
+
+        double t = (next_s - seg_start_s) / seg_length;
+        if(t > 1.0) t = 1.0;
+        WayPoint pm = p0;
+        pm.pos.x = p0.pos.x + t * (p1.pos.x - p0.pos.x);
+        pm.pos.y = p0.pos.y + t * (p1.pos.y - p0.pos.y);
+        pm.pos.z = p0.pos.z + t * (p1.pos.z - p0.pos.z);
+        //keep the angle convention of the input, [-pi, pi] or [0, 2pi]
+        if(p0.pos.a < 0)
+          pm.pos.a = UtilityH::SplitPositiveAngle(p0.pos.a + t * da);
+        else
+          pm.pos.a = UtilityH::FixNegativeAngle(p0.pos.a + t * da);
+        pm.v = p0.v + t * (p1.v - p0.v);
         fixedPath.push_back(pm);
+        next_s += distanceDensity;
       }
-      remaining = d - nPoints*distanceDensity;
-      si++;
-      path.at(si).pos = pm.pos;
-      d = 0;
-      ei++;
-    }
-    else
-    {
-      d = 0;
-      remaining = 0;
-      fixedPath.push_back(path.at(ei));
-      ei++;
-      si = ei - 1;
     }
-  }
 
-  path = fixedPath;
+    seg_start_s += seg_length;
+  }
 }
 
 void PlanningHelpers::SmoothPath(vector<WayPoint>& path, double weight_data,
@@ -1381,125 +1508,129 @@ double PlanningHelpers::CalcCircle(const GPSPoint& pt1, const GPSPoint& pt2, con
   return  distance2points(center,pt1);
 }
 
-void PlanningHelpers::ExtractPartFromPointToDistance(const vector<WayPoint>& originalPath, const WayPoint& pos, const double& minDistance,
-    const double& pathDensity, vector<WayPoint>& extractedPath, const double& SmoothDataWeight, const double& SmoothWeight, const double& SmoothTolerance)
+//Index of the first point of the part behind start_index, walking back until more than backDistance is covered
+static int GetExtractStartIndex(const vector<WayPoint>& path, const int& start_index, const double& backDistance)
 {
-  extractedPath.clear();
-  unsigned int close_index = GetClosestNextPointIndexDirectionFast(originalPath, pos);
-//  int i_slow = GetClosestNextPointIndexDirection(originalPath, pos);
-//  if(close_index != i_slow)
-//    cout << "Aler Alert !!! fast: " << close_index << ", slow: " << i_slow  << endl;
-  //vector<WayPoint> tempPath;
-  double d_limit = 0;
-  if(close_index >= 2) close_index -=2;
-  else close_index = 0;
-
-  for(unsigned int i=close_index; i< originalPath.size(); i++)
+  double d = 0;
+  for(int i = start_index; i > 0; i--)
   {
-    extractedPath.push_back(originalPath.at(i));
-
-    if(i>0)
-      d_limit += hypot(originalPath.at(i).pos.y - originalPath.at(i-1).pos.y, originalPath.at(i).pos.x - originalPath.at(i-1).pos.x);
+    d += hypot(path.at(i).pos.y - path.at(i+1).pos.y, path.at(i).pos.x - path.at(i+1).pos.x);
+    if(d > backDistance)
+      return i;
+  }
+  return 0;
+}
 
-    if(d_limit > minDistance)
-      break;
+//Index of the last point of the part after start_index, walking forward until more than minDistance is covered
+static int GetExtractEndIndex(const vector<WayPoint>& path, const int& start_index, const double& minDistance)
+{
+  double d = 0;
+  for(int i = start_index + 1; i < (int)path.size(); i++)
+  {
+    if(i > 0)
+      d += hypot(path.at(i).pos.y - path.at(i-1).pos.y, path.at(i).pos.x - path.at(i-1).pos.x);
+    if(d > minDistance)
+      return i;
   }
+  return (int)path.size() - 1;
+}
 
-  if(extractedPath.size() < 2)
+//Copies path[start..end] resampled to the path density, a too short part is copied as it is
+static bool CopyExtractedPart(const vector<WayPoint>& path, const int& start, const int& end, const double& pathDensity,
+    vector<WayPoint>& extractedPath)
+{
+  if(end - start + 1 < 2)
   {
+    extractedPath.assign(path.begin() + start, path.begin() + end + 1);
     cout << endl << "### Planner Z . Extracted Rollout Path is too Small, Size = " << extractedPath.size() << endl;
-    return;
+    return false;
   }
 
-  FixPathDensity(extractedPath, pathDensity);
+  PlanningHelpers::FixPathDensity(path, start, end, pathDensity, extractedPath);
+  return true;
+}
+
+void PlanningHelpers::ExtractPartFromPointToDistance(const vector<WayPoint>& originalPath, const WayPoint& pos, const double& minDistance,
+    const double& pathDensity, vector<WayPoint>& extractedPath, const double& SmoothDataWeight, const double& SmoothWeight,
+    const double& SmoothTolerance, const int& prevIndex)
+{
+  extractedPath.clear();
+
+  int close_index = GetClosestNextPointIndexDirectionFast(originalPath, pos, prevIndex);
+  if(close_index >= 2) close_index -=2;
+  else close_index = 0;
+
+  //no part behind the closest point here, the forward walk starts at close_index itself
+  int end_index = GetExtractEndIndex(originalPath, close_index - 1, minDistance);
+
+  if(!CopyExtractedPart(originalPath, close_index, end_index, pathDensity, extractedPath))
+    return;
+
   SmoothPath(extractedPath, SmoothDataWeight, SmoothWeight , SmoothTolerance);
   CalcAngleAndCost(extractedPath);
-
-  //extractedPath = tempPath;
-  //tempPath.clear();
-  //TestQuadraticSpline(extractedPath, tempPath);
 }
 
 void PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(const vector<WayPoint>& originalPath, const WayPoint& pos, const double& minDistance,
-    const double& pathDensity, vector<WayPoint>& extractedPath)
+    const double& pathDensity, vector<WayPoint>& extractedPath, const int& prevIndex)
 {
-  if(originalPath.size() < 2 ) return;
-
   extractedPath.clear();
+  if(originalPath.size() < 2 ) return;
 
-  int close_index = GetClosestNextPointIndexDirectionFast(originalPath, pos);
-  double d = 0;
-
+  int close_index = GetClosestNextPointIndexDirectionFast(originalPath, pos, prevIndex);
   if(close_index + 1 >= originalPath.size())
     close_index = originalPath.size() - 2;
 
-  for(int i=close_index; i >=  0; i--)
-  {
-    extractedPath.insert(extractedPath.begin(),  originalPath.at(i));
-    if(i < originalPath.size())
-      d += hypot(originalPath.at(i).pos.y - originalPath.at(i+1).pos.y, originalPath.at(i).pos.x - originalPath.at(i+1).pos.x);
-    if(d > 10)
-      break;
-  }
+  int start_index = GetExtractStartIndex(originalPath, close_index, 10);
+  int end_index = GetExtractEndIndex(originalPath, close_index, minDistance);
 
-  //extractedPath.push_back(info.perp_point);
-  d = 0;
-  for(int i=close_index+1; i < (int)originalPath.size(); i++)
-  {
-    extractedPath.push_back(originalPath.at(i));
-    if(i > 0)
-      d += hypot(originalPath.at(i).pos.y - originalPath.at(i-1).pos.y, originalPath.at(i).pos.x - originalPath.at(i-1).pos.x);
-    if(d > minDistance)
-      break;
-  }
+  if(!CopyExtractedPart(originalPath, start_index, end_index, pathDensity, extractedPath))
+    return;
 
-  if(extractedPath.size() < 2)
+  CalcAngleAndCost(extractedPath);
+}
+
+void PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(const vector<WayPoint>& originalPath, const WayPoint& pos, const double& minDistance,
+    const double& pathDensity, vector<WayPoint>& extractedPath, ClosestPointInfo& closeInfo)
+{
+  extractedPath.clear();
+  if(originalPath.size() < 2 )
   {
-    cout << endl << "### Planner Z . Extracted Rollout Path is too Small, Size = " << extractedPath.size() << endl;
+    closeInfo = ClosestPointInfo();
     return;
   }
 
-  FixPathDensity(extractedPath, pathDensity);
+  //the pose moves less than the extracted distance between steps
+  int close_index = GetClosestNextPointIndexDirectionWarm(originalPath, pos, minDistance, closeInfo);
+  if(close_index + 1 >= originalPath.size())
+    close_index = originalPath.size() - 2;
+
+  int start_index = GetExtractStartIndex(originalPath, close_index, 10);
+  int end_index = GetExtractEndIndex(originalPath, close_index, minDistance);
+
+  if(!CopyExtractedPart(originalPath, start_index, end_index, pathDensity, extractedPath))
+    return;
+
   CalcAngleAndCost(extractedPath);
 }
 
 void PlanningHelpers::ExtractPartFromPointToDistanceFast(const vector<WayPoint>& originalPath, const WayPoint& pos, const double& minDistance,
-    const double& pathDensity, vector<WayPoint>& extractedPath, const double& SmoothDataWeight, const double& SmoothWeight, const double& SmoothTolerance)
+    const double& pathDensity, vector<WayPoint>& extractedPath, const double& SmoothDataWeight, const double& SmoothWeight,
+    const double& SmoothTolerance, const int& prevIndex)
 {
   extractedPath.clear();
+  if(originalPath.size() < 2) return;
+
   RelativeInfo info;
-  GetRelativeInfo(originalPath, pos, info);
-  double d = 0;
+  GetRelativeInfo(originalPath, pos, info, prevIndex);
   if(info.iBack > 0)
     info.iBack--;
 
-  for(int i=info.iBack; i >=  0; i--)
-  {
-    extractedPath.insert(extractedPath.begin(),  originalPath.at(i));
-    if(i < originalPath.size())
-      d += hypot(originalPath.at(i).pos.y - originalPath.at(i+1).pos.y, originalPath.at(i).pos.x - originalPath.at(i+1).pos.x);
-    if(d > 10)
-      break;
-  }
-
-  //extractedPath.push_back(info.perp_point);
-  d = 0;
-  for(int i=info.iBack+1; i < (int)originalPath.size(); i++)
-  {
-    extractedPath.push_back(originalPath.at(i));
-    if(i > 0)
-      d += hypot(originalPath.at(i).pos.y - originalPath.at(i-1).pos.y, originalPath.at(i).pos.x - originalPath.at(i-1).pos.x);
-    if(d > minDistance)
-      break;
-  }
+  int start_index = GetExtractStartIndex(originalPath, info.iBack, 10);
+  int end_index = GetExtractEndIndex(originalPath, info.iBack, minDistance);
 
-  if(extractedPath.size() < 2)
-  {
-    cout << endl << "### Planner Z . Extracted Rollout Path is too Small, Size = " << extractedPath.size() << endl;
+  if(!CopyExtractedPart(originalPath, start_index, end_index, pathDensity, extractedPath))
     return;
-  }
 
-  FixPathDensity(extractedPath, pathDensity);
   CalcAngleAndCost(extractedPath);
 }
 
@@ -1835,7 +1966,7 @@ void PlanningHelpers::SmoothSpeedProfiles(vector<WayPoint>& path_in, double weig
   int nIterations = 0;
   int size = newpath.size();
 
-  while (change >= tolerance)
+  while (change >= tolerance && nIterations < MAX_PROFILE_SMOOTHING_ITERATIONS)
   {
     change = 0.0;
     for (int i = 1; i < size -1; i++)
@@ -1863,7 +1994,7 @@ void PlanningHelpers::SmoothCurvatureProfiles(vector<WayPoint>& path_in, double
   int nIterations = 0;
   int size = newpath.size();
 
-  while (change >= tolerance)
+  while (change >= tolerance && nIterations < MAX_PROFILE_SMOOTHING_ITERATIONS)
   {
     change = 0.0;
     for (int i = 1; i < size -1; i++)
@@ -1911,7 +2042,18 @@ void PlanningHelpers::SmoothWayPointsDirections(vector<WayPoint>& path_in, doubl
 void PlanningHelpers::SmoothGlobalPathSpeed(vector<WayPoint>& path)
 {
   CalcAngleAndCostAndCurvatureAnd2D(path);
-  SmoothSpeedProfiles(path, 0.45,0.25, 0.01);
+
+  PlanningParams params;
+  params.maxSpeed = 0;
+  for(unsigned int i = 0 ; i < path.size(); i++)
+  {
+    if(path.at(i).v > params.maxSpeed)
+      params.maxSpeed = path.at(i).v;
+  }
+
+  CAR_BASIC_INFO carInfo;
+  carInfo.max_speed_forward = params.maxSpeed;
+  GenerateSpeedProfile(path, params, carInfo);
 }
 
 void PlanningHelpers::GenerateRecommendedSpeed(vector<WayPoint>& path, const double& max_speed, const double& speedProfileFactor)
@@ -1946,12 +2088,67 @@ void PlanningHelpers::GenerateRecommendedSpeed(vector<WayPoint>& path, const dou
   SmoothSpeedProfiles(path, 0.4,0.3, 0.01);
 }
 
+void PlanningHelpers::GenerateSpeedProfile(vector<WayPoint>& path, const PlanningParams& params, const CAR_BASIC_INFO& carInfo)
+{
+  if(path.size() < 2) return;
+
+  double max_speed = std::min(params.maxSpeed, carInfo.max_speed_forward);
+  double max_accel = fabs(carInfo.max_acceleration);
+  double max_decel = fabs(carInfo.max_deceleration);
+  double max_lateral_accel = fabs(carInfo.max_lateral_acceleration);
+  int size = path.size();
+
+  for(int i = 0; i < size; i++)
+  {
+    //same as GenerateRecommendedSpeed, a map speed of 0 stops the vehicle, only a negative one means no limit
+    double local_max = (path[i].v >= 0 && path[i].v < max_speed) ? path[i].v : max_speed;
+
+    if(i > 0 && i < size-1)
+    {
+      //Menger curvature of three consecutive points
+      double ax = path[i].pos.x - path[i-1].pos.x, ay = path[i].pos.y - path[i-1].pos.y;
+      double bx = path[i+1].pos.x - path[i].pos.x, by = path[i+1].pos.y - path[i].pos.y;
+      double cx = path[i+1].pos.x - path[i-1].pos.x, cy = path[i+1].pos.y - path[i-1].pos.y;
+      double denominator = sqrt((ax*ax + ay*ay) * (bx*bx + by*by) * (cx*cx + cy*cy));
+      if(denominator > 1e-9)
+      {
+        double k = 2.0 * fabs(ax*by - ay*bx) / denominator;
+        if(k > 1e-6)
+        {
+          double v_curve = sqrt(max_lateral_accel / k) * params.speedProfileFactor;
+          if(v_curve < local_max)
+            local_max = v_curve;
+        }
+      }
+    }
+
+    path[i].v = local_max;
+  }
+
+  for(int i = 1; i < size; i++)
+  {
+    double d = distance2points(path[i-1].pos, path[i].pos);
+    double v_reachable = sqrt(path[i-1].v*path[i-1].v + 2.0*max_accel*d);
+    if(path[i].v > v_reachable)
+      path[i].v = v_reachable;
+  }
+
+  for(int i = size-2; i >= 0; i--)
+  {
+    double d = distance2points(path[i].pos, path[i+1].pos);
+    double v_stoppable = sqrt(path[i+1].v*path[i+1].v + 2.0*max_decel*d);
+    if(path[i].v > v_stoppable)
+      path[i].v = v_stoppable;
+  }
+}
+
 WayPoint* PlanningHelpers::BuildPlanningSearchTreeV2(WayPoint* pStart,
     const WayPoint& goalPos,
     const vector<int>& globalPath,
     const double& DistanceLimit,
     const bool& bEnableLaneChange,
-    vector<WayPoint*>& all_cells_to_delete)
+    vector<WayPoint*>& all_cells_to_delete,
+    const RoadNetworkSnapshot* pCosts)
 {
   if(!pStart) return NULL;
 
@@ -2010,10 +2207,15 @@ WayPoint* PlanningHelpers::BuildPlanningSearchTreeV2(WayPoint* pStart,
         distance += d;
         before_change_distance = -LANE_CHANGE_MIN_DISTANCE*3;
 
-        for(unsigned int a = 0; a < wp->actionCost.size(); a++)
+        if(pCosts)
+          d += pCosts->GetTotalActionCost(*wp);
+        else
         {
-          //if(wp->actionCost.at(a).first == LEFT_TURN_ACTION)
-            d += wp->actionCost.at(a).second;
+          for(unsigned int a = 0; a < wp->actionCost.size(); a++)
+          {
+            //if(wp->actionCost.at(a).first == LEFT_TURN_ACTION)
+              d += wp->actionCost.at(a).second;
+          }
         }
 
         wp->cost = pH->cost + d;
@@ -2032,10 +2234,15 @@ WayPoint* PlanningHelpers::BuildPlanningSearchTreeV2(WayPoint* pStart,
         distance += d;
         before_change_distance = -LANE_CHANGE_MIN_DISTANCE*3;
 
-        for(unsigned int a = 0; a < wp->actionCost.size(); a++)
+        if(pCosts)
+          d += pCosts->GetTotalActionCost(*wp);
+        else
         {
-          //if(wp->actionCost.at(a).first == RIGHT_TURN_ACTION)
-            d += wp->actionCost.at(a).second;
+          for(unsigned int a = 0; a < wp->actionCost.size(); a++)
+          {
+            //if(wp->actionCost.at(a).first == RIGHT_TURN_ACTION)
+              d += wp->actionCost.at(a).second;
+          }
         }
 
         wp->cost = pH->cost + d ;
@@ -2056,10 +2263,15 @@ WayPoint* PlanningHelpers::BuildPlanningSearchTreeV2(WayPoint* pStart,
           distance += d;
           before_change_distance += d;
 
-          for(unsigned int a = 0; a < wp->actionCost.size(); a++)
+          if(pCosts)
+            d += pCosts->GetTotalActionCost(*wp);
+          else
           {
-            //if(wp->actionCost.at(a).first == FORWARD_ACTION)
-              d += wp->actionCost.at(a).second;
+            for(unsigned int a = 0; a < wp->actionCost.size(); a++)
+            {
+              //if(wp->actionCost.at(a).first == FORWARD_ACTION)
+                d += wp->actionCost.at(a).second;
+            }
           }
 
           wp->cost = pH->cost + d;
@@ -2631,8 +2843,7 @@ void PlanningHelpers::CalcContourPointsForDetectedObjects(const WayPoint& currPo
     {
       DetectedObject obj = obj_list.at(i);
 
-      Mat3 rotationMat(center.a);
-      Mat3 translationMat(center.x, center.y);
+      RigidTransform2D transform = RigidTransform2D::FromFrame(center.x, center.y, center.a);
       double w2 = obj.w/2.0;
       double h2 = obj.l/2.0;
       double z = center.z + obj.h/2.0;
@@ -2642,21 +2853,12 @@ void PlanningHelpers::CalcContourPointsForDetectedObjects(const WayPoint& currPo
       GPSPoint right_top(w2,h2, z,0);
       GPSPoint left_top(-w2,h2, z,0);
 
-      left_bottom   = rotationMat * left_bottom;
-      right_bottom   = rotationMat * right_bottom;
-      right_top     = rotationMat * right_top;
-      left_top     = rotationMat * left_top;
-
-      left_bottom   = translationMat * left_bottom;
-      right_bottom   = translationMat * right_bottom;
-      right_top     = translationMat * right_top;
-      left_top     = translationMat * left_top;
-
       obj.contour.clear();
       obj.contour.push_back(left_bottom);
       obj.contour.push_back(right_bottom);
       obj.contour.push_back(right_top);
       obj.contour.push_back(left_top);
+      transform.Apply(obj.contour);
 
       res_list.push_back(obj);
     }
@@ -2749,19 +2951,13 @@ LIGHT_INDICATOR PlanningHelpers::GetIndicatorsFromPath(const std::vector<WayPoin
 PlannerHNS::WayPoint PlanningHelpers::GetRealCenter(const PlannerHNS::WayPoint& currState, const double& wheel_base)
 {
   PlannerHNS::WayPoint pose_center = currState;
-  PlannerHNS::Mat3 rotationMat(-currState.pos.a);
-  PlannerHNS::Mat3 translationMat(-currState.pos.x, -currState.pos.y);
-
-  PlannerHNS::Mat3 rotationMatInv(currState.pos.a);
-  PlannerHNS::Mat3 translationMatInv(currState.pos.x, currState.pos.y);
+  PlannerHNS::RigidTransform2D transform = PlannerHNS::RigidTransform2D::ToFrame(currState.pos.x, currState.pos.y, currState.pos.a);
 
-  pose_center.pos = translationMat*pose_center.pos;
-  pose_center.pos = rotationMat*pose_center.pos;
+  pose_center.pos = transform*pose_center.pos;
 
   pose_center.pos.x += wheel_base/3.0;
 
-  pose_center.pos = rotationMatInv*pose_center.pos;
-  pose_center.pos = translationMatInv*pose_center.pos;
+  pose_center.pos = transform.Inverse()*pose_center.pos;
 
   return pose_center;
 }
@@ -0,0 +1,143 @@
+
+/// \file RoadNetworkSnapshot.cpp
+/// \brief Versioned read only snapshots of a RoadNetwork with dynamic action cost layers on top of it
+
+#include "op_planner/RoadNetworkSnapshot.h"
+#include <atomic>
+
+namespace PlannerHNS
+{
+
+const ActionCosts* MapCostOverlay::Find(const int& id) const
+{
+  const MapCostOverlay* pLayer = this;
+  while(pLayer)
+  {
+    ActionCostsMap::const_iterator it = pLayer->actionCosts.find(id);
+    if(it != pLayer->actionCosts.end())
+      return &it->second;
+    pLayer = pLayer->pParent.get();
+  }
+  return 0;
+}
+
+const ActionCosts& RoadNetworkSnapshot::GetActionCosts(const WayPoint& wp) const
+{
+  if(pOverlay)
+  {
+    const ActionCosts* pCosts = pOverlay->Find(wp.id);
+    if(pCosts)
+      return *pCosts;
+  }
+  return wp.actionCost;
+}
+
+double RoadNetworkSnapshot::GetTotalActionCost(const WayPoint& wp) const
+{
+  const ActionCosts& costs = GetActionCosts(wp);
+  double total = 0;
+  for(unsigned int i = 0; i < costs.size(); i++)
+    total += costs.at(i).second;
+  return total;
+}
+
+WayPoint RoadNetworkSnapshot::GetWayPoint(const WayPoint& wp) const
+{
+  WayPoint copy = wp;
+  if(pOverlay)
+  {
+    const ActionCosts* pCosts = pOverlay->Find(wp.id);
+    if(pCosts)
+      copy.actionCost = *pCosts;
+  }
+  return copy;
+}
+
+VersionedRoadNetwork::VersionedRoadNetwork()
+{
+  std::shared_ptr<RoadNetworkSnapshot> pEmpty = std::make_shared<RoadNetworkSnapshot>();
+  pEmpty->pMap = std::make_shared<RoadNetwork>();
+  m_pSnapshot = pEmpty;
+}
+
+std::shared_ptr<const RoadNetworkSnapshot> VersionedRoadNetwork::GetSnapshot() const
+{
+  return std::atomic_load(&m_pSnapshot);
+}
+
+bool VersionedRoadNetwork::Swap(std::shared_ptr<const RoadNetworkSnapshot>& expected,
+    const std::shared_ptr<const RoadNetworkSnapshot>& next)
+{
+  return std::atomic_compare_exchange_strong(&m_pSnapshot, &expected, next);
+}
+
+std::shared_ptr<const RoadNetworkSnapshot> VersionedRoadNetwork::SetMap(const std::shared_ptr<const RoadNetwork>& pMap)
+{
+  std::shared_ptr<const RoadNetworkSnapshot> pCurrent = GetSnapshot();
+  std::shared_ptr<RoadNetworkSnapshot> pNext = std::make_shared<RoadNetworkSnapshot>();
+  pNext->pMap = pMap ? pMap : std::make_shared<RoadNetwork>();
+  do
+  {
+    pNext->version = pCurrent->version + 1;
+  } while(!Swap(pCurrent, pNext));
+
+  return pNext;
+}
+
+std::shared_ptr<const RoadNetworkSnapshot> VersionedRoadNetwork::CreateLayer(const RoadNetworkSnapshot& current,
+    const ActionCostsMap& costs) const
+{
+  std::shared_ptr<MapCostOverlay> pLayer = std::make_shared<MapCostOverlay>();
+  pLayer->version = current.version + 1;
+  pLayer->actionCosts = costs;
+
+  if(current.pOverlay && current.pOverlay->depth + 1 < MAP_OVERLAY_MAX_DEPTH)
+  {
+    pLayer->pParent = current.pOverlay;
+    pLayer->depth = current.pOverlay->depth + 1;
+  }
+  else
+  {
+    //flatten, newer layers win so the older entries are only added when missing
+    const MapCostOverlay* pOld = current.pOverlay.get();
+    while(pOld)
+    {
+      pLayer->actionCosts.insert(pOld->actionCosts.begin(), pOld->actionCosts.end());
+      pOld = pOld->pParent.get();
+    }
+  }
+
+  std::shared_ptr<RoadNetworkSnapshot> pNext = std::make_shared<RoadNetworkSnapshot>();
+  pNext->version = pLayer->version;
+  pNext->pMap = current.pMap;
+  pNext->pOverlay = pLayer;
+  return pNext;
+}
+
+std::shared_ptr<const RoadNetworkSnapshot> VersionedRoadNetwork::PublishActionCosts(const ActionCostsMap& costs)
+{
+  std::shared_ptr<const RoadNetworkSnapshot> pCurrent = GetSnapshot();
+  std::shared_ptr<const RoadNetworkSnapshot> pNext;
+  do
+  {
+    pNext = CreateLayer(*pCurrent, costs);
+  } while(!Swap(pCurrent, pNext));
+
+  return pNext;
+}
+
+std::shared_ptr<const RoadNetworkSnapshot> VersionedRoadNetwork::PublishActionCosts(
+    const std::shared_ptr<const RoadNetworkSnapshot>& pBase, const ActionCostsMap& costs)
+{
+  if(!pBase)
+    return std::shared_ptr<const RoadNetworkSnapshot>();
+
+  std::shared_ptr<const RoadNetworkSnapshot> pExpected = pBase;
+  std::shared_ptr<const RoadNetworkSnapshot> pNext = CreateLayer(*pBase, costs);
+  if(!Swap(pExpected, pNext))
+    return std::shared_ptr<const RoadNetworkSnapshot>();
+
+  return pNext;
+}
+
+} /* namespace PlannerHNS */
@@ -49,6 +49,7 @@ void SimuDecisionMaker::ReInitializePlanner(const WayPoint& start_pose)
   m_pCurrentBehaviorState = m_pFollowState;
   m_TotalPath.clear();
   m_TotalOriginalPath.clear();
+  m_TotalPathClosePoints.clear();
   m_Path.clear();
   m_RollOuts.clear();
   m_pCurrentBehaviorState->m_Behavior = PlannerHNS::FORWARD_STATE;
@@ -132,8 +133,7 @@ void SimuDecisionMaker::FirstLocalizeMe(const WayPoint& initCarPos)
 
  void SimuDecisionMaker::GenerateLocalRollOuts()
  {
-  std::vector<PlannerHNS::WayPoint> sampledPoints_debug;
-  std::vector<std::vector<std::vector<PlannerHNS::WayPoint> > > _roll_outs;
+  std::vector<std::vector<std::vector<PlannerHNS::WayPoint> > >& _roll_outs = m_GeneratedRollOuts;
   PlannerHNS::PlannerH _planner;
   _planner.GenerateRunoffTrajectory(m_TotalPath, state,
             m_params.enableLaneChange,
@@ -153,7 +153,7 @@ void SimuDecisionMaker::FirstLocalizeMe(const WayPoint& initCarPos)
             m_params.speedProfileFactor,
             m_params.enableHeadingSmoothing,
             -1 , -1,
-            _roll_outs, sampledPoints_debug);
+            _roll_outs, m_SampledPoints);
 
   if(_roll_outs.size()>0)
     m_RollOuts.clear();
@@ -219,12 +219,12 @@ void SimuDecisionMaker::FirstLocalizeMe(const WayPoint& initCarPos)
 {
    PlannerHNS::BehaviorState beh;
    state.v = vehicleState.speed;
-   m_TotalPath.clear();
+   //extracted in place, the paths keep their memory from the previous step
+   m_TotalPath.resize(m_TotalOriginalPath.size());
+   m_TotalPathClosePoints.resize(m_TotalOriginalPath.size());
   for(unsigned int i = 0; i < m_TotalOriginalPath.size(); i++)
   {
-    t_centerTrajectorySmoothed.clear();
-    PlannerHNS::PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(m_TotalOriginalPath.at(i), state, m_params.horizonDistance ,  m_params.pathDensity , t_centerTrajectorySmoothed);
-    m_TotalPath.push_back(t_centerTrajectorySmoothed);
+    PlannerHNS::PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(m_TotalOriginalPath.at(i), state, m_params.horizonDistance ,  m_params.pathDensity , m_TotalPath.at(i), m_TotalPathClosePoints.at(i));
   }
 
   if(m_TotalPath.size()==0) return beh;
@@ -247,4 +247,22 @@ void SimuDecisionMaker::FirstLocalizeMe(const WayPoint& initCarPos)
 
   return beh;
  }
+
+ void SimuDecisionMaker::Step(const double& dt, SimuAgentStep& step)
+ {
+   step.currStatus = LocalizeStep(dt, step.desiredStatus);
+   step.behavior = DoOneStep(dt, step.currStatus, step.goalID, step.trafficLights, step.objects, step.bEmergencyStop);
+ }
+
+ void SimuDecisionMaker::StepAgents(const double& dt, const std::vector<SimuDecisionMaker*>& agents, std::vector<SimuAgentStep>& steps)
+ {
+   int n = std::min(agents.size(), steps.size());
+
+#pragma omp parallel for schedule(dynamic) if(n > 1)
+   for(int i = 0; i < n; i++)
+   {
+     if(agents[i])
+       agents[i]->Step(dt, steps[i]);
+   }
+ }
 }
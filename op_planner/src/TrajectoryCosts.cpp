@@ -135,8 +135,7 @@ void TrajectoryCosts::CalculateLateralAndLongitudinalCosts(vector<TrajectoryCost
   double critical_long_back_distance =  carInfo.length/2.0 + params.verticalSafetyDistance - carInfo.wheel_base/2.0;
   int iCostIndex = 0;
 
-  PlannerHNS::Mat3 invRotationMat(currState.pos.a-M_PI_2);
-  PlannerHNS::Mat3 invTranslationMat(currState.pos.x, currState.pos.y);
+  PlannerHNS::RigidTransform2D invTransform = PlannerHNS::RigidTransform2D::FromFrame(currState.pos.x, currState.pos.y, currState.pos.a-M_PI_2);
 
   double corner_slide_distance = critical_lateral_distance/2.0;
   double ratio_to_angle = corner_slide_distance/carInfo.max_steer_angle;
@@ -151,24 +150,6 @@ void TrajectoryCosts::CalculateLateralAndLongitudinalCosts(vector<TrajectoryCost
   GPSPoint top_right(critical_lateral_distance - slide_distance, critical_long_front_distance,  currState.pos.z, 0);
   GPSPoint top_left(-critical_lateral_distance - slide_distance , critical_long_front_distance, currState.pos.z, 0);
 
-  bottom_left = invRotationMat*bottom_left;
-  bottom_left = invTranslationMat*bottom_left;
-
-  top_right = invRotationMat*top_right;
-  top_right = invTranslationMat*top_right;
-
-  bottom_right = invRotationMat*bottom_right;
-  bottom_right = invTranslationMat*bottom_right;
-
-  top_left = invRotationMat*top_left;
-  top_left = invTranslationMat*top_left;
-
-  top_right_car = invRotationMat*top_right_car;
-  top_right_car = invTranslationMat*top_right_car;
-
-  top_left_car = invRotationMat*top_left_car;
-  top_left_car = invTranslationMat*top_left_car;
-
   m_SafetyBorder.points.clear();
   m_SafetyBorder.points.push_back(bottom_left) ;
   m_SafetyBorder.points.push_back(bottom_right) ;
@@ -176,6 +157,7 @@ void TrajectoryCosts::CalculateLateralAndLongitudinalCosts(vector<TrajectoryCost
   m_SafetyBorder.points.push_back(top_right) ;
   m_SafetyBorder.points.push_back(top_left) ;
   m_SafetyBorder.points.push_back(top_left_car) ;
+  invTransform.Apply(m_SafetyBorder.points);
 
   for(unsigned int il=0; il < rollOuts.size(); il++)
   {
@@ -27,6 +27,8 @@ TrajectoryDynamicCosts::TrajectoryDynamicCosts()
   m_PrevIndex = -1;
   m_WeightPriority = 0.9;
   m_WeightTransition = 0.9;
+  m_bUseDistanceField = false;
+  m_DistanceFieldResolution = 0.25;
 }
 
 TrajectoryDynamicCosts::~TrajectoryDynamicCosts()
@@ -169,7 +171,10 @@ TrajectoryCost TrajectoryDynamicCosts::DoOneStepStatic(const vector<vector<WayPo
     }
   }
 
-  CalculateLateralAndLongitudinalCostsStatic(m_TrajectoryCosts, rollOuts, totalPaths, currState, m_AllContourPoints, params, carInfo, vehicleState);
+  if(m_bUseDistanceField)
+    CalculateLateralAndLongitudinalCostsDistanceField(m_TrajectoryCosts, rollOuts, currState, m_AllContourPoints, params, carInfo, vehicleState);
+  else
+    CalculateLateralAndLongitudinalCostsStatic(m_TrajectoryCosts, rollOuts, totalPaths, currState, m_AllContourPoints, params, carInfo, vehicleState);
 
   NormalizeCosts(m_TrajectoryCosts);
 
@@ -322,8 +327,7 @@ void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCostsStatic(vector<T
   double critical_long_front_distance =  carInfo.wheel_base/2.0 + carInfo.length/2.0 + params.verticalSafetyDistance;
   double critical_long_back_distance =  carInfo.length/2.0 + params.verticalSafetyDistance - carInfo.wheel_base/2.0;
 
-  PlannerHNS::Mat3 invRotationMat(currState.pos.a-M_PI_2);
-  PlannerHNS::Mat3 invTranslationMat(currState.pos.x, currState.pos.y);
+  PlannerHNS::RigidTransform2D invTransform = PlannerHNS::RigidTransform2D::FromFrame(currState.pos.x, currState.pos.y, currState.pos.a-M_PI_2);
 
   double corner_slide_distance = critical_lateral_distance/2.0;
   double ratio_to_angle = corner_slide_distance/carInfo.max_steer_angle;
@@ -338,24 +342,6 @@ void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCostsStatic(vector<T
   GPSPoint top_right(critical_lateral_distance - slide_distance, critical_long_front_distance,  currState.pos.z, 0);
   GPSPoint top_left(-critical_lateral_distance - slide_distance , critical_long_front_distance, currState.pos.z, 0);
 
-  bottom_left = invRotationMat*bottom_left;
-  bottom_left = invTranslationMat*bottom_left;
-
-  top_right = invRotationMat*top_right;
-  top_right = invTranslationMat*top_right;
-
-  bottom_right = invRotationMat*bottom_right;
-  bottom_right = invTranslationMat*bottom_right;
-
-  top_left = invRotationMat*top_left;
-  top_left = invTranslationMat*top_left;
-
-  top_right_car = invRotationMat*top_right_car;
-  top_right_car = invTranslationMat*top_right_car;
-
-  top_left_car = invRotationMat*top_left_car;
-  top_left_car = invTranslationMat*top_left_car;
-
   m_SafetyBorder.points.clear();
   m_SafetyBorder.points.push_back(bottom_left) ;
   m_SafetyBorder.points.push_back(bottom_right) ;
@@ -363,6 +349,7 @@ void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCostsStatic(vector<T
   m_SafetyBorder.points.push_back(top_right) ;
   m_SafetyBorder.points.push_back(top_left) ;
   m_SafetyBorder.points.push_back(top_left_car) ;
+  invTransform.Apply(m_SafetyBorder.points);
 
   int iCostIndex = 0;
   if(rollOuts.size() > 0 && rollOuts.at(0).size()>0)
@@ -439,6 +426,102 @@ void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCostsStatic(vector<T
   }
 }
 
+void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCostsDistanceField(vector<TrajectoryCost>& trajectoryCosts,
+    const vector<vector<WayPoint> >& rollOuts, const WayPoint& currState, const vector<WayPoint>& contourPoints,
+    const PlanningParams& params, const CAR_BASIC_INFO& carInfo, const VehicleState& vehicleState)
+{
+  double critical_lateral_distance =  carInfo.width/2.0 + params.horizontalSafetyDistancel;
+  double critical_long_front_distance =  carInfo.wheel_base/2.0 + carInfo.length/2.0 + params.verticalSafetyDistance;
+  double critical_long_back_distance =  carInfo.length/2.0 + params.verticalSafetyDistance - carInfo.wheel_base/2.0;
+
+  InitializeSafetyPolygon(currState, carInfo, vehicleState, critical_lateral_distance, critical_long_front_distance, critical_long_back_distance);
+
+  //big enough for every roll-out point within the following distance and the clearance around it
+  double half_size = params.minFollowingDistance + critical_long_front_distance + critical_lateral_distance;
+  m_DistanceField.Build(currState.pos, half_size, m_DistanceFieldResolution, contourPoints);
+
+  //every contour point inside the bounding box of the safety border is checked against the border polygon
+  bool bInsideBorder = false;
+  if(m_SafetyBorder.points.size() > 0)
+  {
+    GPSPoint min_p = m_SafetyBorder.points.at(0);
+    GPSPoint max_p = m_SafetyBorder.points.at(0);
+    for(unsigned int ib = 1; ib < m_SafetyBorder.points.size(); ib++)
+    {
+      const GPSPoint& b = m_SafetyBorder.points.at(ib);
+      min_p.x = std::min(min_p.x, b.x);
+      min_p.y = std::min(min_p.y, b.y);
+      max_p.x = std::max(max_p.x, b.x);
+      max_p.y = std::max(max_p.y, b.y);
+    }
+
+    for(unsigned int icon = 0; icon < contourPoints.size() && !bInsideBorder; icon++)
+    {
+      const GPSPoint& p = contourPoints.at(icon).pos;
+      if(p.x < min_p.x || p.x > max_p.x || p.y < min_p.y || p.y > max_p.y)
+        continue;
+
+      if(m_SafetyBorder.PointInsidePolygon(m_SafetyBorder, p) == true)
+        bInsideBorder = true;
+    }
+  }
+
+  for(unsigned int it=0; it < rollOuts.size() && it < trajectoryCosts.size(); it++)
+  {
+    const vector<WayPoint>& path = rollOuts.at(it);
+    TrajectoryCost& tc = trajectoryCosts.at(it);
+    if(bInsideBorder)
+      tc.bBlocked = true;
+
+    if(path.size() < 2)
+      continue;
+
+    //walk the roll-out from the car, the first point within the critical lateral distance is the one the car meets
+    RelativeInfo car_info;
+    PlanningHelpers::GetRelativeInfo(path, currState, car_info);
+    GPSPoint prev = car_info.perp_point.pos;
+    double s = 0;
+    double min_clearance = DBL_MAX;
+    for(int i = car_info.iFront - 1; i < (int)path.size(); i++)
+    {
+      //the car position on the roll-out first, then the points ahead of it
+      const GPSPoint& p = i < car_info.iFront ? car_info.perp_point.pos : path.at(i).pos;
+      s += hypot(p.y - prev.y, p.x - prev.x);
+      prev = p;
+      if(s > params.minFollowingDistance)
+        break;
+
+      int iPoint = -1;
+      double clearance = m_DistanceField.GetClearance(p.x, p.y, iPoint);
+      if(clearance < min_clearance)
+        min_clearance = clearance;
+
+      if(clearance <= critical_lateral_distance)
+      {
+        //the obstacle point can be ahead of the roll-out point that found it, up to the clearance
+        const GPSPoint& obj_p = contourPoints.at(iPoint).pos;
+        double ahead = (obj_p.x - p.x) * cos(p.a) + (obj_p.y - p.y) * sin(p.a);
+        double longitudinalDist = s + ahead - critical_long_front_distance;
+        if(longitudinalDist >= -carInfo.length/1.5)
+          tc.bBlocked = true;
+
+        if(longitudinalDist != 0)
+          tc.longitudinal_cost += 1.0/fabs(longitudinalDist);
+
+        if(longitudinalDist >= -critical_long_front_distance && longitudinalDist < tc.closest_obj_distance)
+        {
+          tc.closest_obj_distance = longitudinalDist;
+          tc.closest_obj_velocity = contourPoints.at(iPoint).v;
+        }
+        break;
+      }
+    }
+
+    if(min_clearance > 0 && min_clearance <= m_LateralSkipDistance)
+      tc.lateral_cost += 1.0/min_clearance;
+  }
+}
+
 void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCosts(vector<TrajectoryCost>& trajectoryCosts,
     const vector<vector<vector<WayPoint> > >& rollOuts, const vector<vector<WayPoint> >& totalPaths,
     const WayPoint& currState, const vector<WayPoint>& contourPoints, const PlanningParams& params,
@@ -449,8 +532,7 @@ void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCosts(vector<Traject
   double critical_long_back_distance =  carInfo.length/2.0 + params.verticalSafetyDistance - carInfo.wheel_base/2.0;
   int iCostIndex = 0;
 
-  PlannerHNS::Mat3 invRotationMat(currState.pos.a-M_PI_2);
-  PlannerHNS::Mat3 invTranslationMat(currState.pos.x, currState.pos.y);
+  PlannerHNS::RigidTransform2D invTransform = PlannerHNS::RigidTransform2D::FromFrame(currState.pos.x, currState.pos.y, currState.pos.a-M_PI_2);
 
   double corner_slide_distance = critical_lateral_distance/2.0;
   double ratio_to_angle = corner_slide_distance/carInfo.max_steer_angle;
@@ -465,24 +547,6 @@ void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCosts(vector<Traject
   GPSPoint top_right(critical_lateral_distance - slide_distance, critical_long_front_distance,  currState.pos.z, 0);
   GPSPoint top_left(-critical_lateral_distance - slide_distance , critical_long_front_distance, currState.pos.z, 0);
 
-  bottom_left = invRotationMat*bottom_left;
-  bottom_left = invTranslationMat*bottom_left;
-
-  top_right = invRotationMat*top_right;
-  top_right = invTranslationMat*top_right;
-
-  bottom_right = invRotationMat*bottom_right;
-  bottom_right = invTranslationMat*bottom_right;
-
-  top_left = invRotationMat*top_left;
-  top_left = invTranslationMat*top_left;
-
-  top_right_car = invRotationMat*top_right_car;
-  top_right_car = invTranslationMat*top_right_car;
-
-  top_left_car = invRotationMat*top_left_car;
-  top_left_car = invTranslationMat*top_left_car;
-
   m_SafetyBorder.points.clear();
   m_SafetyBorder.points.push_back(bottom_left) ;
   m_SafetyBorder.points.push_back(bottom_right) ;
@@ -490,6 +554,7 @@ void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCosts(vector<Traject
   m_SafetyBorder.points.push_back(top_right) ;
   m_SafetyBorder.points.push_back(top_left) ;
   m_SafetyBorder.points.push_back(top_left_car) ;
+  invTransform.Apply(m_SafetyBorder.points);
 
   for(unsigned int il=0; il < rollOuts.size(); il++)
   {
@@ -764,8 +829,7 @@ void TrajectoryDynamicCosts::InitializeCosts(const vector<vector<WayPoint> >& ro
 
 void TrajectoryDynamicCosts::InitializeSafetyPolygon(const WayPoint& currState, const CAR_BASIC_INFO& carInfo, const VehicleState& vehicleState, const double& c_lateral_d, const double& c_long_front_d, const double& c_long_back_d)
 {
-  PlannerHNS::Mat3 invRotationMat(currState.pos.a-M_PI_2);
-  PlannerHNS::Mat3 invTranslationMat(currState.pos.x, currState.pos.y);
+  PlannerHNS::RigidTransform2D invTransform = PlannerHNS::RigidTransform2D::FromFrame(currState.pos.x, currState.pos.y, currState.pos.a-M_PI_2);
 
   double corner_slide_distance = c_lateral_d/2.0;
   double ratio_to_angle = corner_slide_distance/carInfo.max_steer_angle;
@@ -780,24 +844,6 @@ void TrajectoryDynamicCosts::InitializeSafetyPolygon(const WayPoint& currState,
   GPSPoint top_right(c_lateral_d - slide_distance, c_long_front_d,  currState.pos.z, 0);
   GPSPoint top_left(-c_lateral_d - slide_distance , c_long_front_d, currState.pos.z, 0);
 
-  bottom_left = invRotationMat*bottom_left;
-  bottom_left = invTranslationMat*bottom_left;
-
-  top_right = invRotationMat*top_right;
-  top_right = invTranslationMat*top_right;
-
-  bottom_right = invRotationMat*bottom_right;
-  bottom_right = invTranslationMat*bottom_right;
-
-  top_left = invRotationMat*top_left;
-  top_left = invTranslationMat*top_left;
-
-  top_right_car = invRotationMat*top_right_car;
-  top_right_car = invTranslationMat*top_right_car;
-
-  top_left_car = invRotationMat*top_left_car;
-  top_left_car = invTranslationMat*top_left_car;
-
   m_SafetyBorder.points.clear();
   m_SafetyBorder.points.push_back(bottom_left) ;
   m_SafetyBorder.points.push_back(bottom_right) ;
@@ -805,6 +851,7 @@ void TrajectoryDynamicCosts::InitializeSafetyPolygon(const WayPoint& currState,
   m_SafetyBorder.points.push_back(top_right) ;
   m_SafetyBorder.points.push_back(top_left) ;
   m_SafetyBorder.points.push_back(top_left_car) ;
+  invTransform.Apply(m_SafetyBorder.points);
 }
 
 void TrajectoryDynamicCosts::CalculateLateralAndLongitudinalCostsDynamic(const std::vector<PlannerHNS::DetectedObject>& obj_list, const vector<vector<WayPoint> >& rollOuts, const vector<WayPoint>& totalPaths,
@@ -0,0 +1,1418 @@
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+
+#include "op_planner/PlanningHelpers.h"
+#include "op_planner/MappingHelpers.h"
+#include "op_planner/MatrixOperations.h"
+#include "op_planner/PassiveDecisionMaker.h"
+#include "op_planner/BehaviorPrediction.h"
+#include "op_planner/PlannerCycleRecorder.h"
+#include "op_planner/RoadNetworkSnapshot.h"
+#include "op_planner/SimuDecisionMaker.h"
+#include "op_planner/TestPaths.h"
+#include "op_planner/TrajectoryDynamicCosts.h"
+#include <thread>
+
+class TestSuite : public ::testing::Test
+{
+public:
+  TestSuite() {}
+  ~TestSuite() {}
+};
+
+namespace
+{
+
+const unsigned int PREDICTION_TEST_SEED = 42;
+
+using PlannerHNS::TestPaths::CreateArcPath;
+
+void SetMapSpeed(std::vector<PlannerHNS::WayPoint>& path, const double& v)
+{
+  for(unsigned int i = 0; i < path.size(); i++)
+    path.at(i).v = v;
+}
+
+double MaxAcceleration(const std::vector<PlannerHNS::WayPoint>& path)
+{
+  double max_a = 0;
+  for(unsigned int i = 1; i < path.size(); i++)
+  {
+    double d = distance2points(path.at(i-1).pos, path.at(i).pos);
+    double a = (path.at(i).v * path.at(i).v - path.at(i-1).v * path.at(i-1).v) / (2.0 * d);
+    max_a = std::max(max_a, a);
+  }
+  return max_a;
+}
+
+double MaxDeceleration(const std::vector<PlannerHNS::WayPoint>& path)
+{
+  double max_a = 0;
+  for(unsigned int i = 1; i < path.size(); i++)
+  {
+    double d = distance2points(path.at(i-1).pos, path.at(i).pos);
+    double a = (path.at(i-1).v * path.at(i-1).v - path.at(i).v * path.at(i).v) / (2.0 * d);
+    max_a = std::max(max_a, a);
+  }
+  return max_a;
+}
+
+// One straight lane along the x axis, linked for the trajectory prediction
+void CreateStraightLaneMap(const int& n_points, PlannerHNS::RoadNetwork& map)
+{
+  map.roadSegments.push_back(PlannerHNS::RoadSegment());
+  PlannerHNS::Lane lane;
+  lane.id = 1;
+  lane.speed = 10;
+  lane.width = 3.5;
+  for(int i = 0; i < n_points; i++)
+  {
+    PlannerHNS::WayPoint p;
+    p.pos.x = i;
+    p.id = i + 1;
+    p.laneId = lane.id;
+    p.v = lane.speed;
+    if(i > 0)
+      p.fromIds.push_back(p.id - 1);
+    if(i + 1 < n_points)
+      p.toIds.push_back(p.id + 1);
+    lane.points.push_back(p);
+  }
+  map.roadSegments.at(0).Lanes.push_back(lane);
+  PlannerHNS::MappingHelpers::LinkLanesPointers(map);
+  PlannerHNS::MappingHelpers::LinkMissingBranchingWayPointsV2(map);
+}
+
+// Tracks one object driving along the lane at a constant speed, returns the ratio of steps that predict the expected
+// behavior and the average number of particles sampled per step
+double RunBehaviorPrediction(const int& min_particles, const int& max_particles, const double& speed,
+    const PlannerHNS::BEH_STATE_TYPE& expected_beh, double& avg_particles)
+{
+  PlannerHNS::RoadNetwork map;
+  CreateStraightLaneMap(300, map);
+
+  PlannerHNS::BehaviorPrediction prediction;
+  prediction.m_bParticleFilter = true;
+  prediction.m_bStepByStep = true;
+  prediction.m_MinParticlesNum = min_particles;
+  prediction.m_MaxParticlesNum = max_particles;
+  prediction.SetRandomSeed(PREDICTION_TEST_SEED);
+
+  PlannerHNS::DetectedObject obj;
+  obj.id = 1;
+  obj.center.pos.x = 10;
+  obj.center.pos.y = 0.1;
+  obj.center.v = speed;
+  obj.bDirection = true;
+  obj.bVelocity = true;
+  obj.l = 4;
+  obj.w = 2;
+  obj.acceleration_desc = speed > 0 ? 0 : -1;
+
+  const int n_warmup = 10;
+  const int n_steps = 100;
+  int n_correct = 0;
+  int n_particles = 0;
+  for(int i = 0; i < n_steps; i++)
+  {
+    std::vector<PlannerHNS::DetectedObject> obj_list(1, obj);
+    prediction.DoOneStep(obj_list, PlannerHNS::WayPoint(), 1.0, -3.0, map);
+    obj.center.pos.x += speed * 0.08; //step by step particle time
+
+    if(i < n_warmup || prediction.m_ParticleInfo_II.size() != 1)
+      continue;
+
+    PlannerHNS::ObjParticles* pParts = prediction.m_ParticleInfo_II.at(0);
+    for(unsigned int t = 0; t < pParts->m_TrajectoryTracker.size(); t++)
+    {
+      PlannerHNS::TrajectoryTracker* pTrack = pParts->m_TrajectoryTracker.at(t);
+      n_particles += pTrack->nTargetStop;
+      if(pTrack->beh == PlannerHNS::BEH_FORWARD_STATE)
+        n_particles += pTrack->nTargetForward;
+    }
+
+    if(pParts->best_beh_track != nullptr && pParts->best_beh_track->best_beh == expected_beh)
+      n_correct++;
+  }
+
+  avg_particles = (double)n_particles / (double)(n_steps - n_warmup);
+  return (double)n_correct / (double)(n_steps - n_warmup);
+}
+
+// Exposes the observation tracking steps of BehaviorPrediction
+class BehaviorPredictionSteps : public PlannerHNS::BehaviorPrediction
+{
+public:
+  using PlannerHNS::BehaviorPrediction::FilterObservations;
+  using PlannerHNS::BehaviorPrediction::ExtractTrajectoriesFromMap;
+};
+
+// Exposes the extracted global paths of SimuDecisionMaker
+class SimuDecisionMakerPaths : public PlannerHNS::SimuDecisionMaker
+{
+public:
+  using PlannerHNS::SimuDecisionMaker::m_TotalPath;
+  using PlannerHNS::SimuDecisionMaker::m_TotalPathClosePoints;
+};
+
+// FilterObservations as it was before the id index, by linear search
+void FilterObservationsLinear(const std::vector<PlannerHNS::DetectedObject>& obj_list,
+    std::vector<PlannerHNS::DetectedObject>& filtered_list)
+{
+  for(unsigned int i = 0; i < obj_list.size(); i++)
+  {
+    if(obj_list.at(i).t == PlannerHNS::SIDEWALK || obj_list.at(i).center.v < 1.0)
+      continue;
+
+    unsigned int ip = 0;
+    while(ip < filtered_list.size() && filtered_list.at(ip).id != obj_list.at(i).id)
+      ip++;
+    if(ip < filtered_list.size())
+      filtered_list.at(ip) = obj_list.at(i);
+    else
+      filtered_list.push_back(obj_list.at(i));
+  }
+
+  for(int ip = 0; ip < (int)filtered_list.size(); ip++)
+  {
+    bool bFound = false;
+    for(unsigned int ic = 0; ic < obj_list.size() && !bFound; ic++)
+      bFound = filtered_list.at(ip).id == obj_list.at(ic).id;
+    if(!bFound)
+    {
+      filtered_list.erase(filtered_list.begin() + ip);
+      ip--;
+    }
+  }
+}
+
+}  // namespace
+
+TEST(TestSuite, GenerateSpeedProfile_straight)
+{
+  std::vector<PlannerHNS::WayPoint> path = CreateArcPath(50, 1000, 0.5);
+  SetMapSpeed(path, -1);
+  PlannerHNS::PlanningParams params;
+  params.maxSpeed = 10;
+  PlannerHNS::CAR_BASIC_INFO car_info;
+  car_info.max_speed_forward = 8;
+
+  PlannerHNS::PlanningHelpers::GenerateSpeedProfile(path, params, car_info);
+
+  for(unsigned int i = 0; i < path.size(); i++)
+    ASSERT_NEAR(8.0, path.at(i).v, 1e-6);
+}
+
+TEST(TestSuite, GenerateSpeedProfile_mapSpeed)
+{
+  std::vector<PlannerHNS::WayPoint> path = CreateArcPath(50, 1000, 0.5);
+  SetMapSpeed(path, -1);
+  for(unsigned int i = 0; i < path.size() / 2; i++)
+    path.at(i).v = 2.0;
+
+  PlannerHNS::PlanningParams params;
+  params.maxSpeed = 10;
+  PlannerHNS::CAR_BASIC_INFO car_info;
+  car_info.max_speed_forward = 10;
+
+  PlannerHNS::PlanningHelpers::GenerateSpeedProfile(path, params, car_info);
+
+  ASSERT_NEAR(2.0, path.front().v, 1e-6);
+  ASSERT_NEAR(10.0, path.back().v, 1e-6);
+  ASSERT_LE(MaxAcceleration(path), fabs(car_info.max_acceleration) + 1e-6);
+
+  // a map speed of 0 is a limit, as in GenerateRecommendedSpeed
+  SetMapSpeed(path, 0);
+  PlannerHNS::PlanningHelpers::GenerateSpeedProfile(path, params, car_info);
+  for(unsigned int i = 0; i < path.size(); i++)
+    ASSERT_NEAR(0.0, path.at(i).v, 1e-6);
+}
+
+TEST(TestSuite, GenerateSpeedProfile_limits)
+{
+  const double radius = 10;
+  std::vector<PlannerHNS::WayPoint> path = CreateArcPath(60, radius, 0.25);
+  SetMapSpeed(path, -1);
+  PlannerHNS::PlanningParams params;
+  params.maxSpeed = 15;
+  PlannerHNS::CAR_BASIC_INFO car_info;
+  car_info.max_speed_forward = 15;
+  car_info.max_acceleration = 1.0;
+  car_info.max_deceleration = -2.0;
+  car_info.max_lateral_acceleration = 1.5;
+
+  PlannerHNS::PlanningHelpers::GenerateSpeedProfile(path, params, car_info);
+
+  ASSERT_LE(MaxAcceleration(path), 1.0 + 1e-6);
+  ASSERT_LE(MaxDeceleration(path), 2.0 + 1e-6);
+
+  double max_v = 0;
+  for(unsigned int i = 0; i < path.size(); i++)
+  {
+    ASSERT_LE(path.at(i).v, 15.0 + 1e-6);
+    max_v = std::max(max_v, path.at(i).v);
+
+    // points on the arc
+    if(path.at(i).pos.x > 60 + 0.5 && path.at(i).pos.y < radius - 0.5)
+      ASSERT_LE(path.at(i).v * path.at(i).v / radius, 1.5 * 1.05);
+  }
+
+  // 60 meters of straight line allows sqrt(2 * 1.0 * 60) before the arc
+  ASSERT_GT(max_v, sqrt(15 * 1.5));
+}
+
+TEST(TestSuite, GenerateSpeedProfile_stopAtEnd)
+{
+  std::vector<PlannerHNS::WayPoint> path = CreateArcPath(50, 1000, 0.5);
+  SetMapSpeed(path, -1);
+  path.back().v = 0;
+  PlannerHNS::PlanningParams params;
+  params.maxSpeed = 10;
+  PlannerHNS::CAR_BASIC_INFO car_info;
+  car_info.max_speed_forward = 10;
+
+  PlannerHNS::PlanningHelpers::GenerateSpeedProfile(path, params, car_info);
+
+  // the stop is reached within the deceleration limit instead of a jump to 0 at the last point
+  ASSERT_NEAR(0.0, path.back().v, 1e-6);
+  ASSERT_LE(MaxDeceleration(path), fabs(car_info.max_deceleration) + 1e-6);
+  ASSERT_NEAR(10.0, path.at(path.size()/2).v, 1e-6);
+}
+
+TEST(TestSuite, SmoothGlobalPathSpeed_limits)
+{
+  const double radius = 10;
+  std::vector<PlannerHNS::WayPoint> path = CreateArcPath(60, radius, 0.25);
+  SetMapSpeed(path, 10);
+  for(unsigned int i = path.size()/2; i < path.size(); i++)
+    path.at(i).v = 2;
+
+  PlannerHNS::PlanningHelpers::SmoothGlobalPathSpeed(path);
+
+  PlannerHNS::CAR_BASIC_INFO car_info;
+  ASSERT_LE(MaxAcceleration(path), fabs(car_info.max_acceleration) + 1e-6);
+  ASSERT_LE(MaxDeceleration(path), fabs(car_info.max_deceleration) + 1e-6);
+  ASSERT_NEAR(10.0, path.front().v, 1e-6);
+  ASSERT_NEAR(2.0, path.back().v, 1e-6);
+}
+
+TEST(TestSuite, GenerateSpeedProfile_compareRecommendedSpeed)
+{
+  const double radius = 10;
+  std::vector<PlannerHNS::WayPoint> path = CreateArcPath(60, radius, 0.25);
+  for(unsigned int i = 0; i < path.size(); i++)
+    path.at(i).v = 10;
+  std::vector<PlannerHNS::WayPoint> recommended_path = path;
+
+  PlannerHNS::PlanningParams params;
+  params.maxSpeed = 10;
+  PlannerHNS::CAR_BASIC_INFO car_info;
+  car_info.max_speed_forward = 10;
+
+  PlannerHNS::PlanningHelpers::GenerateSpeedProfile(path, params, car_info);
+  PlannerHNS::PlanningHelpers::GenerateRecommendedSpeed(recommended_path, car_info.max_speed_forward, params.speedProfileFactor);
+
+  ASSERT_EQ(path.size(), recommended_path.size());
+
+  // Same speed far from the curve, but only the new profile stays within the vehicle limits around it
+  ASSERT_LE(MaxAcceleration(path), fabs(car_info.max_acceleration) + 1e-6);
+  ASSERT_LE(MaxDeceleration(path), fabs(car_info.max_deceleration) + 1e-6);
+  ASSERT_LT(MaxAcceleration(path), MaxAcceleration(recommended_path));
+  ASSERT_LT(MaxDeceleration(path), MaxDeceleration(recommended_path));
+  ASSERT_NEAR(recommended_path.front().v, path.front().v, 1e-6);
+  ASSERT_NEAR(recommended_path.back().v, path.back().v, 1e-6);
+
+  for(unsigned int i = 0; i < path.size(); i++)
+  {
+    if(path.at(i).pos.x > 60 + 0.5 && path.at(i).pos.y < radius - 0.5)
+      ASSERT_LE(path.at(i).v * path.at(i).v / radius, car_info.max_lateral_acceleration * 1.05);
+  }
+}
+
+TEST(TestSuite, FixPathDensity_uniformPath)
+{
+  std::vector<PlannerHNS::WayPoint> path;
+  PlannerHNS::WayPoint p;
+  for(unsigned int i = 0; i < 20; i++)
+  {
+    p.pos.x = i;
+    p.pos.y = i;
+    path.push_back(p);
+  }
+
+  std::vector<PlannerHNS::WayPoint> fixed_path;
+  PlannerHNS::PlanningHelpers::FixPathDensity(path, M_SQRT2 / 4.0, fixed_path);
+
+  ASSERT_EQ((path.size() - 1) * 4 + 1, fixed_path.size());
+  for(unsigned int i = 0; i < path.size(); i++)
+  {
+    ASSERT_NEAR(path.at(i).pos.x, fixed_path.at(i*4).pos.x, 1e-6);
+    ASSERT_NEAR(path.at(i).pos.y, fixed_path.at(i*4).pos.y, 1e-6);
+  }
+}
+
+TEST(TestSuite, FixPathDensity_irregularPath)
+{
+  std::vector<PlannerHNS::WayPoint> path;
+  PlannerHNS::WayPoint p;
+  const double steps[] = {0.1, 0.7, 2.3, 0.05, 1.4, 0.0, 3.1, 0.6};
+  for(unsigned int i = 0; i < 8; i++)
+  {
+    p.pos.x += steps[i];
+    p.v = i;
+    path.push_back(p);
+  }
+
+  std::vector<PlannerHNS::WayPoint> fixed_path;
+  PlannerHNS::PlanningHelpers::FixPathDensity(path, 0.5, fixed_path);
+  std::vector<PlannerHNS::WayPoint> in_place_path = path;
+  PlannerHNS::PlanningHelpers::FixPathDensity(in_place_path, 0.5);
+
+  // path from x = 0.1 to x = 8.25
+  ASSERT_EQ(17, fixed_path.size());
+  ASSERT_EQ(fixed_path.size(), in_place_path.size());
+  for(unsigned int i = 0; i < fixed_path.size(); i++)
+  {
+    ASSERT_NEAR(0.1 + i * 0.5, fixed_path.at(i).pos.x, 1e-9);
+    ASSERT_NEAR(fixed_path.at(i).pos.x, in_place_path.at(i).pos.x, 1e-12);
+    ASSERT_LE(fixed_path.at(i).v, 7.0);
+  }
+
+  // x = 2.1 is at 0.6 of the segment from 0.8 (v = 1) to 3.1 (v = 2)
+  ASSERT_NEAR(1.0 + 1.3 / 2.3, fixed_path.at(4).v, 1e-9);
+}
+
+TEST(TestSuite, FixPathDensity_keepAttributes)
+{
+  std::vector<PlannerHNS::WayPoint> path;
+  PlannerHNS::WayPoint p;
+  for(unsigned int i = 0; i < 10; i++)
+  {
+    p.pos.x = i;
+    p.id = 100 + i;
+    p.laneId = i < 5 ? 1 : 2;
+    p.stopLineID = i == 7 ? 3 : -1;
+    path.push_back(p);
+  }
+
+  // same density, every input point comes out unchanged
+  std::vector<PlannerHNS::WayPoint> fixed_path;
+  PlannerHNS::PlanningHelpers::FixPathDensity(path, 1.0, fixed_path);
+  ASSERT_EQ(path.size(), fixed_path.size());
+  for(unsigned int i = 0; i < path.size(); i++)
+  {
+    ASSERT_EQ(path.at(i).id, fixed_path.at(i).id);
+    ASSERT_EQ(path.at(i).laneId, fixed_path.at(i).laneId);
+    ASSERT_EQ(path.at(i).stopLineID, fixed_path.at(i).stopLineID);
+  }
+
+  // denser, the samples on input points are copies of them, the others take the segment start
+  PlannerHNS::PlanningHelpers::FixPathDensity(path, 0.25, fixed_path);
+  ASSERT_EQ((path.size() - 1) * 4 + 1, fixed_path.size());
+  for(unsigned int i = 0; i < fixed_path.size(); i++)
+  {
+    const PlannerHNS::WayPoint& src = path.at(i / 4);
+    ASSERT_EQ(src.id, fixed_path.at(i).id);
+    ASSERT_EQ(src.laneId, fixed_path.at(i).laneId);
+    ASSERT_EQ(src.stopLineID, fixed_path.at(i).stopLineID);
+  }
+}
+
+TEST(TestSuite, ExtractPartFromPointToDistance_window)
+{
+  std::vector<PlannerHNS::WayPoint> path;
+  for(unsigned int i = 0; i < 200; i++)
+  {
+    PlannerHNS::WayPoint p(i * 0.75, 0.02 * i * i, 0, 0);
+    p.id = i;
+    path.push_back(p);
+  }
+  PlannerHNS::PlanningHelpers::CalcAngleAndCost(path);
+
+  //range resampling is the same as resampling a copy of the range
+  std::vector<PlannerHNS::WayPoint> part(path.begin() + 30, path.begin() + 91);
+  std::vector<PlannerHNS::WayPoint> fixed_copy, fixed_range;
+  PlannerHNS::PlanningHelpers::FixPathDensity(part, 0.5, fixed_copy);
+  PlannerHNS::PlanningHelpers::FixPathDensity(path, 30, 90, 0.5, fixed_range);
+  ASSERT_EQ(fixed_copy.size(), fixed_range.size());
+  for(unsigned int i = 0; i < fixed_copy.size(); i++)
+  {
+    ASSERT_EQ(fixed_copy.at(i).pos.x, fixed_range.at(i).pos.x);
+    ASSERT_EQ(fixed_copy.at(i).pos.y, fixed_range.at(i).pos.y);
+  }
+
+  //more than 10 meters back from the point after the closest one, and more than minDistance on from the closest one
+  PlannerHNS::WayPoint pos = path.at(100);
+  pos.pos.y += 0.3;
+  std::vector<PlannerHNS::WayPoint> extracted, extracted_warm;
+  PlannerHNS::PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(path, pos, 20, 0.5, extracted);
+  PlannerHNS::PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(path, pos, 20, 0.5, extracted_warm, 90);
+  ASSERT_GT(extracted.size(), 2);
+  ASSERT_EQ(extracted.size(), extracted_warm.size());
+  EXPECT_EQ(extracted.front().id, extracted_warm.front().id);
+
+  int close_index = PlannerHNS::PlanningHelpers::GetClosestNextPointIndexDirectionFast(path, pos);
+  PlannerHNS::ClosestPointInfo close_info;
+  close_info.index = 91;
+  close_info.distance = 0.3;
+  PlannerHNS::PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(path, pos, 20, 0.5, extracted_warm, close_info);
+  EXPECT_EQ(close_info.index, close_index);
+  ASSERT_EQ(extracted.size(), extracted_warm.size());
+  EXPECT_EQ(extracted.front().id, extracted_warm.front().id);
+  int first = extracted.front().id;
+  ASSERT_LT(first, close_index);
+  EXPECT_EQ(extracted.front().pos.x, path.at(first).pos.x);
+  double back = 0;
+  for(int i = first; i <= close_index; i++)
+    back += distance2points(path.at(i).pos, path.at(i + 1).pos);
+  EXPECT_GT(back, 10);
+  EXPECT_LT(back - distance2points(path.at(first).pos, path.at(first + 1).pos), 10);
+  double ahead = extracted.back().cost - extracted.front().cost - (path.at(close_index).cost - path.at(first).cost);
+  EXPECT_GT(ahead, 20 - 0.5);
+
+  for(unsigned int i = 1; i + 1 < extracted.size(); i++)
+    EXPECT_NEAR(distance2points(extracted.at(i - 1).pos, extracted.at(i).pos), 0.5, 1e-6);
+}
+
+TEST(TestSuite, PassivePathContext_compareHelpers)
+{
+  std::vector<PlannerHNS::WayPoint> path = CreateArcPath(40, 20, 0.5);
+  PlannerHNS::Lane lane;
+  PlannerHNS::StopLine stop_line;
+  stop_line.id = 7;
+  stop_line.trafficLightID = 3;
+  stop_line.points.push_back(PlannerHNS::GPSPoint(30, 0, 0, 0));
+  lane.stopLines.push_back(stop_line);
+  for(unsigned int i = 0; i < path.size(); i++)
+  {
+    path.at(i).pLane = &lane;
+    if(path.at(i).pos.x > 29 && path.at(i).pos.x < 31 && path.at(i).pos.y == 0)
+      path.at(i).stopLineID = 7;
+  }
+  path.at(150).actionCost.push_back(std::make_pair(PlannerHNS::LEFT_TURN_ACTION, 0.0));
+  PlannerHNS::PlanningHelpers::CalcAngleAndCost(path);
+
+  PlannerHNS::PassivePathContext context;
+  context.Init(path);
+
+  for(unsigned int i = 0; i < path.size(); i += 7)
+  {
+    PlannerHNS::WayPoint pose = path.at(i);
+    pose.pos.y += 0.3;
+    PlannerHNS::RelativeInfo info;
+    PlannerHNS::PlanningHelpers::GetRelativeInfo(path, pose, info);
+
+    int stop_line_id = 0, stop_sign_id = 0, traffic_light_id = 0;
+    int expected_stop_line_id = 0, expected_stop_sign_id = 0, expected_traffic_light_id = 0;
+    double d = context.GetDistanceToClosestStopLine(info, 0, stop_line_id, stop_sign_id, traffic_light_id);
+    double expected_d = PlannerHNS::PlanningHelpers::GetDistanceToClosestStopLineAndCheck(path, pose, 0,
+        expected_stop_line_id, expected_stop_sign_id, expected_traffic_light_id);
+    ASSERT_NEAR(d, expected_d, 1e-9) << "Stop line distance at waypoint " << i;
+    ASSERT_EQ(stop_line_id, expected_stop_line_id);
+    ASSERT_EQ(traffic_light_id, expected_traffic_light_id);
+
+    for(double search = 10; search < 100; search += 10)
+      ASSERT_EQ(context.GetIndicator(path, info, search), PlannerHNS::PlanningHelpers::GetIndicatorsFromPath(path, pose, search))
+        << "Indicator at waypoint " << i << ", search distance " << search;
+  }
+}
+
+TEST(TestSuite, PassiveDecisionMaker_warmStart)
+{
+  std::vector<PlannerHNS::WayPoint> path = CreateArcPath(40, 20, 0.5);
+  PlannerHNS::PlanningHelpers::CalcAngleAndCost(path);
+  for(unsigned int i = 0; i < path.size(); i++)
+    path.at(i).v = 5;
+
+  PlannerHNS::CAR_BASIC_INFO car_info;
+  car_info.max_deceleration = -3;
+  car_info.length = 4;
+  car_info.wheel_base = 3;
+
+  PlannerHNS::PassivePathContext context;
+  context.Init(path);
+  PlannerHNS::PassiveDecisionMaker decision_maker;
+
+  PlannerHNS::WayPoint warm_pose = path.at(2);
+  warm_pose.pos.y += 0.5;
+  warm_pose.v = 5;
+  PlannerHNS::WayPoint cold_pose = warm_pose;
+  int path_index = -1;
+  for(int step = 0; step < 150; step++)
+  {
+    PlannerHNS::ParticleInfo warm = decision_maker.MoveStepSimple(0.1, warm_pose, path, context, path_index, car_info);
+    PlannerHNS::ParticleInfo cold = decision_maker.MoveStepSimple(0.1, cold_pose, path, car_info);
+    ASSERT_EQ(warm.state, cold.state) << "Step " << step;
+    ASSERT_EQ(warm.indicator, cold.indicator) << "Step " << step;
+    ASSERT_DOUBLE_EQ(warm.vel, cold.vel) << "Step " << step;
+    ASSERT_NEAR(warm_pose.pos.x, cold_pose.pos.x, 1e-9) << "Step " << step;
+    ASSERT_NEAR(warm_pose.pos.y, cold_pose.pos.y, 1e-9) << "Step " << step;
+  }
+
+  // the particle followed the path through the curve
+  EXPECT_GT(warm_pose.pos.y, 10);
+}
+
+TEST(TestSuite, PlannerCycleRecorder_roundTrip)
+{
+  PlannerHNS::Lane lane;
+  lane.id = 12;
+  lane.speed = 8.5;
+  PlannerHNS::StopLine stop_line;
+  stop_line.id = 3;
+  stop_line.trafficLightID = 4;
+  stop_line.points.push_back(PlannerHNS::GPSPoint(10, 1, 0, 0));
+  lane.stopLines.push_back(stop_line);
+
+  PlannerHNS::PlannerCycle cycle;
+  cycle.dt = 0.1;
+  cycle.currPose = PlannerHNS::WayPoint(1, 2, 3, 0.5);
+  cycle.vehicleState.speed = 4.2;
+  cycle.params.maxSpeed = 11;
+  cycle.carInfo.wheel_base = 2.9;
+  cycle.predictionParams.predictionDistance = 40;
+  cycle.bNewGlobalPath = true;
+  cycle.globalPaths.push_back(CreateArcPath(20, 10, 1));
+  for(unsigned int i = 0; i < cycle.globalPaths.at(0).size(); i++)
+    cycle.globalPaths.at(0).at(i).pLane = &lane;
+  cycle.globalPaths.at(0).at(5).stopLineID = 3;
+  cycle.globalPaths.at(0).at(6).actionCost.push_back(std::make_pair(PlannerHNS::LEFT_TURN_ACTION, 1.5));
+  cycle.rollOuts.push_back(cycle.globalPaths);
+  cycle.decisionRollOuts = cycle.globalPaths;
+  PlannerHNS::TrafficLight light;
+  light.id = 4;
+  light.lightState = PlannerHNS::RED_LIGHT;
+  light.laneIds.push_back(12);
+  cycle.trafficLights.push_back(light);
+  PlannerHNS::DetectedObject obj;
+  obj.id = 9;
+  obj.label = "car";
+  obj.contour.push_back(PlannerHNS::GPSPoint(5, 5, 0, 0));
+  obj.predTrajectories.push_back(CreateArcPath(5, 10, 1));
+  cycle.predictedObjects.push_back(obj);
+  cycle.bHasBehavior = true;
+  cycle.behavior.state = PlannerHNS::TRAFFIC_LIGHT_STOP_STATE;
+  cycle.behavior.maxVelocity = 2.5;
+
+  std::string file_name = testing::TempDir() + "planner_cycles.bin";
+  PlannerHNS::PlannerCycleRecorder recorder;
+  ASSERT_TRUE(recorder.Open(file_name));
+  ASSERT_TRUE(recorder.Write(cycle));
+  cycle.dt = 0.2;
+  ASSERT_TRUE(recorder.Write(cycle));
+  recorder.Close();
+
+  PlannerHNS::PlannerCycleReader reader;
+  ASSERT_TRUE(reader.Open(file_name));
+  PlannerHNS::PlannerCycle first, second, third;
+  ASSERT_TRUE(reader.Read(first));
+  ASSERT_TRUE(reader.Read(second));
+  ASSERT_FALSE(reader.Read(third));
+
+  EXPECT_DOUBLE_EQ(first.dt, 0.1);
+  EXPECT_DOUBLE_EQ(second.dt, 0.2);
+  EXPECT_DOUBLE_EQ(first.currPose.pos.a, 0.5);
+  EXPECT_DOUBLE_EQ(first.vehicleState.speed, 4.2);
+  EXPECT_DOUBLE_EQ(first.params.maxSpeed, 11);
+  EXPECT_DOUBLE_EQ(first.carInfo.wheel_base, 2.9);
+  EXPECT_DOUBLE_EQ(first.predictionParams.predictionDistance, 40);
+  EXPECT_TRUE(first.bNewGlobalPath);
+  ASSERT_EQ(first.globalPaths.size(), 1);
+  ASSERT_EQ(first.globalPaths.at(0).size(), cycle.globalPaths.at(0).size());
+  ASSERT_EQ(first.rollOuts.size(), 1);
+  ASSERT_EQ(first.decisionRollOuts.size(), 1);
+  for(unsigned int i = 0; i < first.globalPaths.at(0).size(); i++)
+  {
+    EXPECT_DOUBLE_EQ(first.globalPaths.at(0).at(i).pos.x, cycle.globalPaths.at(0).at(i).pos.x);
+    EXPECT_DOUBLE_EQ(first.globalPaths.at(0).at(i).pos.y, cycle.globalPaths.at(0).at(i).pos.y);
+  }
+  EXPECT_EQ(first.globalPaths.at(0).at(5).stopLineID, 3);
+  ASSERT_EQ(first.globalPaths.at(0).at(6).actionCost.size(), 1);
+  EXPECT_EQ(first.globalPaths.at(0).at(6).actionCost.at(0).first, PlannerHNS::LEFT_TURN_ACTION);
+
+  // all recorded waypoints point to the same restored lane, with its stop lines
+  PlannerHNS::Lane* pLane = first.globalPaths.at(0).at(0).pLane;
+  ASSERT_NE(pLane, nullptr);
+  EXPECT_EQ(pLane->id, 12);
+  EXPECT_DOUBLE_EQ(pLane->speed, 8.5);
+  ASSERT_EQ(pLane->stopLines.size(), 1);
+  EXPECT_EQ(pLane->stopLines.at(0).trafficLightID, 4);
+  EXPECT_EQ(first.rollOuts.at(0).at(0).at(3).pLane, pLane);
+  EXPECT_EQ(first.decisionRollOuts.at(0).at(3).pLane, pLane);
+
+  ASSERT_EQ(first.trafficLights.size(), 1);
+  EXPECT_EQ(first.trafficLights.at(0).lightState, PlannerHNS::RED_LIGHT);
+  EXPECT_EQ(first.trafficLights.at(0).laneIds, light.laneIds);
+  ASSERT_EQ(first.predictedObjects.size(), 1);
+  EXPECT_EQ(first.predictedObjects.at(0).label, "car");
+  EXPECT_EQ(first.predictedObjects.at(0).contour.size(), 1);
+  EXPECT_EQ(first.predictedObjects.at(0).predTrajectories.at(0).size(), obj.predTrajectories.at(0).size());
+  EXPECT_FALSE(first.bHasTrajectoryCost);
+  EXPECT_TRUE(first.bHasBehavior);
+  EXPECT_EQ(first.behavior.state, PlannerHNS::TRAFFIC_LIGHT_STOP_STATE);
+  EXPECT_DOUBLE_EQ(first.behavior.maxVelocity, 2.5);
+}
+
+TEST(TestSuite, BehaviorPrediction_trackObservations)
+{
+  PlannerHNS::RoadNetwork map;
+  CreateStraightLaneMap(300, map);
+  BehaviorPredictionSteps prediction;
+
+  // random observation lists with repeated ids, sidewalk and slow objects
+  srand(7);
+  std::vector<PlannerHNS::DetectedObject> filtered, filtered_linear;
+  for(int step = 0; step < 200; step++)
+  {
+    std::vector<PlannerHNS::DetectedObject> obj_list(rand() % 12);
+    for(unsigned int i = 0; i < obj_list.size(); i++)
+    {
+      obj_list.at(i).id = rand() % 15;
+      obj_list.at(i).t = (rand() % 10 == 0) ? PlannerHNS::SIDEWALK : PlannerHNS::CAR;
+      obj_list.at(i).center.v = (rand() % 5) * 0.5;
+      obj_list.at(i).center.pos.x = step * 100 + i;
+    }
+
+    prediction.FilterObservations(obj_list, map, filtered);
+    FilterObservationsLinear(obj_list, filtered_linear);
+    ASSERT_EQ(filtered_linear.size(), filtered.size()) << "step " << step;
+    for(unsigned int i = 0; i < filtered.size(); i++)
+    {
+      ASSERT_EQ(filtered_linear.at(i).id, filtered.at(i).id) << "step " << step;
+      ASSERT_EQ(filtered_linear.at(i).center.pos.x, filtered.at(i).center.pos.x) << "step " << step;
+    }
+  }
+
+  // tracked objects are kept by id, each old object is reused at most once
+  std::vector<PlannerHNS::DetectedObject> obj_list(3);
+  for(unsigned int i = 0; i < obj_list.size(); i++)
+  {
+    obj_list.at(i).id = i + 1;
+    obj_list.at(i).center.pos.x = 10 + i * 10;
+    obj_list.at(i).center.v = 5;
+  }
+  std::vector<PlannerHNS::ObjParticles*> tracked;
+  prediction.ExtractTrajectoriesFromMap(obj_list, map, tracked);
+  ASSERT_EQ(tracked.size(), 3);
+  std::vector<PlannerHNS::ObjParticles*> first_tracked = tracked;
+
+  const int next_ids[] = {3, 1, 1, 5};
+  obj_list.resize(4);
+  for(unsigned int i = 0; i < obj_list.size(); i++)
+  {
+    obj_list.at(i).id = next_ids[i];
+    obj_list.at(i).center.pos.x = 50 + i;
+  }
+  prediction.ExtractTrajectoriesFromMap(obj_list, map, tracked);
+  ASSERT_EQ(tracked.size(), 4);
+  EXPECT_EQ(tracked.at(0), first_tracked.at(2));
+  EXPECT_EQ(tracked.at(1), first_tracked.at(0));
+  for(unsigned int i = 2; i < tracked.size(); i++)
+    for(unsigned int j = 0; j < first_tracked.size(); j++)
+      EXPECT_NE(tracked.at(i), first_tracked.at(j));
+  for(unsigned int i = 0; i < tracked.size(); i++)
+  {
+    EXPECT_EQ(tracked.at(i)->obj.id, next_ids[i]);
+    EXPECT_DOUBLE_EQ(tracked.at(i)->obj.center.pos.x, 50 + i);
+  }
+
+  obj_list.clear();
+  prediction.ExtractTrajectoriesFromMap(obj_list, map, tracked);
+  EXPECT_EQ(tracked.size(), 0);
+}
+
+TEST(TestSuite, BehaviorPrediction_recordedSeed)
+{
+  PlannerHNS::RoadNetwork map;
+  CreateStraightLaneMap(300, map);
+
+  PlannerHNS::DetectedObject obj;
+  obj.id = 1;
+  obj.center.pos.x = 10;
+  obj.center.pos.y = 0.1;
+  obj.center.v = 5;
+  obj.bDirection = true;
+  obj.bVelocity = true;
+  obj.l = 4;
+  obj.w = 2;
+  std::vector<PlannerHNS::DetectedObject> obj_list(1, obj);
+
+  std::string file_name = testing::TempDir() + "prediction_cycles.bin";
+  PlannerHNS::PlannerCycleRecorder recorder;
+  ASSERT_TRUE(recorder.Open(file_name));
+
+  PlannerHNS::BehaviorPrediction prediction;
+  prediction.m_bParticleFilter = true;
+  prediction.m_bStepByStep = true;
+  prediction.SetRandomSeed(1234);
+  prediction.SetCycleRecorder(&recorder);
+  std::vector<double> particles_x;
+  for(int i = 0; i < 5; i++)
+  {
+    prediction.DoOneStep(obj_list, PlannerHNS::WayPoint(), 1.0, -3.0, map);
+    ASSERT_EQ(prediction.m_ParticleInfo_II.size(), 1);
+    PlannerHNS::TrajectoryTracker* pTrack = prediction.m_ParticleInfo_II.at(0)->m_TrajectoryTracker.at(0);
+    for(unsigned int j = 0; j < pTrack->m_ForwardPart.size(); j++)
+      particles_x.push_back(pTrack->m_ForwardPart.at(j).pose.pos.x);
+  }
+  recorder.Close();
+  ASSERT_GT(particles_x.size(), 0);
+
+  PlannerHNS::PlannerCycleReader reader;
+  ASSERT_TRUE(reader.Open(file_name));
+  std::vector<PlannerHNS::PlannerCycle> cycles;
+  PlannerHNS::PlannerCycle cycle;
+  while(reader.Read(cycle))
+    cycles.push_back(cycle);
+  ASSERT_EQ(cycles.size(), 5);
+  EXPECT_EQ(cycles.front().predictionParams.randomSeed, 1234);
+  EXPECT_NE(cycles.at(1).predictionParams.randomSeed, cycles.at(0).predictionParams.randomSeed);
+  EXPECT_TRUE(cycles.front().predictionParams.bParticleFilter);
+  EXPECT_TRUE(cycles.front().predictionParams.bStepByStep);
+  ASSERT_EQ(cycles.front().detectedObjects.size(), 1);
+  ASSERT_EQ(cycles.front().predictedObjects.size(), 1);
+  EXPECT_GT(cycles.front().predictedObjects.front().predTrajectories.size(), 0);
+
+  // a replay seeded per cycle from the recording samples the same particles and predicts the same trajectories
+  PlannerHNS::BehaviorPrediction replay;
+  replay.m_bParticleFilter = cycles.front().predictionParams.bParticleFilter;
+  replay.m_bStepByStep = cycles.front().predictionParams.bStepByStep;
+  std::vector<double> replayed_x;
+  for(unsigned int i = 0; i < cycles.size(); i++)
+  {
+    const PlannerHNS::PlannerCycle& c = cycles.at(i);
+    replay.SetRandomSeed(c.predictionParams.randomSeed);
+    replay.DoOneStep(c.detectedObjects, c.currPose, c.predictionParams.minSpeed, c.predictionParams.maxDeceleration, map);
+    EXPECT_EQ(replay.GetCycleSeed(), c.predictionParams.randomSeed);
+    ASSERT_EQ(replay.m_ParticleInfo_II.size(), c.predictedObjects.size());
+    const std::vector<std::vector<PlannerHNS::WayPoint> >& replayed_paths = replay.m_ParticleInfo_II.at(0)->obj.predTrajectories;
+    const std::vector<std::vector<PlannerHNS::WayPoint> >& recorded_paths = c.predictedObjects.at(0).predTrajectories;
+    ASSERT_EQ(replayed_paths.size(), recorded_paths.size());
+    for(unsigned int t = 0; t < replayed_paths.size(); t++)
+    {
+      ASSERT_EQ(replayed_paths.at(t).size(), recorded_paths.at(t).size());
+      for(unsigned int j = 0; j < replayed_paths.at(t).size(); j++)
+        ASSERT_DOUBLE_EQ(replayed_paths.at(t).at(j).pos.x, recorded_paths.at(t).at(j).pos.x);
+    }
+
+    PlannerHNS::TrajectoryTracker* pTrack = replay.m_ParticleInfo_II.at(0)->m_TrajectoryTracker.at(0);
+    for(unsigned int j = 0; j < pTrack->m_ForwardPart.size(); j++)
+      replayed_x.push_back(pTrack->m_ForwardPart.at(j).pose.pos.x);
+  }
+
+  ASSERT_EQ(particles_x.size(), replayed_x.size());
+  for(unsigned int i = 0; i < particles_x.size(); i++)
+    ASSERT_DOUBLE_EQ(particles_x.at(i), replayed_x.at(i));
+}
+
+TEST(TestSuite, OccupancyToGridMap_batchQueries)
+{
+  PlannerHNS::OccupancyToGridMap grid(40, 30, 0.5, PlannerHNS::WayPoint(100, 50, 0, 0.7));
+  std::vector<int> data(grid.width * grid.length);
+  for(unsigned int i = 0; i < data.size(); i++)
+    data.at(i) = (i * 7919) % 13 == 0 ? 0 : 100;
+
+  //points inside, just outside and far outside the grid
+  std::vector<PlannerHNS::GPSPoint> points;
+  for(int i = -10; i < 60; i++)
+  {
+    for(int j = -10; j < 50; j++)
+    {
+      PlannerHNS::GPSPoint p(i * 0.37, j * 0.41, 0, 0);
+      PlannerHNS::Mat3 rotationMat(grid.center.pos.a);
+      PlannerHNS::Mat3 translationMat(grid.center.pos.x, grid.center.pos.y);
+      points.push_back(translationMat * (rotationMat * p));
+    }
+  }
+
+  std::vector<int> values;
+  grid.GetCellValuesFromPoints(points, data, values, -1);
+  ASSERT_EQ(values.size(), points.size());
+
+  PlannerHNS::Mat3 rotationMat(- grid.center.pos.a);
+  PlannerHNS::Mat3 translationMat(-grid.center.pos.x, -grid.center.pos.y);
+  int nInside = 0;
+  for(unsigned int i = 0; i < points.size(); i++)
+  {
+    PlannerHNS::GPSPoint relative_point = rotationMat * (translationMat * points.at(i));
+    int cell_value = -1;
+    if(!grid.GetCellIndexFromPoint(relative_point, data, cell_value))
+      cell_value = -1;
+    else
+      nInside++;
+    EXPECT_EQ(values.at(i), cell_value) << "point " << i;
+  }
+  EXPECT_GT(nInside, 0);
+  EXPECT_LT(nInside, (int)points.size());
+
+  //dilation against a brute force square neighbourhood
+  const int radius = 2;
+  std::vector<int> dilated;
+  grid.DilateCells(data, 0, radius, dilated);
+  ASSERT_EQ(dilated.size(), data.size());
+  for(int r = 0; r < grid.length; r++)
+  {
+    for(int c = 0; c < grid.width; c++)
+    {
+      bool bOccupied = false;
+      for(int dr = -radius; dr <= radius; dr++)
+        for(int dc = -radius; dc <= radius; dc++)
+          if(r+dr >= 0 && r+dr < grid.length && c+dc >= 0 && c+dc < grid.width && data.at((r+dr)*grid.width + c+dc) == 0)
+            bOccupied = true;
+      EXPECT_EQ(dilated.at(r*grid.width + c), bOccupied ? 0 : data.at(r*grid.width + c));
+    }
+  }
+}
+
+TEST(TestSuite, RigidTransform2D_compareMat3)
+{
+  const double eps = 1e-9;
+  PlannerHNS::WayPoint frame(12.5, -7.25, 0, 2.3);
+  PlannerHNS::WayPoint other(-3.0, 4.0, 0, -0.7);
+
+  PlannerHNS::Mat3 rotationMat(-frame.pos.a);
+  PlannerHNS::Mat3 translationMat(-frame.pos.x, -frame.pos.y);
+  PlannerHNS::Mat3 invRotationMat(frame.pos.a);
+  PlannerHNS::Mat3 invTranslationMat(frame.pos.x, frame.pos.y);
+  PlannerHNS::Mat3 otherRotationMat(other.pos.a);
+  PlannerHNS::Mat3 otherTranslationMat(other.pos.x, other.pos.y);
+
+  PlannerHNS::RigidTransform2D transform = PlannerHNS::RigidTransform2D::ToFrame(frame.pos.x, frame.pos.y, frame.pos.a);
+  PlannerHNS::RigidTransform2D invTransform = PlannerHNS::RigidTransform2D::FromFrame(frame.pos.x, frame.pos.y, frame.pos.a);
+  PlannerHNS::RigidTransform2D otherTransform = PlannerHNS::RigidTransform2D::FromFrame(other.pos.x, other.pos.y, other.pos.a);
+  PlannerHNS::RigidTransform2D composed = transform * otherTransform;
+
+  std::vector<PlannerHNS::GPSPoint> points;
+  for(int i = -5; i <= 5; i++)
+    points.push_back(PlannerHNS::GPSPoint(i * 3.1, i * i * 0.7 - 4.0, 1.5, 0.3));
+
+  std::vector<PlannerHNS::GPSPoint> batch_points = points;
+  transform.Apply(batch_points);
+
+  for(unsigned int i = 0; i < points.size(); i++)
+  {
+    const PlannerHNS::GPSPoint& p = points.at(i);
+    PlannerHNS::GPSPoint expected = rotationMat * (translationMat * p);
+
+    PlannerHNS::GPSPoint local = transform * p;
+    EXPECT_NEAR(local.x, expected.x, eps);
+    EXPECT_NEAR(local.y, expected.y, eps);
+    EXPECT_EQ(local.z, p.z);
+    EXPECT_EQ(local.a, p.a);
+
+    EXPECT_NEAR(batch_points.at(i).x, expected.x, eps);
+    EXPECT_NEAR(batch_points.at(i).y, expected.y, eps);
+    EXPECT_EQ(batch_points.at(i).z, p.z);
+
+    PlannerHNS::GPSPoint global = invTranslationMat * (invRotationMat * p);
+    PlannerHNS::GPSPoint from_local = invTransform * p;
+    EXPECT_NEAR(from_local.x, global.x, eps);
+    EXPECT_NEAR(from_local.y, global.y, eps);
+
+    PlannerHNS::GPSPoint back = transform.Inverse() * local;
+    EXPECT_NEAR(back.x, p.x, eps);
+    EXPECT_NEAR(back.y, p.y, eps);
+
+    PlannerHNS::GPSPoint chained = rotationMat * (translationMat * (otherTranslationMat * (otherRotationMat * p)));
+    PlannerHNS::GPSPoint composed_p = composed * p;
+    EXPECT_NEAR(composed_p.x, chained.x, eps);
+    EXPECT_NEAR(composed_p.y, chained.y, eps);
+  }
+}
+
+TEST(TestSuite, RoadNetworkSnapshot_layers)
+{
+  std::shared_ptr<PlannerHNS::RoadNetwork> pMap = std::make_shared<PlannerHNS::RoadNetwork>();
+  CreateStraightLaneMap(30, *pMap);
+  PlannerHNS::RoadNetwork inplace_map = *pMap;
+
+  PlannerHNS::VersionedRoadNetwork versioned_map;
+  versioned_map.SetMap(pMap);
+  std::shared_ptr<const PlannerHNS::RoadNetworkSnapshot> pBefore = versioned_map.GetSnapshot();
+
+  PlannerHNS::WayPoint center;
+  PlannerHNS::OccupancyToGridMap grid(10, 4, 1.0, center);
+  std::vector<int> data(grid.width * grid.length, 0);
+
+  std::vector<PlannerHNS::WayPoint*> updated_list;
+  PlannerHNS::MappingHelpers::UpdateMapWithOccupancyGrid(grid, data, inplace_map, updated_list);
+  std::vector<int> updated_ids;
+  std::shared_ptr<const PlannerHNS::RoadNetworkSnapshot> pAfter =
+      PlannerHNS::MappingHelpers::UpdateMapWithOccupancyGrid(grid, data, versioned_map, updated_ids);
+
+  ASSERT_GT(updated_ids.size(), 0);
+  ASSERT_EQ(updated_ids.size(), updated_list.size());
+  EXPECT_GT(pAfter->version, pBefore->version);
+  EXPECT_EQ(pAfter->pMap.get(), pMap.get()) << "The base map is shared, not copied";
+
+  const std::vector<PlannerHNS::WayPoint>& points = pMap->roadSegments.at(0).Lanes.at(0).points;
+  const std::vector<PlannerHNS::WayPoint>& inplace_points = inplace_map.roadSegments.at(0).Lanes.at(0).points;
+  for(unsigned int i = 0; i < points.size(); i++)
+  {
+    EXPECT_EQ(points.at(i).actionCost.size(), 0) << "The base map is not written";
+    EXPECT_EQ(pBefore->GetActionCosts(points.at(i)).size(), 0) << "Older snapshots don't see newer layers";
+    EXPECT_EQ(pAfter->GetActionCosts(points.at(i)), inplace_points.at(i).actionCost);
+    EXPECT_EQ(pAfter->GetWayPoint(points.at(i)).actionCost, inplace_points.at(i).actionCost);
+  }
+
+  //the reader checks every snapshot it takes while more layers than MAP_OVERLAY_MAX_DEPTH are published,
+  //the layer of version v sets the cost of point v % 30 to v
+  const int nLayers = MAP_OVERLAY_MAX_DEPTH * 3;
+  bool bConsistent = true;
+  std::thread reader([&]()
+  {
+    unsigned long last_version = 0;
+    while(last_version < pAfter->version + nLayers)
+    {
+      std::shared_ptr<const PlannerHNS::RoadNetworkSnapshot> pSnapshot = versioned_map.GetSnapshot();
+      if(pSnapshot->version < last_version)
+        bConsistent = false;
+      last_version = pSnapshot->version;
+
+      //the grid update must stay visible under all the newer layers
+      for(unsigned int i = 0; i < points.size(); i++)
+      {
+        if(i < updated_ids.size() && pSnapshot->GetTotalActionCost(points.at(i)) == 0)
+          bConsistent = false;
+      }
+    }
+  });
+
+  for(int i = 0; i < nLayers; i++)
+  {
+    PlannerHNS::ActionCostsMap costs;
+    unsigned long v = versioned_map.GetSnapshot()->version + 1;
+    costs[points.at(v % points.size()).id].push_back(std::make_pair(PlannerHNS::FORWARD_ACTION, (double)v));
+    versioned_map.PublishActionCosts(costs);
+  }
+  reader.join();
+  EXPECT_TRUE(bConsistent);
+
+  std::shared_ptr<const PlannerHNS::RoadNetworkSnapshot> pLast = versioned_map.GetSnapshot();
+  EXPECT_EQ(pLast->version, pAfter->version + nLayers);
+  EXPECT_LT(pLast->pOverlay->depth, MAP_OVERLAY_MAX_DEPTH);
+  for(unsigned long v = pAfter->version + 1; v <= pLast->version; v++)
+    EXPECT_EQ(pLast->GetTotalActionCost(points.at(v % points.size())), (double)v);
+  for(unsigned int i = 0; i < updated_ids.size(); i++)
+    EXPECT_GT(pLast->GetTotalActionCost(points.at(i)), 0);
+
+  //a new map starts without layers, the old snapshots still hold the old map
+  std::shared_ptr<PlannerHNS::RoadNetwork> pNewMap = std::make_shared<PlannerHNS::RoadNetwork>();
+  CreateStraightLaneMap(5, *pNewMap);
+  std::shared_ptr<const PlannerHNS::RoadNetworkSnapshot> pNew = versioned_map.SetMap(pNewMap);
+  EXPECT_FALSE(pNew->pOverlay);
+  EXPECT_GT(pNew->version, pLast->version);
+  EXPECT_EQ(pLast->pMap.get(), pMap.get());
+}
+
+TEST(TestSuite, RoadNetworkSnapshot_publishOnCurrent)
+{
+  std::shared_ptr<PlannerHNS::RoadNetwork> pMap = std::make_shared<PlannerHNS::RoadNetwork>();
+  CreateStraightLaneMap(30, *pMap);
+  const std::vector<PlannerHNS::WayPoint>& points = pMap->roadSegments.at(0).Lanes.at(0).points;
+
+  PlannerHNS::VersionedRoadNetwork versioned_map;
+  std::shared_ptr<const PlannerHNS::RoadNetworkSnapshot> pBase = versioned_map.SetMap(pMap);
+
+  //a writer that publishes on an older snapshot loses
+  PlannerHNS::ActionCostsMap left_costs;
+  left_costs[points.at(0).id].push_back(std::make_pair(PlannerHNS::LEFT_TURN_ACTION, 7.0));
+  std::shared_ptr<const PlannerHNS::RoadNetworkSnapshot> pLeft = versioned_map.PublishActionCosts(pBase, left_costs);
+  ASSERT_TRUE(pLeft);
+  EXPECT_FALSE(versioned_map.PublishActionCosts(pBase, left_costs));
+  EXPECT_EQ(versioned_map.GetSnapshot(), pLeft);
+
+  //the grid costs are added to the costs of the current snapshot
+  PlannerHNS::WayPoint center;
+  PlannerHNS::OccupancyToGridMap grid(10, 4, 1.0, center);
+  std::vector<int> data(grid.width * grid.length, 0);
+  std::vector<int> updated_ids;
+  std::shared_ptr<const PlannerHNS::RoadNetworkSnapshot> pGrid =
+      PlannerHNS::MappingHelpers::UpdateMapWithOccupancyGrid(grid, data, versioned_map, updated_ids);
+  ASSERT_GT(updated_ids.size(), 0);
+  ASSERT_EQ(updated_ids.at(0), points.at(0).id);
+  const PlannerHNS::ActionCosts& costs = pGrid->GetActionCosts(points.at(0));
+  ASSERT_EQ(costs.size(), 2);
+  EXPECT_EQ(costs.at(0).first, PlannerHNS::LEFT_TURN_ACTION);
+  EXPECT_EQ(costs.at(0).second, 7.0);
+  EXPECT_EQ(costs.at(1).first, PlannerHNS::FORWARD_ACTION);
+  EXPECT_EQ(costs.at(1).second, 100.0);
+}
+
+TEST(TestSuite, RoadNetworkSnapshot_globalPlanCosts)
+{
+  std::shared_ptr<PlannerHNS::RoadNetwork> pMap = std::make_shared<PlannerHNS::RoadNetwork>();
+  CreateStraightLaneMap(30, *pMap);
+  PlannerHNS::RoadNetwork map = *pMap;
+  PlannerHNS::MappingHelpers::LinkLanesPointers(map);
+
+  PlannerHNS::VersionedRoadNetwork versioned_map;
+  versioned_map.SetMap(pMap);
+  PlannerHNS::ActionCostsMap costs;
+  costs[map.roadSegments.at(0).Lanes.at(0).points.at(10).id].push_back(std::make_pair(PlannerHNS::FORWARD_ACTION, 100.0));
+  std::shared_ptr<const PlannerHNS::RoadNetworkSnapshot> pSnapshot = versioned_map.PublishActionCosts(costs);
+
+  PlannerHNS::WayPoint start = map.roadSegments.at(0).Lanes.at(0).points.at(2);
+  PlannerHNS::WayPoint goal = map.roadSegments.at(0).Lanes.at(0).points.at(20);
+  std::vector<int> global_path;
+  std::vector<std::vector<PlannerHNS::WayPoint> > paths, snapshot_paths;
+
+  PlannerHNS::PlannerH planner;
+  double distance = planner.PlanUsingDP(start, goal, 100, false, global_path, map, paths);
+  double snapshot_distance = planner.PlanUsingDP(start, goal, 100, false, global_path, map, snapshot_paths, 0,
+      pSnapshot.get());
+
+  ASSERT_GT(distance, 0);
+  EXPECT_NEAR(snapshot_distance, distance + 100.0, 1e-9) << "The search reads the costs of the snapshot";
+  ASSERT_EQ(snapshot_paths.size(), paths.size());
+  for(unsigned int i = 0; i < paths.size(); i++)
+    EXPECT_EQ(snapshot_paths.at(i).size(), paths.at(i).size());
+}
+
+TEST(TestSuite, ObstacleDistanceField_compareBruteForce)
+{
+  std::vector<PlannerHNS::WayPoint> points;
+  for(int i = 0; i < 400; i++)
+  {
+    PlannerHNS::WayPoint p;
+    p.pos.x = 5.0 + 20.0 * sin(i * 12.9898) * cos(i * 4.1414);
+    p.pos.y = -3.0 + 20.0 * cos(i * 78.233);
+    points.push_back(p);
+  }
+
+  PlannerHNS::GPSPoint center(5.0, -3.0, 0, 0);
+  const double res = 0.25;
+  PlannerHNS::ObstacleDistanceField field;
+  field.Build(center, 15.0, res, points);
+
+  const double max_error = 2.0 * sqrt(2.0) * res + 1e-9;
+  for(double x = -9.9; x < 19.9; x += 0.37)
+  {
+    for(double y = -17.9; y < 11.9; y += 0.41)
+    {
+      double exact = DBL_MAX;
+      for(unsigned int i = 0; i < points.size(); i++)
+      {
+        const PlannerHNS::GPSPoint& p = points.at(i).pos;
+        if(p.x < center.x - 15.0 || p.x >= center.x + 15.0 || p.y < center.y - 15.0 || p.y >= center.y + 15.0)
+          continue;
+        exact = std::min(exact, hypot(p.y - y, p.x - x));
+      }
+
+      int iPoint = -1;
+      double clearance = field.GetClearance(x, y, iPoint);
+      ASSERT_GE(iPoint, 0);
+      EXPECT_NEAR(clearance, hypot(points.at(iPoint).pos.y - y, points.at(iPoint).pos.x - x), 1e-9);
+      EXPECT_GE(clearance, exact - 1e-9);
+      EXPECT_LE(clearance, exact + max_error);
+    }
+  }
+
+  int iPoint = 0;
+  EXPECT_EQ(field.GetClearance(center.x + 100, center.y, iPoint), DBL_MAX);
+  EXPECT_EQ(iPoint, -1);
+}
+
+TEST(TestSuite, TrajectoryDynamicCosts_distanceFieldStatic)
+{
+  PlannerHNS::PlanningParams params;
+  params.rollOutNumber = 4;
+  params.rollOutDensity = 1.0;
+  params.minFollowingDistance = 35;
+  params.horizontalSafetyDistancel = 0.3;
+  params.verticalSafetyDistance = 0.5;
+  PlannerHNS::CAR_BASIC_INFO carInfo;
+  PlannerHNS::VehicleState vehicleState;
+  PlannerHNS::WayPoint currState(0, 0, 0, 0);
+
+  //straight roll-outs one meter apart, the central one is the global path
+  std::vector<std::vector<PlannerHNS::WayPoint> > rollOuts(params.rollOutNumber + 1);
+  for(unsigned int it = 0; it < rollOuts.size(); it++)
+  {
+    double offset = params.rollOutDensity * ((int)it - params.rollOutNumber/2);
+    for(int i = -5; i < 60; i++)
+      rollOuts.at(it).push_back(PlannerHNS::WayPoint(i * 0.5, offset, 0, 0));
+  }
+  std::vector<PlannerHNS::WayPoint> totalPaths = rollOuts.at(params.rollOutNumber/2);
+
+  //static box 15 meters ahead across the central three roll-outs
+  std::vector<PlannerHNS::DetectedObject> obj_list(1);
+  PlannerHNS::DetectedObject& obj = obj_list.at(0);
+  obj.center = PlannerHNS::WayPoint(15, 0, 0, 0);
+  obj.w = 1;
+  obj.l = 1;
+  for(double y = -0.5; y <= 0.5; y += 0.1)
+  {
+    obj.contour.push_back(PlannerHNS::GPSPoint(14.5, y, 0, 0));
+    obj.contour.push_back(PlannerHNS::GPSPoint(15.5, y, 0, 0));
+  }
+
+  PlannerHNS::TrajectoryDynamicCosts exact_costs;
+  exact_costs.DoOneStepStatic(rollOuts, totalPaths, currState, params, carInfo, vehicleState, obj_list);
+  PlannerHNS::TrajectoryDynamicCosts field_costs;
+  field_costs.m_bUseDistanceField = true;
+  field_costs.m_DistanceFieldResolution = 0.1;
+  field_costs.DoOneStepStatic(rollOuts, totalPaths, currState, params, carInfo, vehicleState, obj_list);
+
+  ASSERT_EQ(exact_costs.m_TrajectoryCosts.size(), rollOuts.size());
+  ASSERT_EQ(field_costs.m_TrajectoryCosts.size(), rollOuts.size());
+  for(unsigned int it = 0; it < rollOuts.size(); it++)
+  {
+    const PlannerHNS::TrajectoryCost& exact = exact_costs.m_TrajectoryCosts.at(it);
+    const PlannerHNS::TrajectoryCost& field = field_costs.m_TrajectoryCosts.at(it);
+    EXPECT_EQ(field.bBlocked, exact.bBlocked) << "Roll-out " << it;
+    if(exact.bBlocked)
+      EXPECT_NEAR(field.closest_obj_distance, exact.closest_obj_distance, 0.5) << "Roll-out " << it;
+  }
+  EXPECT_TRUE(field_costs.m_TrajectoryCosts.at(params.rollOutNumber/2).bBlocked);
+  EXPECT_FALSE(field_costs.m_TrajectoryCosts.at(0).bBlocked);
+}
+
+TEST(TestSuite, SimuDecisionMaker_warmStartExtraction)
+{
+  PlannerHNS::RoadNetwork map;
+  CreateStraightLaneMap(200, map);
+  std::vector<std::vector<PlannerHNS::WayPoint> > global_path(1, map.roadSegments.at(0).Lanes.at(0).points);
+  PlannerHNS::PlanningHelpers::CalcAngleAndCost(global_path.at(0));
+
+  PlannerHNS::PlanningParams params;
+  params.maxSpeed = 5;
+  params.microPlanDistance = 30;
+  params.horizonDistance = 60;
+  params.rollOutNumber = 2;
+  PlannerHNS::CAR_BASIC_INFO car_info;
+  car_info.wheel_base = 2.7;
+  car_info.length = 4.5;
+  car_info.width = 1.8;
+
+  SimuDecisionMakerPaths agent;
+  agent.m_pMap = &map;
+  agent.Init(PlannerHNS::ControllerParams(), params, car_info);
+  agent.ReInitializePlanner(global_path.at(0).at(5));
+  agent.SetNewGlobalPath(global_path);
+
+  PlannerHNS::SimuAgentStep step;
+  step.desiredStatus.shift = PlannerHNS::SHIFT_POS_DD;
+  int last_index = 0;
+  for(int tick = 0; tick < 60; tick++)
+  {
+    agent.Step(0.1, step);
+    step.desiredStatus.speed = step.behavior.maxVelocity;
+
+    //the warm started extraction is the same as a full search from the current state
+    std::vector<PlannerHNS::WayPoint> extracted;
+    PlannerHNS::PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(global_path.at(0), agent.state,
+        params.horizonDistance, params.pathDensity, extracted);
+    int close_index = PlannerHNS::PlanningHelpers::GetClosestNextPointIndexDirectionFast(global_path.at(0), agent.state);
+    ASSERT_EQ(agent.m_TotalPathClosePoints.size(), 1);
+    ASSERT_EQ(agent.m_TotalPathClosePoints.at(0).index, close_index) << "Tick " << tick;
+    ASSERT_GE(close_index, last_index) << "Tick " << tick;
+    last_index = close_index;
+
+    ASSERT_EQ(agent.m_TotalPath.at(0).size(), extracted.size()) << "Tick " << tick;
+    for(unsigned int i = 0; i < extracted.size(); i++)
+    {
+      ASSERT_EQ(agent.m_TotalPath.at(0).at(i).pos.x, extracted.at(i).pos.x) << "Tick " << tick;
+      ASSERT_EQ(agent.m_TotalPath.at(0).at(i).pos.y, extracted.at(i).pos.y) << "Tick " << tick;
+    }
+  }
+  EXPECT_GT(last_index, 10) << "The agent drove along the lane";
+
+  //a new global path starts a full search again
+  agent.SetNewGlobalPath(global_path);
+  EXPECT_EQ(agent.m_TotalPathClosePoints.size(), 0);
+
+  //and so does a re-initialized planner
+  agent.Step(0.1, step);
+  ASSERT_EQ(agent.m_TotalPathClosePoints.size(), 1);
+  agent.ReInitializePlanner(global_path.at(0).at(5));
+  EXPECT_EQ(agent.m_TotalPathClosePoints.size(), 0);
+}
+
+TEST(TestSuite, GetClosestNextPointIndexDirectionWarm_fallback)
+{
+  std::vector<PlannerHNS::WayPoint> path;
+  for(int i = 0; i < 400; i++)
+    path.push_back(PlannerHNS::WayPoint(i * 0.5, 0, 0, 0));
+  PlannerHNS::PlanningHelpers::CalcAngleAndCost(path);
+
+  PlannerHNS::ClosestPointInfo info;
+  PlannerHNS::WayPoint pos = path.at(100);
+  pos.pos.y = 0.2;
+  EXPECT_EQ(PlannerHNS::PlanningHelpers::GetClosestNextPointIndexDirectionWarm(path, pos, 20, info),
+      PlannerHNS::PlanningHelpers::GetClosestNextPointIndexDirectionFast(path, pos));
+  EXPECT_NEAR(info.distance, 0.2, 1e-9);
+
+  //moving on inside the window, backward, past the window, and away from the path all match the full search
+  double steps[][2] = {{101.3, 0.2}, {103, 0.3}, {60.2, 0.2}, {62, 0.1}, {250.4, 0.2}, {251, 0.2}, {251, 6}, {20.2, 0.1}};
+  for(unsigned int i = 0; i < sizeof(steps)/sizeof(steps[0]); i++)
+  {
+    pos.pos.x = steps[i][0] * 0.5;
+    pos.pos.y = steps[i][1];
+    int full_index = PlannerHNS::PlanningHelpers::GetClosestNextPointIndexDirectionFast(path, pos);
+    EXPECT_EQ(PlannerHNS::PlanningHelpers::GetClosestNextPointIndexDirectionWarm(path, pos, 20, info), full_index) << "Step " << i;
+    EXPECT_EQ(info.index, full_index) << "Step " << i;
+  }
+
+  //the search stops at endIndex, a pose past it gets the point after it
+  pos.pos.x = 200 * 0.5;
+  pos.pos.y = 0;
+  EXPECT_EQ(PlannerHNS::PlanningHelpers::GetClosestNextPointIndexDirectionFast(path, pos, 10, 50), 51);
+}
+
+TEST(TestSuite, TrajectoryDynamicCosts_distanceFieldInsideBorder)
+{
+  PlannerHNS::PlanningParams params;
+  params.rollOutNumber = 4;
+  params.rollOutDensity = 1.0;
+  params.minFollowingDistance = 35;
+  params.horizontalSafetyDistancel = 0.3;
+  params.verticalSafetyDistance = 0.5;
+  PlannerHNS::CAR_BASIC_INFO carInfo;
+  carInfo.width = 1.8;
+  carInfo.length = 4.5;
+  carInfo.wheel_base = 2.7;
+  PlannerHNS::VehicleState vehicleState;
+  PlannerHNS::WayPoint currState(0, 0, 0, 0);
+
+  std::vector<std::vector<PlannerHNS::WayPoint> > rollOuts(params.rollOutNumber + 1);
+  for(unsigned int it = 0; it < rollOuts.size(); it++)
+  {
+    double offset = params.rollOutDensity * ((int)it - params.rollOutNumber/2);
+    for(int i = -5; i < 60; i++)
+      rollOuts.at(it).push_back(PlannerHNS::WayPoint(i * 0.5, offset, 0, 0));
+  }
+  std::vector<PlannerHNS::WayPoint> totalPaths = rollOuts.at(params.rollOutNumber/2);
+
+  //the point nearest to the car center is just outside the border, the other one is inside it behind the car
+  //center where no roll-out point comes close enough to it
+  double critical_lateral_distance = carInfo.width/2.0 + params.horizontalSafetyDistancel;
+  std::vector<PlannerHNS::DetectedObject> obj_list(1);
+  PlannerHNS::DetectedObject& obj = obj_list.at(0);
+  obj.center = PlannerHNS::WayPoint(-0.6, 0.75, 0, 0);
+  obj.contour.push_back(PlannerHNS::GPSPoint(0, critical_lateral_distance + 0.02, 0, 0));
+  obj.contour.push_back(PlannerHNS::GPSPoint(-1.2, 0.3, 0, 0));
+
+  PlannerHNS::TrajectoryDynamicCosts exact_costs;
+  exact_costs.DoOneStepStatic(rollOuts, totalPaths, currState, params, carInfo, vehicleState, obj_list);
+  PlannerHNS::TrajectoryDynamicCosts field_costs;
+  field_costs.m_bUseDistanceField = true;
+  field_costs.m_DistanceFieldResolution = 0.1;
+  field_costs.DoOneStepStatic(rollOuts, totalPaths, currState, params, carInfo, vehicleState, obj_list);
+
+  ASSERT_EQ(field_costs.m_TrajectoryCosts.size(), rollOuts.size());
+  for(unsigned int it = 0; it < rollOuts.size(); it++)
+  {
+    EXPECT_TRUE(field_costs.m_TrajectoryCosts.at(it).bBlocked) << "Roll-out " << it;
+    EXPECT_EQ(field_costs.m_TrajectoryCosts.at(it).bBlocked, exact_costs.m_TrajectoryCosts.at(it).bBlocked) << "Roll-out " << it;
+  }
+}
+
+TEST(TestSuite, SimuDecisionMaker_stepAgents)
+{
+  PlannerHNS::RoadNetwork map;
+  CreateStraightLaneMap(200, map);
+  std::vector<std::vector<PlannerHNS::WayPoint> > global_path(1, map.roadSegments.at(0).Lanes.at(0).points);
+  PlannerHNS::PlanningHelpers::CalcAngleAndCost(global_path.at(0));
+
+  PlannerHNS::PlanningParams params;
+  params.maxSpeed = 5;
+  params.microPlanDistance = 30;
+  params.horizonDistance = 60;
+  params.rollOutNumber = 2;
+  PlannerHNS::CAR_BASIC_INFO car_info;
+  car_info.wheel_base = 2.7;
+  car_info.length = 4.5;
+  car_info.width = 1.8;
+
+  const int n_agents = 6;
+  std::vector<PlannerHNS::SimuDecisionMaker> serial(n_agents), parallel(n_agents);
+  std::vector<PlannerHNS::SimuDecisionMaker*> parallel_agents;
+  std::vector<PlannerHNS::SimuAgentStep> serial_steps(n_agents), parallel_steps(n_agents);
+  for(int i = 0; i < n_agents; i++)
+  {
+    PlannerHNS::WayPoint start = global_path.at(0).at(5 + i * 20);
+    start.pos.y = 0.2 * (i % 3);
+    PlannerHNS::SimuDecisionMaker* agents[2] = {&serial.at(i), &parallel.at(i)};
+    for(int k = 0; k < 2; k++)
+    {
+      agents[k]->m_pMap = &map;
+      agents[k]->Init(PlannerHNS::ControllerParams(), params, car_info);
+      agents[k]->ReInitializePlanner(start);
+      agents[k]->SetNewGlobalPath(global_path);
+    }
+    parallel_agents.push_back(&parallel.at(i));
+
+    // the first agents see the one in front of them as an obstacle
+    PlannerHNS::DetectedObject obj;
+    obj.center = global_path.at(0).at(25 + i * 20);
+    obj.w = 2;
+    obj.l = 4;
+    for(double x = -2; x <= 2; x += 0.5)
+    {
+      obj.contour.push_back(PlannerHNS::GPSPoint(obj.center.pos.x + x, -1, 0, 0));
+      obj.contour.push_back(PlannerHNS::GPSPoint(obj.center.pos.x + x, 1, 0, 0));
+    }
+    if(i < n_agents / 2)
+      serial_steps.at(i).objects.push_back(obj);
+    serial_steps.at(i).desiredStatus.shift = PlannerHNS::SHIFT_POS_DD;
+  }
+  parallel_steps = serial_steps;
+
+  for(int tick = 0; tick < 40; tick++)
+  {
+    for(int i = 0; i < n_agents; i++)
+      serial.at(i).Step(0.1, serial_steps.at(i));
+    PlannerHNS::SimuDecisionMaker::StepAgents(0.1, parallel_agents, parallel_steps);
+
+    for(int i = 0; i < n_agents; i++)
+    {
+      const PlannerHNS::SimuDecisionMaker& s = serial.at(i);
+      const PlannerHNS::SimuDecisionMaker& p = parallel.at(i);
+      ASSERT_EQ(p.state.pos.x, s.state.pos.x) << "Tick " << tick << ", agent " << i;
+      ASSERT_EQ(p.state.pos.y, s.state.pos.y) << "Tick " << tick << ", agent " << i;
+      ASSERT_EQ(p.state.pos.a, s.state.pos.a) << "Tick " << tick << ", agent " << i;
+      ASSERT_EQ(parallel_steps.at(i).behavior.state, serial_steps.at(i).behavior.state) << "Tick " << tick << ", agent " << i;
+      ASSERT_EQ(parallel_steps.at(i).behavior.maxVelocity, serial_steps.at(i).behavior.maxVelocity) << "Tick " << tick << ", agent " << i;
+      ASSERT_EQ(p.m_Path.size(), s.m_Path.size()) << "Tick " << tick << ", agent " << i;
+
+      // the next tick drives with the planned velocity
+      serial_steps.at(i).desiredStatus.speed = serial_steps.at(i).behavior.maxVelocity;
+      parallel_steps.at(i).desiredStatus.speed = parallel_steps.at(i).behavior.maxVelocity;
+    }
+  }
+
+  // the agents without obstacles drove along the lane
+  EXPECT_GT(parallel.at(n_agents - 1).state.pos.x, global_path.at(0).at(5 + (n_agents - 1) * 20).pos.x);
+}
+
+TEST(TestSuite, BehaviorPrediction_adaptiveParticles)
+{
+  //fixed seed, the bounds still leave room for the sampling noise so that other seeds pass as well
+  double fixed_particles = 0, adaptive_particles = 0;
+  double fixed_ratio = RunBehaviorPrediction(BEH_PARTICLES_NUM, BEH_PARTICLES_NUM, 5.0, PlannerHNS::BEH_FORWARD_STATE,
+      fixed_particles);
+  double adaptive_ratio = RunBehaviorPrediction(3, BEH_PARTICLES_NUM, 5.0, PlannerHNS::BEH_FORWARD_STATE,
+      adaptive_particles);
+
+  ASSERT_NEAR(fixed_particles, 2 * BEH_PARTICLES_NUM, 1e-9) << "Fixed counts sample every forward and stop particle";
+  ASSERT_GE(fixed_ratio, 0.85) << "Moving object is predicted forward";
+  ASSERT_GE(adaptive_ratio, fixed_ratio - 0.1) << "Adaptive counts predict as well as fixed counts";
+  ASSERT_LE(adaptive_particles, fixed_particles) << "Adaptive counts never sample more than fixed counts";
+
+  fixed_ratio = RunBehaviorPrediction(BEH_PARTICLES_NUM, BEH_PARTICLES_NUM, 0.0, PlannerHNS::BEH_STOPPING_STATE,
+      fixed_particles);
+  adaptive_ratio = RunBehaviorPrediction(3, BEH_PARTICLES_NUM, 0.0, PlannerHNS::BEH_STOPPING_STATE,
+      adaptive_particles);
+
+  ASSERT_GE(fixed_ratio, 0.85) << "Stopped object is predicted stopping";
+  ASSERT_GE(adaptive_ratio, fixed_ratio - 0.1) << "Adaptive counts predict as well as fixed counts";
+  ASSERT_LT(adaptive_particles, 0.75 * fixed_particles) << "Confident stopped object uses fewer particles";
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
@@ -1158,8 +1158,7 @@ void ROSHelpers::ConvertFromAutowareCloudClusterObstaclesToPlannerH(const Planne
     const double max_obj_size, const double& min_obj_size, const double& detection_radius,
     const int& n_poly_quarters,const double& poly_resolution, int& nOriginalPoints, int& nContourPoints)
 {
-  PlannerHNS::Mat3 rotationMat(-currState.pos.a);
-  PlannerHNS::Mat3 translationMat(-currState.pos.x, -currState.pos.y);
+  PlannerHNS::RigidTransform2D transform = PlannerHNS::RigidTransform2D::ToFrame(currState.pos.x, currState.pos.y, currState.pos.a);
 
   int nPoints = 0;
   int nOrPoints = 0;
@@ -1198,8 +1197,7 @@ void ROSHelpers::ConvertFromAutowareCloudClusterObstaclesToPlannerH(const Planne
     if(obj.distance_to_center > detection_radius || object_size < min_obj_size || object_size > max_obj_size)
       continue;
 
-    relative_point = translationMat*obj.center.pos;
-    relative_point = rotationMat*relative_point;
+    relative_point = transform*obj.center.pos;
 
     double distance_x = fabs(relative_point.x - car_length/3.0);
     double distance_y = fabs(relative_point.y);
@@ -1776,13 +1774,10 @@ void ROSHelpers::GetIndicatorArrows(const PlannerHNS::WayPoint& center, const do
   PlannerHNS::GPSPoint top_right(critical_lateral_distance, length, center.pos.z, 0);
   PlannerHNS::GPSPoint top_left(-critical_lateral_distance, length, center.pos.z, 0);
 
-  PlannerHNS::Mat3 invRotationMat(center.pos.a-M_PI_2);
-  PlannerHNS::Mat3 invTranslationMat(center.pos.x, center.pos.y);
+  PlannerHNS::RigidTransform2D invTransform = PlannerHNS::RigidTransform2D::FromFrame(center.pos.x, center.pos.y, center.pos.a-M_PI_2);
 
-  top_right = invRotationMat*top_right;
-  top_right = invTranslationMat*top_right;
-  top_left = invRotationMat*top_left;
-  top_left = invTranslationMat*top_left;
+  top_right = invTransform*top_right;
+  top_left = invTransform*top_left;
 
   top_right.a = center.pos.a - M_PI_2;
   top_left.a = center.pos.a + M_PI_2;
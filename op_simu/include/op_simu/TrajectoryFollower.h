@@ -7,15 +7,85 @@
 
 #ifndef TRAJECTORYFOLLOWER_H_
 #define TRAJECTORYFOLLOWER_H_
+#include <memory>
 #include "op_planner/RoadNetwork.h"
 #include "op_utility/UtilityH.h"
 #include "op_planner/PlannerCommonDef.h"
 
 
 #define MAX_ACCELERATION_2G 5 // meter /sec/sec
+#define FOLLOWER_LOG_RESERVE_SIZE 50000 // records allocated per log at start, about 80 minutes at 10 Hz
+#define FOLLOWER_MAX_WARM_START_ERROR 3.0 // meter, larger lateral error from the warm started search falls back to a full search
 namespace SimulationNS
 {
 
+//Path being followed, with its arc length computed once when the trajectory changes.
+//Shared between the planner and the follower, so updating the path doesn't copy it.
+class FollowerPath
+{
+public:
+  std::vector<PlannerHNS::WayPoint> points;
+  std::vector<double> arcLength; //distance from the first point
+  double density;
+
+  FollowerPath()
+  {
+    density = 1;
+  }
+
+  explicit FollowerPath(std::vector<PlannerHNS::WayPoint>&& path)
+  {
+    density = 1;
+    Set(std::move(path));
+  }
+
+  void Set(std::vector<PlannerHNS::WayPoint>&& path);
+};
+
+//Keeps every record of a run, formatting is left to whoever reads it.
+//Space for FOLLOWER_LOG_RESERVE_SIZE records is allocated up front, longer runs grow the buffer.
+template <class T>
+class LogBuffer
+{
+public:
+  void Init(const unsigned int& reserve)
+  {
+    m_Records.clear();
+    m_Records.reserve(reserve);
+  }
+
+  void Push(const T& record)
+  {
+    m_Records.push_back(record);
+  }
+
+  unsigned int Size() const
+  {
+    return m_Records.size();
+  }
+
+  //0 is the oldest record
+  const T& At(const unsigned int& i) const
+  {
+    return m_Records[i];
+  }
+
+private:
+  std::vector<T> m_Records;
+};
+
+class CalibrationLogRecord
+{
+public:
+  timespec tStamp;
+  bool bReset;
+  int start;
+  int finish;
+  int target;
+  double dt;
+  int other; //velocity for the steering log, steering for the velocity log
+};
+
 class TrajectoryFollower
 {
 public:
@@ -25,6 +95,8 @@ public:
   void PrepareNextWaypoint(const PlannerHNS::WayPoint& CurPos, const double& currVelocity, const double& currSteering);
 
   void UpdateCurrentPath(const std::vector<PlannerHNS::WayPoint>& path);
+  void UpdateCurrentPath(std::vector<PlannerHNS::WayPoint>&& path);
+  void UpdateCurrentPath(const std::shared_ptr<const FollowerPath>& path);
 
   int SteerControllerUpdate(const PlannerHNS::VehicleState& CurrStatus,
       const PlannerHNS::BehaviorState& CurrBehavior, double& desiredSteerAngle);
@@ -37,6 +109,10 @@ public:
         const std::vector<PlannerHNS::WayPoint>& path, const PlannerHNS::WayPoint& currPose,
         const PlannerHNS::VehicleState& vehicleState, const bool& bNewTrajectory);
 
+  PlannerHNS::VehicleState DoOneStep(const double& dt, const PlannerHNS::BehaviorState& behavior,
+        const std::shared_ptr<const FollowerPath>& path, const PlannerHNS::WayPoint& currPose,
+        const PlannerHNS::VehicleState& vehicleState, const bool& bNewTrajectory);
+
   //Testing Points
   PlannerHNS::WayPoint   m_ForwardSimulation;
   PlannerHNS::WayPoint   m_PerpendicularPoint;
@@ -54,7 +130,7 @@ private:
   double             m_FollowAcc;
   PlannerHNS::ControllerParams       m_Params;
   PlannerHNS::CAR_BASIC_INFO         m_VehicleInfo;
-  std::vector<PlannerHNS::WayPoint>   m_Path;
+  std::shared_ptr<const FollowerPath> m_pPath;
   PlannerHNS::WayPoint     m_DesPos;
   double            m_PrevDesiredSteer; // control output
   double             m_FollowAcceleration;
@@ -67,14 +143,14 @@ private:
 
   bool            m_bEnableLog;
   std::vector<std::string>    m_LogData;
-  std::vector<std::string>    m_LogSteerPIDData;
-  std::vector<std::string>    m_LogVelocityPIDData;
+  LogBuffer<UtilityHNS::PIDLogRecord> m_LogSteerPIDData;
+  LogBuffer<UtilityHNS::PIDLogRecord> m_LogVelocityPIDData;
 
   //Steering and Velocity Calibration Global Variables
   bool            m_bCalibrationMode;
   int              m_iNextTest;
-  std::vector<std::string>    m_SteerCalibrationData;
-  std::vector<std::string>    m_VelocityCalibrationData;
+  LogBuffer<CalibrationLogRecord> m_SteerCalibrationData;
+  LogBuffer<CalibrationLogRecord> m_VelocityCalibrationData;
   PlannerHNS::VehicleState   m_prevCurrState_steer;
   PlannerHNS::VehicleState   m_prevDesiredState_steer;
   PlannerHNS::VehicleState   m_prevCurrState_vel;
@@ -84,7 +160,10 @@ private:
   std::vector<std::pair<double, double> > m_CalibrationRunList;
 
 
-  bool FindNextWayPoint(const std::vector<PlannerHNS::WayPoint>& path, const PlannerHNS::WayPoint& state,
+  PlannerHNS::VehicleState DoControlStep(const double& dt, const PlannerHNS::BehaviorState& behavior,
+      const PlannerHNS::WayPoint& currPose, const PlannerHNS::VehicleState& vehicleState);
+
+  bool FindNextWayPoint(const FollowerPath& path, const PlannerHNS::WayPoint& state,
       const double& velocity, PlannerHNS::WayPoint& pursuite_point, PlannerHNS::WayPoint& prep,
       double& lateral_err, double& follow_distance);
 
@@ -102,6 +181,7 @@ private:
       double& desiredVel);
 
   void LogCalibrationData(const PlannerHNS::VehicleState& currState,const PlannerHNS::VehicleState& desiredState);
+  void WriteLogs();
   void InitCalibration();
   void CalibrationStep(const double& dt, const PlannerHNS::VehicleState& CurrStatus, double& desiredSteer, double& desiredVelocity);
 };
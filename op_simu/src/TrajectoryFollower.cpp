@@ -5,7 +5,9 @@
 
 #include "op_simu/TrajectoryFollower.h"
 #include "op_planner/PlanningHelpers.h"
+#include <algorithm>
 #include <cmath>
+#include <sstream>
 #include <stdlib.h>
 #include <iostream>
 
@@ -17,6 +19,58 @@ using namespace std;
 namespace SimulationNS
 {
 
+void FollowerPath::Set(std::vector<PlannerHNS::WayPoint>&& path)
+{
+  points = std::move(path);
+  arcLength.resize(points.size());
+  double d = 0;
+  for(unsigned int i = 0; i < points.size(); i++)
+  {
+    if(i > 0)
+      d += hypot(points.at(i).pos.y - points.at(i-1).pos.y, points.at(i).pos.x - points.at(i-1).pos.x);
+    arcLength.at(i) = d;
+  }
+
+  if(points.size() > 1)
+    density = arcLength.at(1);
+}
+
+//Same as PlanningHelpers::GetFollowPointOnTrajectory, with a binary search on the arc length instead of summing segments
+static WayPoint GetFollowPointOnPath(const FollowerPath& path, const RelativeInfo& init_p, const double& distance)
+{
+  const std::vector<WayPoint>& trajectory = path.points;
+  WayPoint follow_point;
+
+  if(init_p.iBack == 0 && init_p.iBack == init_p.iFront && init_p.from_back_distance > distance)
+  {
+    follow_point = trajectory.at(init_p.iFront);
+    follow_point.pos.x = init_p.perp_point.pos.x + distance * cos(follow_point.pos.a);
+    follow_point.pos.y = init_p.perp_point.pos.y + distance * sin(follow_point.pos.a);
+  }
+  else if(init_p.iFront == (int)trajectory.size() - 1)
+  {
+    follow_point = trajectory.at(init_p.iFront);
+    follow_point.pos.x = init_p.perp_point.pos.x + distance * cos(follow_point.pos.a);
+    follow_point.pos.y = init_p.perp_point.pos.y + distance * sin(follow_point.pos.a);
+  }
+  else
+  {
+    double front_s = path.arcLength.at(init_p.iFront);
+    double target_s = front_s + distance - init_p.to_front_distance;
+    int local_i = std::lower_bound(path.arcLength.begin() + init_p.iFront, path.arcLength.end(), target_s) - path.arcLength.begin();
+    if(local_i > (int)trajectory.size() - 1)
+      local_i = trajectory.size() - 1;
+
+    double d_part = distance - (init_p.to_front_distance + path.arcLength.at(local_i) - front_s);
+
+    follow_point = trajectory.at(local_i);
+    follow_point.pos.x = follow_point.pos.x + d_part * cos(follow_point.pos.a);
+    follow_point.pos.y = follow_point.pos.y + d_part * sin(follow_point.pos.a);
+  }
+
+  return follow_point;
+}
+
 TrajectoryFollower::TrajectoryFollower()
 {
   m_iNextTest = 0;
@@ -40,6 +94,13 @@ void TrajectoryFollower::Init(const ControllerParams& params, const CAR_BASIC_IN
 {
   m_bEnableLog = bEnableLogs;
   m_bCalibrationMode = bCalibration;
+  if(m_bEnableLog)
+  {
+    m_LogSteerPIDData.Init(FOLLOWER_LOG_RESERVE_SIZE);
+    m_LogVelocityPIDData.Init(FOLLOWER_LOG_RESERVE_SIZE);
+    m_SteerCalibrationData.Init(FOLLOWER_LOG_RESERVE_SIZE);
+    m_VelocityCalibrationData.Init(FOLLOWER_LOG_RESERVE_SIZE);
+  }
   if(m_bCalibrationMode)
     InitCalibration();
 
@@ -60,20 +121,49 @@ void TrajectoryFollower::Init(const ControllerParams& params, const CAR_BASIC_IN
 TrajectoryFollower::~TrajectoryFollower()
 {
   if(m_bEnableLog)
+    WriteLogs();
+}
+
+void TrajectoryFollower::WriteLogs()
+{
+  //the records are formatted here, at shutdown, so the control loop only copies them
+  std::vector<std::string> steer_calibration, velocity_calibration, steer_pid, velocity_pid;
+  const LogBuffer<CalibrationLogRecord>* calibration_logs[2] = {&m_SteerCalibrationData, &m_VelocityCalibrationData};
+  std::vector<std::string>* calibration_lines[2] = {&steer_calibration, &velocity_calibration};
+  for(int l = 0; l < 2; l++)
   {
-    DataRW::WriteLogData(UtilityH::GetHomeDirectory()+DataRW::LoggingMainfolderName+DataRW::ControlLogFolderName, "ControlLog",
-        "time,X,Y,heading, Target, error,LateralError,SteerBeforLowPass,Steer,iIndex, pathSize",
-        m_LogData);
+    for(unsigned int i = 0; i < calibration_logs[l]->Size(); i++)
+    {
+      const CalibrationLogRecord& r = calibration_logs[l]->At(i);
+      std::ostringstream dataLine;
+      dataLine << UtilityH::GetLongTime(r.tStamp) << ","
+          << r.bReset << ","
+          << r.start << ","
+          << r.finish << ","
+          << r.target << ","
+          << r.dt << ","
+          << r.other << ",";
+      calibration_lines[l]->push_back(dataLine.str());
+    }
+  }
 
-    DataRW::WriteLogData(UtilityH::GetHomeDirectory()+DataRW::LoggingMainfolderName+DataRW::ControlLogFolderName, "SteeringCalibrationLog",
-        "time, reset, start A, end A, desired A, dt, vel", m_SteerCalibrationData);
+  for(unsigned int i = 0; i < m_LogSteerPIDData.Size(); i++)
+    steer_pid.push_back(PIDController::ToString(m_LogSteerPIDData.At(i)));
+  for(unsigned int i = 0; i < m_LogVelocityPIDData.Size(); i++)
+    velocity_pid.push_back(PIDController::ToString(m_LogVelocityPIDData.At(i)));
 
-    DataRW::WriteLogData(UtilityH::GetHomeDirectory()+DataRW::LoggingMainfolderName+DataRW::ControlLogFolderName, "VelocityCalibrationLog",
-        "time, reset, start V, end V, desired V, dt, steering", m_VelocityCalibrationData);
+  DataRW::WriteLogData(UtilityH::GetHomeDirectory()+DataRW::LoggingMainfolderName+DataRW::ControlLogFolderName, "ControlLog",
+      "time,X,Y,heading, Target, error,LateralError,SteerBeforLowPass,Steer,iIndex, pathSize",
+      m_LogData);
 
-    DataRW::WriteLogData(UtilityH::GetHomeDirectory()+DataRW::LoggingMainfolderName+DataRW::ControlLogFolderName, "SteeringPIDLog",m_pidSteer.ToStringHeader(), m_LogSteerPIDData );
-    DataRW::WriteLogData(UtilityH::GetHomeDirectory()+DataRW::LoggingMainfolderName+DataRW::ControlLogFolderName, "VelocityPIDLog",m_pidVelocity.ToStringHeader(), m_LogVelocityPIDData );
-  }
+  DataRW::WriteLogData(UtilityH::GetHomeDirectory()+DataRW::LoggingMainfolderName+DataRW::ControlLogFolderName, "SteeringCalibrationLog",
+      "time, reset, start A, end A, desired A, dt, vel", steer_calibration);
+
+  DataRW::WriteLogData(UtilityH::GetHomeDirectory()+DataRW::LoggingMainfolderName+DataRW::ControlLogFolderName, "VelocityCalibrationLog",
+      "time, reset, start V, end V, desired V, dt, steering", velocity_calibration);
+
+  DataRW::WriteLogData(UtilityH::GetHomeDirectory()+DataRW::LoggingMainfolderName+DataRW::ControlLogFolderName, "SteeringPIDLog",m_pidSteer.ToStringHeader(), steer_pid);
+  DataRW::WriteLogData(UtilityH::GetHomeDirectory()+DataRW::LoggingMainfolderName+DataRW::ControlLogFolderName, "VelocityPIDLog",m_pidVelocity.ToStringHeader(), velocity_pid);
 }
 
 void TrajectoryFollower::PrepareNextWaypoint(const PlannerHNS::WayPoint& CurPos, const double& currVelocity, const double& currSteering)
@@ -90,7 +180,9 @@ void TrajectoryFollower::PrepareNextWaypoint(const PlannerHNS::WayPoint& CurPos,
 
   m_CurrPos = m_ForwardSimulation;
 
-  bool ret = FindNextWayPoint(m_Path, pred_point, currVelocity, m_FollowMePoint, m_PerpendicularPoint, m_LateralError, m_FollowingDistance);
+  if(!m_pPath) return;
+
+  bool ret = FindNextWayPoint(*m_pPath, pred_point, currVelocity, m_FollowMePoint, m_PerpendicularPoint, m_LateralError, m_FollowingDistance);
   if(ret)
   {
     m_DesPos = m_FollowMePoint;
@@ -100,34 +192,51 @@ void TrajectoryFollower::PrepareNextWaypoint(const PlannerHNS::WayPoint& CurPos,
 
 void TrajectoryFollower::UpdateCurrentPath(const std::vector<PlannerHNS::WayPoint>& path)
 {
-  //BehaviorsNS::MappingHelpers::ConvertFromWaypointsToVectorPath(path, m_Path);
-  if(path.size()>0)
-    m_WayPointsDensity = hypot(path.at(1).pos.y - path.at(0).pos.y, path.at(1).pos.x - path.at(0).pos.x);
+  UpdateCurrentPath(std::vector<PlannerHNS::WayPoint>(path));
+}
+
+void TrajectoryFollower::UpdateCurrentPath(std::vector<PlannerHNS::WayPoint>&& path)
+{
+  UpdateCurrentPath(std::make_shared<const FollowerPath>(std::move(path)));
+}
 
-  m_Path = path;
+void TrajectoryFollower::UpdateCurrentPath(const std::shared_ptr<const FollowerPath>& path)
+{
+  m_pPath = path;
+  if(m_pPath && m_pPath->points.size() > 1)
+    m_WayPointsDensity = m_pPath->density;
 }
 
-bool TrajectoryFollower::FindNextWayPoint(const std::vector<PlannerHNS::WayPoint>& path, const PlannerHNS::WayPoint& state,
+bool TrajectoryFollower::FindNextWayPoint(const FollowerPath& path, const PlannerHNS::WayPoint& state,
     const double& velocity, PlannerHNS::WayPoint& pursuite_point, PlannerHNS::WayPoint& prep,
     double& lateral_err, double& follow_distance)
 {
-  if(path.size()==0) return false;
+  if(path.points.size()==0) return false;
 
   follow_distance = fabs(velocity) * (m_Params.SteeringDelay+0.5);
   if(follow_distance < m_Params.minPursuiteDistance)
     follow_distance = m_Params.minPursuiteDistance;
 
+  //search around the previous point, the vehicle moves a few points at most between two steps
   RelativeInfo info;
-  PlanningHelpers::GetRelativeInfo(path, state, info);
-  unsigned int point_index = 0;
-  pursuite_point = PlanningHelpers::GetFollowPointOnTrajectory(path, info, follow_distance, point_index);
+  bool bFound = false;
+  if(m_iPrevWayPoint >= 0 && m_iPrevWayPoint < (int)path.points.size())
+  {
+    int iFront = PlanningHelpers::GetClosestNextPointIndexLocal(path.points, state, m_iPrevWayPoint);
+    bFound = PlanningHelpers::GetRelativeInfoFromIndex(path.points, state, iFront, info)
+        && fabs(info.perp_distance) < FOLLOWER_MAX_WARM_START_ERROR;
+  }
+
+  if(!bFound)
+    PlanningHelpers::GetRelativeInfo(path.points, state, info);
+
+  pursuite_point = GetFollowPointOnPath(path, info, follow_distance);
   prep = info.perp_point;
   lateral_err = info.perp_distance;
   m_iPrevWayPoint = info.iFront;
 
   double d_critical = (-velocity*velocity)/2.0*m_VehicleInfo.max_deceleration;
-  int nPointToEnd = path.size() - m_iPrevWayPoint;
-  double totalD = m_WayPointsDensity*nPointToEnd;
+  double totalD = path.arcLength.back() - path.arcLength.at(m_iPrevWayPoint) + m_WayPointsDensity;
 
   if(totalD <= 1 || totalD <= d_critical)
   {
@@ -143,7 +252,7 @@ bool TrajectoryFollower::FindNextWayPoint(const std::vector<PlannerHNS::WayPoint
 int TrajectoryFollower::SteerControllerUpdate(const PlannerHNS::VehicleState& CurrStatus,
     const PlannerHNS::BehaviorState& CurrBehavior, double& desiredSteerAngle)
 {
-  if(m_Path.size()==0) return -1;
+  if(!m_pPath || m_pPath->points.size()==0) return -1;
   int ret = -1;
   //AdjustPID(CurrStatus.velocity, 18.0, m_Params.Gain);
   if(CurrBehavior.state == FORWARD_STATE || CurrBehavior.state == TRAFFIC_LIGHT_STOP_STATE || CurrBehavior.state == STOP_SIGN_STOP_STATE || CurrBehavior.state  == FOLLOW_STATE)
@@ -173,7 +282,7 @@ int TrajectoryFollower::SteerControllerPart(const PlannerHNS::WayPoint& state, c
   //cout << m_pidSteer.ToString() << endl;
 
   if(m_bEnableLog)
-    m_LogSteerPIDData.push_back(m_pidSteer.ToString());
+    m_LogSteerPIDData.Push(m_pidSteer.ToRecord());
 
   //TODO use lateral error instead of angle error
   //double future_lateral_error = PlanningHelpers::GetPerpDistanceToTrajectorySimple(m_Path, m_ForwardSimulation,0);
@@ -288,7 +397,7 @@ int TrajectoryFollower::VeclocityControllerUpdate(const double& dt, const Planne
 
   desiredShift = PlannerHNS::SHIFT_POS_DD;
   if(m_bEnableLog)
-    m_LogVelocityPIDData.push_back(m_pidVelocity.ToString());
+    m_LogVelocityPIDData.Push(m_pidVelocity.ToRecord());
   return 1;
 }
 
@@ -302,6 +411,25 @@ PlannerHNS::VehicleState TrajectoryFollower::DoOneStep(const double& dt, const P
     m_iPrevWayPoint = -1;
   }
 
+  return DoControlStep(dt, behavior, currPose, vehicleState);
+}
+
+PlannerHNS::VehicleState TrajectoryFollower::DoOneStep(const double& dt, const PlannerHNS::BehaviorState& behavior,
+    const std::shared_ptr<const FollowerPath>& path, const PlannerHNS::WayPoint& currPose,
+    const PlannerHNS::VehicleState& vehicleState, const bool& bNewTrajectory)
+{
+  if(bNewTrajectory && path && path->points.size() > 0)
+  {
+    UpdateCurrentPath(path);
+    m_iPrevWayPoint = -1;
+  }
+
+  return DoControlStep(dt, behavior, currPose, vehicleState);
+}
+
+PlannerHNS::VehicleState TrajectoryFollower::DoControlStep(const double& dt, const PlannerHNS::BehaviorState& behavior,
+    const PlannerHNS::WayPoint& currPose, const PlannerHNS::VehicleState& vehicleState)
+{
   PlannerHNS::VehicleState desiredState;
 
   if(m_bCalibrationMode)
@@ -309,7 +437,7 @@ PlannerHNS::VehicleState TrajectoryFollower::DoOneStep(const double& dt, const P
     CalibrationStep(dt, vehicleState, desiredState.steer, desiredState.speed);
     desiredState.shift = PlannerHNS::SHIFT_POS_DD;
   }
-  else if(m_Path.size()>0 && behavior.state != INITIAL_STATE )
+  else if(m_pPath && m_pPath->points.size()>0 && behavior.state != INITIAL_STATE )
   {
     PrepareNextWaypoint(currPose, vehicleState.speed, vehicleState.steer);
     VeclocityControllerUpdate(dt, vehicleState, behavior, desiredState.speed, desiredState.shift);
@@ -381,16 +509,15 @@ void TrajectoryFollower::LogCalibrationData(const PlannerHNS::VehicleState& curr
     currVelocity = currState.speed*3.6;
     UtilityH::GetTickCount(m_SteerDelayTimer);
 
-    std::ostringstream dataLine;
-    dataLine << UtilityH::GetLongTime(m_SteerDelayTimer) << ","
-        << bAngleReset << ","
-        << startAngle << ","
-        << finishAngle << ","
-        << originalTargetAngle << ","
-        << t_FromStartToFinish_a << ","
-        << currVelocity << ",";
-
-    m_SteerCalibrationData.push_back(dataLine.str());
+    CalibrationLogRecord record;
+    record.tStamp = m_SteerDelayTimer;
+    record.bReset = bAngleReset;
+    record.start = startAngle;
+    record.finish = finishAngle;
+    record.target = originalTargetAngle;
+    record.dt = t_FromStartToFinish_a;
+    record.other = currVelocity;
+    m_SteerCalibrationData.Push(record);
 
     if(bAngleReset)
     {
@@ -409,16 +536,15 @@ void TrajectoryFollower::LogCalibrationData(const PlannerHNS::VehicleState& curr
     currSteering = currState.steer*RAD2DEG;
     UtilityH::GetTickCount(m_VelocityDelayTimer);
 
-    std::ostringstream dataLine;
-    dataLine << UtilityH::GetLongTime(m_VelocityDelayTimer) << ","
-        << bVelocityReset << ","
-        << startV << ","
-        << finishV << ","
-        << originalTargetV << ","
-        << t_FromStartToFinish_v << ","
-        << currSteering << ",";
-
-    m_VelocityCalibrationData.push_back(dataLine.str());
+    CalibrationLogRecord record;
+    record.tStamp = m_VelocityDelayTimer;
+    record.bReset = bVelocityReset;
+    record.start = startV;
+    record.finish = finishV;
+    record.target = originalTargetV;
+    record.dt = t_FromStartToFinish_v;
+    record.other = currSteering;
+    m_VelocityCalibrationData.Push(record);
 
     if(bVelocityReset)
     {
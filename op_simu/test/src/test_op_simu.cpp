@@ -0,0 +1,78 @@
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+
+#include "op_planner/PlanningHelpers.h"
+#include "op_planner/TestPaths.h"
+#include "op_simu/TrajectoryFollower.h"
+
+class TestSuite : public ::testing::Test
+{
+public:
+  TestSuite() {}
+  ~TestSuite() {}
+};
+
+namespace
+{
+
+std::vector<PlannerHNS::WayPoint> CreateArcPath(const double& straight_length, const double& radius, const double& density)
+{
+  std::vector<PlannerHNS::WayPoint> path = PlannerHNS::TestPaths::CreateArcPath(straight_length, radius, density);
+  PlannerHNS::PlanningHelpers::CalcAngleAndCost(path);
+  return path;
+}
+
+}  // namespace
+
+TEST(TestSuite, TrajectoryFollower_followPointCompareHelpers)
+{
+  std::vector<PlannerHNS::WayPoint> path = CreateArcPath(50, 15, 0.5);
+
+  PlannerHNS::ControllerParams params;
+  params.SteeringDelay = 0.3;
+  params.minPursuiteDistance = 3.0;
+  PlannerHNS::CAR_BASIC_INFO car_info;
+  SimulationNS::TrajectoryFollower follower;
+  follower.Init(params, car_info);
+  follower.UpdateCurrentPath(path);
+
+  // drive along the path with a varying lateral offset, the warm started search must find
+  // the same follow point as the full search of the path
+  const double speed = 5.0;
+  int n_steps = 0;
+  for(unsigned int i = 0; i + 1 < path.size(); i++)
+  {
+    for(double t = 0; t < 1.0; t += 0.25)
+    {
+      const PlannerHNS::WayPoint& p0 = path.at(i);
+      const PlannerHNS::WayPoint& p1 = path.at(i + 1);
+      double offset = 0.8 * sin(i * 0.05 + t);
+      PlannerHNS::WayPoint pose = p0;
+      pose.pos.x = p0.pos.x + t * (p1.pos.x - p0.pos.x) - offset * sin(p0.pos.a);
+      pose.pos.y = p0.pos.y + t * (p1.pos.y - p0.pos.y) + offset * cos(p0.pos.a);
+
+      follower.PrepareNextWaypoint(pose, speed, 0);
+
+      PlannerHNS::RelativeInfo info;
+      PlannerHNS::PlanningHelpers::GetRelativeInfo(path, pose, info);
+      unsigned int point_index = 0;
+      PlannerHNS::WayPoint expected = PlannerHNS::PlanningHelpers::GetFollowPointOnTrajectory(path, info,
+          follower.m_FollowingDistance, point_index);
+
+      ASSERT_NEAR(expected.pos.x, follower.m_FollowMePoint.pos.x, 1e-12) << "step " << n_steps;
+      ASSERT_NEAR(expected.pos.y, follower.m_FollowMePoint.pos.y, 1e-12) << "step " << n_steps;
+      ASSERT_NEAR(info.perp_point.pos.x, follower.m_PerpendicularPoint.pos.x, 1e-12) << "step " << n_steps;
+      ASSERT_NEAR(info.perp_point.pos.y, follower.m_PerpendicularPoint.pos.y, 1e-12) << "step " << n_steps;
+      ASSERT_NEAR(info.perp_distance, follower.m_LateralError, 1e-12) << "step " << n_steps;
+      n_steps++;
+    }
+  }
+  ASSERT_GT(n_steps, 400);
+}
+
+int main(int argc, char ** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
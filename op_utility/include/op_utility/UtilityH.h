@@ -10,6 +10,7 @@
 #include <assert.h>
 #include <string>
 #include <math.h>
+#include <time.h>
 
 
 namespace UtilityHNS
@@ -49,6 +50,19 @@ public:
   static time_t GetLongTime(const struct timespec& srcT);
 };
 
+//PIDController state at one step, to be formatted later instead of in the control loop
+class PIDLogRecord
+{
+public:
+  timespec tStamp;
+  double kp, ki, kd;
+  double kp_v, ki_v, kd_v;
+  double pid_v;
+  double pid_lim;
+  double prevErr;
+  double accumErr;
+};
+
 class PIDController
 {
 public:
@@ -62,6 +76,8 @@ public:
   void ResetI();
   std::string ToString();
   std::string ToStringHeader();
+  PIDLogRecord ToRecord();
+  static std::string ToString(const PIDLogRecord& record);
 
 
 private:
@@ -318,15 +318,34 @@ std::string PIDController::ToStringHeader()
 }
 
 std::string PIDController::ToString()
+{
+  return ToString(ToRecord());
+}
+
+PIDLogRecord PIDController::ToRecord()
+{
+  PIDLogRecord record;
+  UtilityH::GetTickCount(record.tStamp);
+  record.kp = kp;
+  record.ki = ki;
+  record.kd = kd;
+  record.kp_v = kp_v;
+  record.ki_v = ki_v;
+  record.kd_v = kd_v;
+  record.pid_v = pid_v;
+  record.pid_lim = pid_lim;
+  record.prevErr = prevErr;
+  record.accumErr = accumErr;
+  return record;
+}
+
+std::string PIDController::ToString(const PIDLogRecord& r)
 {
   std::ostringstream str_out;
-  timespec t_stamp;
-  UtilityH::GetTickCount(t_stamp);
-  str_out << UtilityH::GetLongTime(t_stamp) << "," <<kp << "," << ki << "," << kd << "," << kp_v << "," << ki_v << "," << kd_v
-        << "," << pid_v << "," << "," << pid_lim << "," << "," << prevErr << "," << accumErr << "," ;
+  str_out << UtilityH::GetLongTime(r.tStamp) << "," << r.kp << "," << r.ki << "," << r.kd << "," << r.kp_v << "," << r.ki_v << "," << r.kd_v
+        << "," << r.pid_v << "," << "," << r.pid_lim << "," << "," << r.prevErr << "," << r.accumErr << "," ;
 
   return str_out.str();
-
 }
 
 void PIDController::ResetD()
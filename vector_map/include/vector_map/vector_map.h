@@ -55,9 +55,14 @@
 #include <vector_map_msgs/FenceArray.h>
 #include <vector_map_msgs/RailCrossingArray.h>
 
+#include <condition_variable>
 #include <fstream>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace vector_map
@@ -235,6 +240,10 @@ using Callback = std::function<void(const T&)>;
 template <class T>
 using Filter = std::function<bool(const T&)>;
 
+using Notifier = std::function<void(bool)>;
+
+using ReadyCallback = std::function<void()>;
+
 template <class T, class U>
 class Handle
 {
@@ -242,11 +251,14 @@ private:
   ros::Subscriber sub_;
   Updater<T, U> update_;
   std::vector<Callback<U>> cbs_;
+  Notifier notify_;
   std::map<Key<T>, T> map_;
 
   void subscribe(const U& msg)
   {
     update_(map_, msg);
+    if (notify_)
+      notify_(!map_.empty());
     for (const auto& cb : cbs_)
       cb(msg);
   }
@@ -271,6 +283,12 @@ public:
     cbs_.push_back(cb);
   }
 
+  // called after each update with whether the category has data
+  void registerNotifier(const Notifier& notify)
+  {
+    notify_ = notify;
+  }
+
   T findByKey(const Key<T>& key) const
   {
     auto it = map_.find(key);
@@ -279,6 +297,15 @@ public:
     return it->second;
   }
 
+  // nullptr when there is no element with the key
+  const T* find(const Key<T>& key) const
+  {
+    auto it = map_.find(key);
+    if (it == map_.end())
+      return nullptr;
+    return &it->second;
+  }
+
   std::vector<T> findByFilter(const Filter<T>& filter) const
   {
     std::vector<T> vector;
@@ -290,10 +317,45 @@ public:
     return vector;
   }
 
+  template <class F>
+  void forEach(F&& f) const
+  {
+    for (const auto& pair : map_)
+      f(pair.second);
+  }
+
+  template <class F>
+  const T* findFirst(F&& filter) const
+  {
+    for (const auto& pair : map_)
+    {
+      if (filter(pair.second))
+        return &pair.second;
+    }
+    return nullptr;
+  }
+
+  template <class F>
+  size_t countIf(F&& filter) const
+  {
+    size_t count = 0;
+    for (const auto& pair : map_)
+    {
+      if (filter(pair.second))
+        ++count;
+    }
+    return count;
+  }
+
   bool empty() const
   {
     return map_.empty();
   }
+
+  size_t size() const
+  {
+    return map_.size();
+  }
 };
 
 template <class T>
@@ -313,6 +375,18 @@ std::vector<T> parse(const std::string& csv_file)
   return objs;
 }
 
+// Vertices of a chain of lines linked by flid, in order, with their bounding box. Each line adds its end point, and
+// also its begin point when that differs from the previous vertex.
+struct Polyline
+{
+  std::vector<geometry_msgs::Point> points;
+  bool closed = false;  // the last line ends at the begin point of the first line
+  double min_x = 0;
+  double min_y = 0;
+  double max_x = 0;
+  double max_y = 0;
+};
+
 class VectorMap
 {
 private:
@@ -349,7 +423,64 @@ private:
   Handle<Fence, FenceArray> fence_;
   Handle<RailCrossing, RailCrossingArray> rail_crossing_;
 
+  // Categories with data, kept up to date by the subscription callbacks. subscribe() waits on it and the ready
+  // callbacks of subscribeAsync() fire from it, so neither depends on how often the caller spins.
+  struct SubscriptionState
+  {
+    std::mutex mutex;
+    std::condition_variable cond;
+    category_t filled = NONE;
+    std::vector<std::pair<category_t, ReadyCallback>> ready_cbs;
+  };
+  std::shared_ptr<SubscriptionState> state_;
+
+  // Line chains by the id of their first line. An entry is built on its first query and all are dropped when the
+  // LINE or POINT category is updated.
+  struct GeometryCache
+  {
+    std::mutex mutex;
+    std::map<int, std::shared_ptr<const Polyline>> chains;
+  };
+  std::shared_ptr<GeometryCache> geometry_;
+
+  void buildPolyline(int lid, Polyline& polyline) const;
+
   void registerSubscriber(ros::NodeHandle& nh, category_t category);
+  void notifySubscribed(category_t category, bool filled);
+  void waitForSubscribed(category_t category, bool has_deadline, const ros::Time& end);
+
+  const Handle<Point, PointArray>& getHandle(const Point*) const;
+  const Handle<Vector, VectorArray>& getHandle(const Vector*) const;
+  const Handle<Line, LineArray>& getHandle(const Line*) const;
+  const Handle<Area, AreaArray>& getHandle(const Area*) const;
+  const Handle<Pole, PoleArray>& getHandle(const Pole*) const;
+  const Handle<Box, BoxArray>& getHandle(const Box*) const;
+  const Handle<DTLane, DTLaneArray>& getHandle(const DTLane*) const;
+  const Handle<Node, NodeArray>& getHandle(const Node*) const;
+  const Handle<Lane, LaneArray>& getHandle(const Lane*) const;
+  const Handle<WayArea, WayAreaArray>& getHandle(const WayArea*) const;
+  const Handle<RoadEdge, RoadEdgeArray>& getHandle(const RoadEdge*) const;
+  const Handle<Gutter, GutterArray>& getHandle(const Gutter*) const;
+  const Handle<Curb, CurbArray>& getHandle(const Curb*) const;
+  const Handle<WhiteLine, WhiteLineArray>& getHandle(const WhiteLine*) const;
+  const Handle<StopLine, StopLineArray>& getHandle(const StopLine*) const;
+  const Handle<ZebraZone, ZebraZoneArray>& getHandle(const ZebraZone*) const;
+  const Handle<CrossWalk, CrossWalkArray>& getHandle(const CrossWalk*) const;
+  const Handle<RoadMark, RoadMarkArray>& getHandle(const RoadMark*) const;
+  const Handle<RoadPole, RoadPoleArray>& getHandle(const RoadPole*) const;
+  const Handle<RoadSign, RoadSignArray>& getHandle(const RoadSign*) const;
+  const Handle<Signal, SignalArray>& getHandle(const Signal*) const;
+  const Handle<StreetLight, StreetLightArray>& getHandle(const StreetLight*) const;
+  const Handle<UtilityPole, UtilityPoleArray>& getHandle(const UtilityPole*) const;
+  const Handle<GuardRail, GuardRailArray>& getHandle(const GuardRail*) const;
+  const Handle<SideWalk, SideWalkArray>& getHandle(const SideWalk*) const;
+  const Handle<DriveOnPortion, DriveOnPortionArray>& getHandle(const DriveOnPortion*) const;
+  const Handle<CrossRoad, CrossRoadArray>& getHandle(const CrossRoad*) const;
+  const Handle<SideStrip, SideStripArray>& getHandle(const SideStrip*) const;
+  const Handle<CurveMirror, CurveMirrorArray>& getHandle(const CurveMirror*) const;
+  const Handle<Wall, WallArray>& getHandle(const Wall*) const;
+  const Handle<Fence, FenceArray>& getHandle(const Fence*) const;
+  const Handle<RailCrossing, RailCrossingArray>& getHandle(const RailCrossing*) const;
 
 public:
   VectorMap();
@@ -358,6 +489,10 @@ public:
   void subscribe(ros::NodeHandle& nh, category_t category, const ros::Duration& timeout);
   void subscribe(ros::NodeHandle& nh, category_t category, const size_t max_retries);
 
+  // Registers the subscribers and returns. The callback is called once, from the thread that spins the subscriptions,
+  // when all the categories have data, or right away if they already have.
+  void subscribeAsync(ros::NodeHandle& nh, category_t category, const ReadyCallback& cb);
+
   Point findByKey(const Key<Point>& key) const;
   Vector findByKey(const Key<Vector>& key) const;
   Line findByKey(const Key<Line>& key) const;
@@ -424,6 +559,41 @@ public:
   std::vector<Fence> findByFilter(const Filter<Fence>& filter) const;
   std::vector<RailCrossing> findByFilter(const Filter<RailCrossing>& filter) const;
 
+  // Copy-free queries, e.g. vmap.forEach<Lane>([](const Lane& lane){ ... }). Elements are visited by const reference
+  // in key order and the callable is inlined. References and pointers are valid until the category is updated.
+  template <class T, class F>
+  void forEach(F&& f) const
+  {
+    getHandle(static_cast<const T*>(nullptr)).forEach(f);
+  }
+
+  // first element accepted by the filter, nullptr if there is none
+  template <class T, class F>
+  const T* findFirst(F&& filter) const
+  {
+    return getHandle(static_cast<const T*>(nullptr)).findFirst(filter);
+  }
+
+  template <class T, class F>
+  size_t countIf(F&& filter) const
+  {
+    return getHandle(static_cast<const T*>(nullptr)).countIf(filter);
+  }
+
+  template <class T, class F>
+  bool anyOf(F&& filter) const
+  {
+    return findFirst<T>(filter) != nullptr;
+  }
+
+  // The chain of lines starting at the line, empty when a line or point of it is missing or the lines loop back by
+  // flid. Never nullptr. The polyline stays valid when the cache drops it on a LINE or POINT update, it then shows the
+  // chain as it was.
+  std::shared_ptr<const Polyline> findPolyline(const Key<Line>& key) const;
+
+  // The outline of the area, empty unless its first line (slid) begins a chain (blid == 0)
+  std::shared_ptr<const Polyline> findPolyline(const Area& area) const;
+
   bool hasSubscribed(category_t category) const;
 
   void registerCallback(const Callback<PointArray>& cb);
@@ -17,6 +17,7 @@
 #include <tf/transform_datatypes.h>
 #include <vector_map/vector_map.h>
 
+#include <algorithm>
 #include <map>
 #include <string>
 #include <vector>
@@ -549,201 +550,525 @@ void VectorMap::registerSubscriber(ros::NodeHandle& nh, category_t category)
   {
     point_.registerSubscriber(nh, "/vector_map_info/point");
     point_.registerUpdater(updatePoint);
+    point_.registerNotifier([this](bool filled) { notifySubscribed(POINT, filled); });
   }
   if (category & VECTOR)
   {
     vector_.registerSubscriber(nh, "/vector_map_info/vector");
     vector_.registerUpdater(updateVector);
+    vector_.registerNotifier([this](bool filled) { notifySubscribed(VECTOR, filled); });
   }
   if (category & LINE)
   {
     line_.registerSubscriber(nh, "/vector_map_info/line");
     line_.registerUpdater(updateLine);
+    line_.registerNotifier([this](bool filled) { notifySubscribed(LINE, filled); });
   }
   if (category & AREA)
   {
     area_.registerSubscriber(nh, "/vector_map_info/area");
     area_.registerUpdater(updateArea);
+    area_.registerNotifier([this](bool filled) { notifySubscribed(AREA, filled); });
   }
   if (category & POLE)
   {
     pole_.registerSubscriber(nh, "/vector_map_info/pole");
     pole_.registerUpdater(updatePole);
+    pole_.registerNotifier([this](bool filled) { notifySubscribed(POLE, filled); });
   }
   if (category & BOX)
   {
     box_.registerSubscriber(nh, "/vector_map_info/box");
     box_.registerUpdater(updateBox);
+    box_.registerNotifier([this](bool filled) { notifySubscribed(BOX, filled); });
   }
   if (category & DTLANE)
   {
     dtlane_.registerSubscriber(nh, "/vector_map_info/dtlane");
     dtlane_.registerUpdater(updateDTLane);
+    dtlane_.registerNotifier([this](bool filled) { notifySubscribed(DTLANE, filled); });
   }
   if (category & NODE)
   {
     node_.registerSubscriber(nh, "/vector_map_info/node");
     node_.registerUpdater(updateNode);
+    node_.registerNotifier([this](bool filled) { notifySubscribed(NODE, filled); });
   }
   if (category & LANE)
   {
     lane_.registerSubscriber(nh, "/vector_map_info/lane");
     lane_.registerUpdater(updateLane);
+    lane_.registerNotifier([this](bool filled) { notifySubscribed(LANE, filled); });
   }
   if (category & WAY_AREA)
   {
     way_area_.registerSubscriber(nh, "/vector_map_info/way_area");
     way_area_.registerUpdater(updateWayArea);
+    way_area_.registerNotifier([this](bool filled) { notifySubscribed(WAY_AREA, filled); });
   }
   if (category & ROAD_EDGE)
   {
     road_edge_.registerSubscriber(nh, "/vector_map_info/road_edge");
     road_edge_.registerUpdater(updateRoadEdge);
+    road_edge_.registerNotifier([this](bool filled) { notifySubscribed(ROAD_EDGE, filled); });
   }
   if (category & GUTTER)
   {
     gutter_.registerSubscriber(nh, "/vector_map_info/gutter");
     gutter_.registerUpdater(updateGutter);
+    gutter_.registerNotifier([this](bool filled) { notifySubscribed(GUTTER, filled); });
   }
   if (category & CURB)
   {
     curb_.registerSubscriber(nh, "/vector_map_info/curb");
     curb_.registerUpdater(updateCurb);
+    curb_.registerNotifier([this](bool filled) { notifySubscribed(CURB, filled); });
   }
   if (category & WHITE_LINE)
   {
     white_line_.registerSubscriber(nh, "/vector_map_info/white_line");
     white_line_.registerUpdater(updateWhiteLine);
+    white_line_.registerNotifier([this](bool filled) { notifySubscribed(WHITE_LINE, filled); });
   }
   if (category & STOP_LINE)
   {
     stop_line_.registerSubscriber(nh, "/vector_map_info/stop_line");
     stop_line_.registerUpdater(updateStopLine);
+    stop_line_.registerNotifier([this](bool filled) { notifySubscribed(STOP_LINE, filled); });
   }
   if (category & ZEBRA_ZONE)
   {
     zebra_zone_.registerSubscriber(nh, "/vector_map_info/zebra_zone");
     zebra_zone_.registerUpdater(updateZebraZone);
+    zebra_zone_.registerNotifier([this](bool filled) { notifySubscribed(ZEBRA_ZONE, filled); });
   }
   if (category & CROSS_WALK)
   {
     cross_walk_.registerSubscriber(nh, "/vector_map_info/cross_walk");
     cross_walk_.registerUpdater(updateCrossWalk);
+    cross_walk_.registerNotifier([this](bool filled) { notifySubscribed(CROSS_WALK, filled); });
   }
   if (category & ROAD_MARK)
   {
     road_mark_.registerSubscriber(nh, "/vector_map_info/road_mark");
     road_mark_.registerUpdater(updateRoadMark);
+    road_mark_.registerNotifier([this](bool filled) { notifySubscribed(ROAD_MARK, filled); });
   }
   if (category & ROAD_POLE)
   {
     road_pole_.registerSubscriber(nh, "/vector_map_info/road_pole");
     road_pole_.registerUpdater(updateRoadPole);
+    road_pole_.registerNotifier([this](bool filled) { notifySubscribed(ROAD_POLE, filled); });
   }
   if (category & ROAD_SIGN)
   {
     road_sign_.registerSubscriber(nh, "/vector_map_info/road_sign");
     road_sign_.registerUpdater(updateRoadSign);
+    road_sign_.registerNotifier([this](bool filled) { notifySubscribed(ROAD_SIGN, filled); });
   }
   if (category & SIGNAL)
   {
     signal_.registerSubscriber(nh, "/vector_map_info/signal");
     signal_.registerUpdater(updateSignal);
+    signal_.registerNotifier([this](bool filled) { notifySubscribed(SIGNAL, filled); });
   }
   if (category & STREET_LIGHT)
   {
     street_light_.registerSubscriber(nh, "/vector_map_info/street_light");
     street_light_.registerUpdater(updateStreetLight);
+    street_light_.registerNotifier([this](bool filled) { notifySubscribed(STREET_LIGHT, filled); });
   }
   if (category & UTILITY_POLE)
   {
     utility_pole_.registerSubscriber(nh, "/vector_map_info/utility_pole");
     utility_pole_.registerUpdater(updateUtilityPole);
+    utility_pole_.registerNotifier([this](bool filled) { notifySubscribed(UTILITY_POLE, filled); });
   }
   if (category & GUARD_RAIL)
   {
     guard_rail_.registerSubscriber(nh, "/vector_map_info/guard_rail");
     guard_rail_.registerUpdater(updateGuardRail);
+    guard_rail_.registerNotifier([this](bool filled) { notifySubscribed(GUARD_RAIL, filled); });
   }
   if (category & SIDE_WALK)
   {
     side_walk_.registerSubscriber(nh, "/vector_map_info/side_walk");
     side_walk_.registerUpdater(updateSideWalk);
+    side_walk_.registerNotifier([this](bool filled) { notifySubscribed(SIDE_WALK, filled); });
   }
   if (category & DRIVE_ON_PORTION)
   {
     drive_on_portion_.registerSubscriber(nh, "/vector_map_info/drive_on_portion");
     drive_on_portion_.registerUpdater(updateDriveOnPortion);
+    drive_on_portion_.registerNotifier([this](bool filled) { notifySubscribed(DRIVE_ON_PORTION, filled); });
   }
   if (category & CROSS_ROAD)
   {
     cross_road_.registerSubscriber(nh, "/vector_map_info/cross_road");
     cross_road_.registerUpdater(updateCrossRoad);
+    cross_road_.registerNotifier([this](bool filled) { notifySubscribed(CROSS_ROAD, filled); });
   }
   if (category & SIDE_STRIP)
   {
     side_strip_.registerSubscriber(nh, "/vector_map_info/side_strip");
     side_strip_.registerUpdater(updateSideStrip);
+    side_strip_.registerNotifier([this](bool filled) { notifySubscribed(SIDE_STRIP, filled); });
   }
   if (category & CURVE_MIRROR)
   {
     curve_mirror_.registerSubscriber(nh, "/vector_map_info/curve_mirror");
     curve_mirror_.registerUpdater(updateCurveMirror);
+    curve_mirror_.registerNotifier([this](bool filled) { notifySubscribed(CURVE_MIRROR, filled); });
   }
   if (category & WALL)
   {
     wall_.registerSubscriber(nh, "/vector_map_info/wall");
     wall_.registerUpdater(updateWall);
+    wall_.registerNotifier([this](bool filled) { notifySubscribed(WALL, filled); });
   }
   if (category & FENCE)
   {
     fence_.registerSubscriber(nh, "/vector_map_info/fence");
     fence_.registerUpdater(updateFence);
+    fence_.registerNotifier([this](bool filled) { notifySubscribed(FENCE, filled); });
   }
   if (category & RAIL_CROSSING)
   {
     rail_crossing_.registerSubscriber(nh, "/vector_map_info/rail_crossing");
     rail_crossing_.registerUpdater(updateRailCrossing);
+    rail_crossing_.registerNotifier([this](bool filled) { notifySubscribed(RAIL_CROSSING, filled); });
   }
 }
 
 VectorMap::VectorMap()
+  : state_(std::make_shared<SubscriptionState>()), geometry_(std::make_shared<GeometryCache>())
 {
 }
 
-void VectorMap::subscribe(ros::NodeHandle& nh, category_t category)
+void VectorMap::notifySubscribed(category_t category, bool filled)
 {
-  registerSubscriber(nh, category);
-  ros::Rate rate(1);
-  while (ros::ok() && !hasSubscribed(category))
+  if (category & (POINT | LINE))
   {
-    ros::spinOnce();
-    rate.sleep();
+    std::lock_guard<std::mutex> lock(geometry_->mutex);
+    geometry_->chains.clear();
   }
+
+  std::vector<ReadyCallback> ready_cbs;
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if (filled)
+      state_->filled |= category;
+    else
+      state_->filled &= ~category;
+
+    auto it = state_->ready_cbs.begin();
+    while (it != state_->ready_cbs.end())
+    {
+      if ((state_->filled & it->first) == it->first)
+      {
+        ready_cbs.push_back(it->second);
+        it = state_->ready_cbs.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+  }
+  state_->cond.notify_all();
+
+  for (const auto& cb : ready_cbs)
+    cb();
 }
 
-void VectorMap::subscribe(ros::NodeHandle& nh, category_t category, const ros::Duration& timeout)
+void VectorMap::waitForSubscribed(category_t category, bool has_deadline, const ros::Time& end)
 {
-  registerSubscriber(nh, category);
-  ros::Rate rate(1);
-  ros::Time end = ros::Time::now() + timeout;
-  while (ros::ok() && !hasSubscribed(category) && ros::Time::now() < end)
+  std::unique_lock<std::mutex> lock(state_->mutex);
+  auto is_filled = [this, category]() { return (state_->filled & category) == category; };
+  while (ros::ok() && !is_filled() && (!has_deadline || ros::Time::now() < end))
   {
+    // Spin here for nodes without a spinner thread. When another thread spins, the wait ends as soon as it fills
+    // the last category.
+    lock.unlock();
     ros::spinOnce();
-    rate.sleep();
+    lock.lock();
+    state_->cond.wait_for(lock, std::chrono::milliseconds(10), is_filled);
   }
 }
 
+void VectorMap::subscribe(ros::NodeHandle& nh, category_t category)
+{
+  registerSubscriber(nh, category);
+  waitForSubscribed(category, false, ros::Time());
+}
+
+void VectorMap::subscribe(ros::NodeHandle& nh, category_t category, const ros::Duration& timeout)
+{
+  registerSubscriber(nh, category);
+  waitForSubscribed(category, true, ros::Time::now() + timeout);
+}
+
 void VectorMap::subscribe(ros::NodeHandle& nh, category_t category, const size_t max_retries)
 {
-  size_t tries = 0;
+  // one retry was one second of waiting
+  registerSubscriber(nh, category);
+  waitForSubscribed(category, true, ros::Time::now() + ros::Duration(static_cast<double>(max_retries)));
+}
+
+void VectorMap::subscribeAsync(ros::NodeHandle& nh, category_t category, const ReadyCallback& cb)
+{
   registerSubscriber(nh, category);
-  ros::Rate rate(1);
-  while (ros::ok() && !hasSubscribed(category) && tries++ < max_retries)
   {
-    ros::spinOnce();
-    rate.sleep();
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    if ((state_->filled & category) != category)
+    {
+      state_->ready_cbs.push_back(std::make_pair(category, cb));
+      return;
+    }
+  }
+  cb();
+}
+
+void VectorMap::buildPolyline(int lid, Polyline& polyline) const
+{
+  polyline = Polyline();
+
+  const Line* line = line_.find(Key<Line>(lid));
+  if (line == nullptr)
+    return;
+
+  const int first_bpid = line->bpid;
+  int last_pid = 0;
+  std::vector<geometry_msgs::Point> points;
+  // a chain without a loop has each line once
+  for (size_t n_lines = 1;; ++n_lines)
+  {
+    if (line->bpid != last_pid)
+    {
+      const Point* bp = point_.find(Key<Point>(line->bpid));
+      if (bp == nullptr)
+        return;
+      points.push_back(convertPointToGeomPoint(*bp));
+    }
+
+    const Point* fp = point_.find(Key<Point>(line->fpid));
+    if (fp == nullptr)
+      return;
+    points.push_back(convertPointToGeomPoint(*fp));
+    last_pid = line->fpid;
+
+    if (line->flid == 0)
+      break;
+    if (n_lines == line_.size())
+      return;
+
+    line = line_.find(Key<Line>(line->flid));
+    if (line == nullptr)
+      return;
   }
+
+  polyline.points.swap(points);
+  polyline.closed = (first_bpid == last_pid);
+  polyline.min_x = polyline.max_x = polyline.points[0].x;
+  polyline.min_y = polyline.max_y = polyline.points[0].y;
+  for (const auto& point : polyline.points)
+  {
+    polyline.min_x = std::min(polyline.min_x, point.x);
+    polyline.min_y = std::min(polyline.min_y, point.y);
+    polyline.max_x = std::max(polyline.max_x, point.x);
+    polyline.max_y = std::max(polyline.max_y, point.y);
+  }
+}
+
+std::shared_ptr<const Polyline> VectorMap::findPolyline(const Key<Line>& key) const
+{
+  static const std::shared_ptr<const Polyline> null_polyline = std::make_shared<Polyline>();
+  // unknown ids are not cached, the cache would grow with every id queried
+  if (line_.find(key) == nullptr)
+    return null_polyline;
+
+  std::lock_guard<std::mutex> lock(geometry_->mutex);
+  std::shared_ptr<const Polyline>& cached = geometry_->chains[key.getId()];
+  if (!cached)
+  {
+    auto polyline = std::make_shared<Polyline>();
+    buildPolyline(key.getId(), *polyline);
+    cached = polyline;
+  }
+  return cached;
+}
+
+std::shared_ptr<const Polyline> VectorMap::findPolyline(const Area& area) const
+{
+  static const std::shared_ptr<const Polyline> null_polyline = std::make_shared<Polyline>();
+  if (area.aid == 0)
+    return null_polyline;
+
+  const Line* line = line_.find(Key<Line>(area.slid));
+  if (line == nullptr || line->blid != 0)  // must set beginning line
+    return null_polyline;
+
+  return findPolyline(Key<Line>(area.slid));
+}
+
+const Handle<Point, PointArray>& VectorMap::getHandle(const Point*) const
+{
+  return point_;
+}
+
+const Handle<Vector, VectorArray>& VectorMap::getHandle(const Vector*) const
+{
+  return vector_;
+}
+
+const Handle<Line, LineArray>& VectorMap::getHandle(const Line*) const
+{
+  return line_;
+}
+
+const Handle<Area, AreaArray>& VectorMap::getHandle(const Area*) const
+{
+  return area_;
+}
+
+const Handle<Pole, PoleArray>& VectorMap::getHandle(const Pole*) const
+{
+  return pole_;
+}
+
+const Handle<Box, BoxArray>& VectorMap::getHandle(const Box*) const
+{
+  return box_;
+}
+
+const Handle<DTLane, DTLaneArray>& VectorMap::getHandle(const DTLane*) const
+{
+  return dtlane_;
+}
+
+const Handle<Node, NodeArray>& VectorMap::getHandle(const Node*) const
+{
+  return node_;
+}
+
+const Handle<Lane, LaneArray>& VectorMap::getHandle(const Lane*) const
+{
+  return lane_;
+}
+
+const Handle<WayArea, WayAreaArray>& VectorMap::getHandle(const WayArea*) const
+{
+  return way_area_;
+}
+
+const Handle<RoadEdge, RoadEdgeArray>& VectorMap::getHandle(const RoadEdge*) const
+{
+  return road_edge_;
+}
+
+const Handle<Gutter, GutterArray>& VectorMap::getHandle(const Gutter*) const
+{
+  return gutter_;
+}
+
+const Handle<Curb, CurbArray>& VectorMap::getHandle(const Curb*) const
+{
+  return curb_;
+}
+
+const Handle<WhiteLine, WhiteLineArray>& VectorMap::getHandle(const WhiteLine*) const
+{
+  return white_line_;
+}
+
+const Handle<StopLine, StopLineArray>& VectorMap::getHandle(const StopLine*) const
+{
+  return stop_line_;
+}
+
+const Handle<ZebraZone, ZebraZoneArray>& VectorMap::getHandle(const ZebraZone*) const
+{
+  return zebra_zone_;
+}
+
+const Handle<CrossWalk, CrossWalkArray>& VectorMap::getHandle(const CrossWalk*) const
+{
+  return cross_walk_;
+}
+
+const Handle<RoadMark, RoadMarkArray>& VectorMap::getHandle(const RoadMark*) const
+{
+  return road_mark_;
+}
+
+const Handle<RoadPole, RoadPoleArray>& VectorMap::getHandle(const RoadPole*) const
+{
+  return road_pole_;
+}
+
+const Handle<RoadSign, RoadSignArray>& VectorMap::getHandle(const RoadSign*) const
+{
+  return road_sign_;
+}
+
+const Handle<Signal, SignalArray>& VectorMap::getHandle(const Signal*) const
+{
+  return signal_;
+}
+
+const Handle<StreetLight, StreetLightArray>& VectorMap::getHandle(const StreetLight*) const
+{
+  return street_light_;
+}
+
+const Handle<UtilityPole, UtilityPoleArray>& VectorMap::getHandle(const UtilityPole*) const
+{
+  return utility_pole_;
+}
+
+const Handle<GuardRail, GuardRailArray>& VectorMap::getHandle(const GuardRail*) const
+{
+  return guard_rail_;
+}
+
+const Handle<SideWalk, SideWalkArray>& VectorMap::getHandle(const SideWalk*) const
+{
+  return side_walk_;
+}
+
+const Handle<DriveOnPortion, DriveOnPortionArray>& VectorMap::getHandle(const DriveOnPortion*) const
+{
+  return drive_on_portion_;
+}
+
+const Handle<CrossRoad, CrossRoadArray>& VectorMap::getHandle(const CrossRoad*) const
+{
+  return cross_road_;
+}
+
+const Handle<SideStrip, SideStripArray>& VectorMap::getHandle(const SideStrip*) const
+{
+  return side_strip_;
+}
+
+const Handle<CurveMirror, CurveMirrorArray>& VectorMap::getHandle(const CurveMirror*) const
+{
+  return curve_mirror_;
+}
+
+const Handle<Wall, WallArray>& VectorMap::getHandle(const Wall*) const
+{
+  return wall_;
+}
+
+const Handle<Fence, FenceArray>& VectorMap::getHandle(const Fence*) const
+{
+  return fence_;
+}
+
+const Handle<RailCrossing, RailCrossingArray>& VectorMap::getHandle(const RailCrossing*) const
+{
+  return rail_crossing_;
 }
 
 Point VectorMap::findByKey(const Key<Point>& key) const
@@ -1425,43 +1750,11 @@ visualization_msgs::Marker createAreaMarker(const std::string& ns, int id, Color
                                             const Area& area)
 {
   visualization_msgs::Marker marker = createMarker(ns, id, visualization_msgs::Marker::LINE_STRIP);
-  if (area.aid == 0)
-    return marker;
-
-  Line line = vmap.findByKey(Key<Line>(area.slid));
-  if (line.lid == 0)
-    return marker;
-  if (line.blid != 0)  // must set beginning line
+  std::shared_ptr<const Polyline> polyline = vmap.findPolyline(area);
+  if (polyline->points.empty())
     return marker;
 
-  while (line.flid != 0)
-  {
-    Point bp = vmap.findByKey(Key<Point>(line.bpid));
-    if (bp.pid == 0)
-      return marker;
-
-    Point fp = vmap.findByKey(Key<Point>(line.fpid));
-    if (fp.pid == 0)
-      return marker;
-
-    marker.points.push_back(convertPointToGeomPoint(bp));
-    marker.points.push_back(convertPointToGeomPoint(fp));
-
-    line = vmap.findByKey(Key<Line>(line.flid));
-    if (line.lid == 0)
-      return marker;
-  }
-
-  Point bp = vmap.findByKey(Key<Point>(line.bpid));
-  if (bp.pid == 0)
-    return marker;
-
-  Point fp = vmap.findByKey(Key<Point>(line.fpid));
-  if (fp.pid == 0)
-    return marker;
-
-  marker.points.push_back(convertPointToGeomPoint(bp));
-  marker.points.push_back(convertPointToGeomPoint(fp));
+  marker.points = polyline->points;
 
   marker.scale.x = MAKER_SCALE_AREA;
   marker.color = createColorRGBA(color);
@@ -0,0 +1,317 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "vector_map/vector_map.h"
+
+using vector_map::CrossWalk;
+using vector_map::CrossWalkArray;
+using vector_map::Key;
+using vector_map::Lane;
+using vector_map::LaneArray;
+using vector_map::Line;
+using vector_map::LineArray;
+using vector_map::Point;
+using vector_map::PointArray;
+using vector_map::Polyline;
+using vector_map::StopLine;
+using vector_map::StopLineArray;
+using vector_map::VectorMap;
+
+class VectorMapTestSuite : public ::testing::Test
+{
+protected:
+  static const int n_lanes_ = 1000;
+  static ros::Publisher lane_pub_;
+  static VectorMap* vmap_;
+
+  // The lanes are published once, latched, and all the tests query the same map. Every tenth lane ends a chain.
+  static void SetUpTestCase()
+  {
+    ros::NodeHandle nh;
+    lane_pub_ = nh.advertise<LaneArray>("/vector_map_info/lane", 1, true);
+    LaneArray lanes;
+    for (int i = 1; i <= n_lanes_; ++i)
+    {
+      Lane lane;
+      lane.lnid = i;
+      lane.bnid = i;
+      lane.fnid = i + 1;
+      lane.blid = (i % 10 == 1) ? 0 : i - 1;
+      lane.flid = (i % 10 == 0) ? 0 : i + 1;
+      lanes.data.push_back(lane);
+    }
+    lane_pub_.publish(lanes);
+
+    vmap_ = new VectorMap();
+    vmap_->subscribe(nh, vector_map::Category::LANE, ros::Duration(10.0));
+  }
+
+  static void TearDownTestCase()
+  {
+    delete vmap_;
+    vmap_ = nullptr;
+    lane_pub_.shutdown();
+  }
+};
+
+ros::Publisher VectorMapTestSuite::lane_pub_;
+VectorMap* VectorMapTestSuite::vmap_ = nullptr;
+
+TEST_F(VectorMapTestSuite, ForEach)
+{
+  ASSERT_TRUE(vmap_->hasSubscribed(vector_map::Category::LANE));
+
+  std::vector<Lane> copied = vmap_->findByFilter([](const Lane& lane) { return true; });
+  ASSERT_EQ(static_cast<size_t>(n_lanes_), copied.size());
+
+  size_t i = 0;
+  vmap_->forEach<Lane>([&](const Lane& lane) {
+    ASSERT_LT(i, copied.size());
+    EXPECT_EQ(copied[i].lnid, lane.lnid);
+    EXPECT_EQ(copied[i].flid, lane.flid);
+    ++i;
+  });
+  EXPECT_EQ(copied.size(), i);
+}
+
+TEST_F(VectorMapTestSuite, FindFirst)
+{
+  auto is_end = [](const Lane& lane) { return lane.flid == 0 && lane.lnid > 100; };
+  std::vector<Lane> copied = vmap_->findByFilter(is_end);
+  ASSERT_FALSE(copied.empty());
+
+  const Lane* first = vmap_->findFirst<Lane>(is_end);
+  ASSERT_NE(nullptr, first);
+  EXPECT_EQ(copied.front().lnid, first->lnid);
+  EXPECT_EQ(110, first->lnid);
+  EXPECT_EQ(vmap_->findByKey(Key<Lane>(first->lnid)).fnid, first->fnid);
+
+  EXPECT_EQ(nullptr, vmap_->findFirst<Lane>([](const Lane& lane) { return lane.lnid > n_lanes_; }));
+}
+
+TEST_F(VectorMapTestSuite, CountIfAndAnyOf)
+{
+  auto is_end = [](const Lane& lane) { return lane.flid == 0; };
+  EXPECT_EQ(vmap_->findByFilter(is_end).size(), vmap_->countIf<Lane>(is_end));
+  EXPECT_EQ(static_cast<size_t>(n_lanes_ / 10), vmap_->countIf<Lane>(is_end));
+  EXPECT_EQ(0u, vmap_->countIf<Lane>([](const Lane& lane) { return lane.lnid <= 0; }));
+
+  EXPECT_TRUE(vmap_->anyOf<Lane>([](const Lane& lane) { return lane.lnid == n_lanes_; }));
+  EXPECT_FALSE(vmap_->anyOf<Lane>([](const Lane& lane) { return lane.lnid > n_lanes_; }));
+}
+
+namespace
+{
+// A closed square of four lines, the points are moved by offset
+void createSquare(double offset, PointArray& points, LineArray& lines)
+{
+  const double xs[] = { 0, 1, 1, 0 };
+  const double ys[] = { 0, 0, 1, 1 };
+  for (int i = 0; i < 4; ++i)
+  {
+    Point point;
+    point.pid = i + 1;
+    point.ly = xs[i] + offset;
+    point.bx = ys[i] + offset;
+    points.data.push_back(point);
+
+    Line line;
+    line.lid = i + 1;
+    line.bpid = i + 1;
+    line.fpid = (i + 1) % 4 + 1;
+    line.blid = i;
+    line.flid = (i < 3) ? i + 2 : 0;
+    lines.data.push_back(line);
+  }
+}
+}  // namespace
+
+TEST_F(VectorMapTestSuite, FindPolylineAfterUpdate)
+{
+  ros::NodeHandle nh;
+  ros::Publisher point_pub = nh.advertise<PointArray>("/vector_map_info/point", 1, true);
+  ros::Publisher line_pub = nh.advertise<LineArray>("/vector_map_info/line", 1, true);
+  PointArray points;
+  LineArray lines;
+  createSquare(0, points, lines);
+  point_pub.publish(points);
+  line_pub.publish(lines);
+
+  VectorMap vmap;
+  bool points_updated = false;
+  bool lines_updated = false;
+  vmap.registerCallback([&points_updated](const PointArray&) { points_updated = true; });
+  vmap.registerCallback([&lines_updated](const LineArray&) { lines_updated = true; });
+  vmap.subscribe(nh, vector_map::Category::POINT | vector_map::Category::LINE, ros::Duration(10.0));
+  ASSERT_TRUE(vmap.hasSubscribed(vector_map::Category::POINT | vector_map::Category::LINE));
+
+  std::shared_ptr<const Polyline> square = vmap.findPolyline(Key<Line>(1));
+  ASSERT_NE(nullptr, square);
+  ASSERT_EQ(5u, square->points.size());
+  EXPECT_TRUE(square->closed);
+  EXPECT_EQ(square, vmap.findPolyline(Key<Line>(1)));
+  EXPECT_TRUE(vmap.findPolyline(Key<Line>(100))->points.empty());
+
+  // the update drops the cache, the polyline held from before keeps the old chain
+  points_updated = false;
+  lines_updated = false;
+  PointArray moved_points;
+  LineArray moved_lines;
+  createSquare(10, moved_points, moved_lines);
+  moved_lines.data.pop_back();
+  moved_lines.data.back().flid = 0;
+  point_pub.publish(moved_points);
+  line_pub.publish(moved_lines);
+  ros::Time end = ros::Time::now() + ros::Duration(10.0);
+  while (!(points_updated && lines_updated) && ros::Time::now() < end)
+  {
+    ros::spinOnce();
+    ros::Duration(0.01).sleep();
+  }
+  ASSERT_TRUE(points_updated && lines_updated);
+
+  ASSERT_EQ(5u, square->points.size());
+  EXPECT_TRUE(square->closed);
+  EXPECT_EQ(0, square->min_x);
+  EXPECT_EQ(1, square->max_x);
+
+  std::shared_ptr<const Polyline> moved = vmap.findPolyline(Key<Line>(1));
+  ASSERT_NE(square, moved);
+  ASSERT_EQ(4u, moved->points.size());
+  EXPECT_FALSE(moved->closed);
+  EXPECT_EQ(10, moved->min_x);
+}
+
+TEST_F(VectorMapTestSuite, FindPolylineLoopAndUnknownIds)
+{
+  ros::NodeHandle nh;
+  ros::Publisher point_pub = nh.advertise<PointArray>("/vector_map_info/point", 1, true);
+  ros::Publisher line_pub = nh.advertise<LineArray>("/vector_map_info/line", 1, true);
+  PointArray points;
+  LineArray lines;
+  createSquare(0, points, lines);
+  lines.data.back().flid = 1;
+  lines.data.front().blid = 4;
+  point_pub.publish(points);
+  line_pub.publish(lines);
+
+  VectorMap vmap;
+  vmap.subscribe(nh, vector_map::Category::POINT | vector_map::Category::LINE, ros::Duration(10.0));
+  ASSERT_TRUE(vmap.hasSubscribed(vector_map::Category::POINT | vector_map::Category::LINE));
+
+  // the lines loop back by flid, the walk stops
+  std::shared_ptr<const Polyline> loop = vmap.findPolyline(Key<Line>(1));
+  ASSERT_NE(nullptr, loop);
+  EXPECT_TRUE(loop->points.empty());
+
+  // unknown ids all get the same empty polyline, nothing is built for them
+  std::shared_ptr<const Polyline> unknown = vmap.findPolyline(Key<Line>(100));
+  ASSERT_NE(nullptr, unknown);
+  EXPECT_TRUE(unknown->points.empty());
+  EXPECT_EQ(unknown, vmap.findPolyline(Key<Line>(101)));
+  EXPECT_NE(loop, unknown);
+}
+
+namespace
+{
+// Spins until done() or the timeout, for the messages published after subscribing
+template <class Predicate>
+void spinUntil(Predicate done, double timeout)
+{
+  ros::Time end = ros::Time::now() + ros::Duration(timeout);
+  while (!done() && ros::Time::now() < end)
+  {
+    ros::spinOnce();
+    ros::Duration(0.01).sleep();
+  }
+}
+}  // namespace
+
+TEST_F(VectorMapTestSuite, SubscribeAsyncFiresOnceForAllCategories)
+{
+  ros::NodeHandle nh;
+  ros::Publisher stop_line_pub = nh.advertise<StopLineArray>("/vector_map_info/stop_line", 1, true);
+  ros::Publisher cross_walk_pub = nh.advertise<CrossWalkArray>("/vector_map_info/cross_walk", 1, true);
+  StopLineArray stop_lines;
+  stop_lines.data.push_back(StopLine());
+  stop_lines.data.back().id = 1;
+  CrossWalkArray cross_walks;
+  cross_walks.data.push_back(CrossWalk());
+  cross_walks.data.back().id = 1;
+
+  const vector_map::category_t categories = vector_map::Category::STOP_LINE | vector_map::Category::CROSS_WALK;
+  VectorMap vmap;
+  int ready_count = 0;
+  vmap.subscribeAsync(nh, categories, [&ready_count]() { ++ready_count; });
+  EXPECT_EQ(0, ready_count);
+
+  // one category is not enough
+  stop_line_pub.publish(stop_lines);
+  spinUntil([&vmap]() { return vmap.hasSubscribed(vector_map::Category::STOP_LINE); }, 10.0);
+  ASSERT_TRUE(vmap.hasSubscribed(vector_map::Category::STOP_LINE));
+  EXPECT_EQ(0, ready_count);
+
+  cross_walk_pub.publish(cross_walks);
+  spinUntil([&ready_count]() { return ready_count > 0; }, 10.0);
+  EXPECT_EQ(1, ready_count);
+  EXPECT_TRUE(vmap.hasSubscribed(categories));
+
+  // updates of the categories do not fire it again
+  stop_line_pub.publish(stop_lines);
+  cross_walk_pub.publish(cross_walks);
+  spinUntil([&ready_count]() { return ready_count > 1; }, 0.2);
+  EXPECT_EQ(1, ready_count);
+
+  // a callback registered when the categories have data fires right away
+  int late_count = 0;
+  vmap.subscribeAsync(nh, categories, [&late_count]() { ++late_count; });
+  EXPECT_EQ(1, late_count);
+}
+
+TEST_F(VectorMapTestSuite, SubscribeTimesOut)
+{
+  ros::NodeHandle nh;
+
+  // nothing is published on the wall and fence topics
+  VectorMap vmap;
+  ros::Time start = ros::Time::now();
+  vmap.subscribe(nh, vector_map::Category::WALL, ros::Duration(0.2));
+  double waited = (ros::Time::now() - start).toSec();
+  EXPECT_FALSE(vmap.hasSubscribed(vector_map::Category::WALL));
+  EXPECT_GE(waited, 0.2);
+  EXPECT_LT(waited, 2.0);
+
+  // max_retries is a number of seconds
+  start = ros::Time::now();
+  vmap.subscribe(nh, vector_map::Category::FENCE, static_cast<size_t>(1));
+  waited = (ros::Time::now() - start).toSec();
+  EXPECT_FALSE(vmap.hasSubscribed(vector_map::Category::FENCE));
+  EXPECT_GE(waited, 1.0);
+  EXPECT_LT(waited, 3.0);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "VectorMapTestNode");
+  return RUN_ALL_TESTS();
+}
@@ -46,7 +46,12 @@
 #include "vector_map_server/GetFence.h"
 #include "vector_map_server/GetRailCrossing.h"
 #include "vector_map_server/PositionState.h"
+#include "vector_map_server/PositionStateArray.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
 #include <vector>
 
 using vector_map::VectorMap;
@@ -54,6 +59,7 @@ using vector_map::Category;
 using vector_map::Color;
 using vector_map::Filter;
 using vector_map::Key;
+using vector_map::Polyline;
 
 using vector_map::Point;
 using vector_map::Vector;
@@ -155,32 +161,32 @@ Point createMedianPoint(const Point& p1, const Point& p2)
 std::vector<Point> findStartPoints(const VectorMap& vmap)
 {
   std::vector<Point> start_points;
-  for (const auto& lane : vmap.findByFilter([](const Lane& lane){return true;}))
+  vmap.forEach<Lane>([&vmap, &start_points](const Lane& lane)
   {
     Node node = vmap.findByKey(Key<Node>(lane.bnid));
     if (node.nid == 0)
-      continue;
+      return;
     Point point = vmap.findByKey(Key<Point>(node.pid));
     if (point.pid == 0)
-      continue;
+      return;
     start_points.push_back(point);
-  }
+  });
   return start_points;
 }
 
 std::vector<Point> findEndPoints(const VectorMap& vmap)
 {
   std::vector<Point> end_points;
-  for (const auto& lane : vmap.findByFilter([](const Lane& lane){return true;}))
+  vmap.forEach<Lane>([&vmap, &end_points](const Lane& lane)
   {
     Node node = vmap.findByKey(Key<Node>(lane.fnid));
     if (node.nid == 0)
-      continue;
+      return;
     Point point = vmap.findByKey(Key<Point>(node.pid));
     if (point.pid == 0)
-      continue;
+      return;
     end_points.push_back(point);
-  }
+  });
   return end_points;
 }
 
@@ -214,22 +220,32 @@ std::vector<Point> findNearPoints(const std::vector<Point>& points, const Point&
 std::vector<Lane> findLanesByStartPoint(const VectorMap& vmap, const Point& start_point)
 {
   std::vector<Lane> lanes;
-  for (const auto& node : vmap.findByFilter([&start_point](const Node& node){return node.pid == start_point.pid;}))
+  vmap.forEach<Node>([&vmap, &start_point, &lanes](const Node& node)
   {
-    for (const auto& lane : vmap.findByFilter([&node](const Lane& lane){return lane.bnid == node.nid;}))
-      lanes.push_back(lane);
-  }
+    if (node.pid != start_point.pid)
+      return;
+    vmap.forEach<Lane>([&node, &lanes](const Lane& lane)
+    {
+      if (lane.bnid == node.nid)
+        lanes.push_back(lane);
+    });
+  });
   return lanes;
 }
 
 std::vector<Lane> findLanesByEndPoint(const VectorMap& vmap, const Point& end_point)
 {
   std::vector<Lane> lanes;
-  for (const auto& node : vmap.findByFilter([&end_point](const Node& node){return node.pid == end_point.pid;}))
+  vmap.forEach<Node>([&vmap, &end_point, &lanes](const Node& node)
   {
-    for (const auto& lane : vmap.findByFilter([&node](const Lane& lane){return lane.fnid == node.nid;}))
-      lanes.push_back(lane);
-  }
+    if (node.pid != end_point.pid)
+      return;
+    vmap.forEach<Lane>([&node, &lanes](const Lane& lane)
+    {
+      if (lane.fnid == node.nid)
+        lanes.push_back(lane);
+    });
+  });
   return lanes;
 }
 
@@ -437,40 +453,11 @@ bool isValidPolygon(const Polygon& polygon)
 Polygon createPolygon(const VectorMap& vmap, const Area& area)
 {
   Polygon null_polygon;
-  if (area.aid == 0)
-    return null_polygon;
-
-  Line line = vmap.findByKey(Key<Line>(area.slid));
-  if (line.lid == 0)
-    return null_polygon;
-  if (line.blid != 0)
-    return null_polygon;
-
-  Polygon polygon;
-  Line start_line = line;
-  while (true)
-  {
-    Point point = vmap.findByKey(Key<Point>(line.bpid));
-    if (point.pid == 0)
-      return null_polygon;
-    polygon.push_back(convertPointToGeomPoint(point));
-
-    if (line.flid == 0)
-      break;
-
-    line = vmap.findByKey(Key<Line>(line.flid));
-    if (line.lid == 0)
-      return null_polygon;
-  }
-  Point point = vmap.findByKey(Key<Point>(line.fpid));
-  if (point.pid == 0)
-    return null_polygon;
-  polygon.push_back(convertPointToGeomPoint(point));
-
-  Line end_line = line;
-  if (start_line.bpid != end_line.fpid)
+  std::shared_ptr<const Polyline> polyline = vmap.findPolyline(area);
+  if (!polyline->closed)
     return null_polygon;
 
+  Polygon polygon = polyline->points;
   if (!isValidPolygon(polygon))
     return null_polygon;
 
@@ -508,6 +495,91 @@ bool isInPolygon(const Polygon& polygon, const geometry_msgs::Point& geom_point)
   return winding_number != 0;
 }
 
+struct WayAreaPolygon
+{
+  Polygon polygon;
+  double min_x;
+  double min_y;
+  double max_x;
+  double max_y;
+};
+
+// Way area polygons bucketed by their bounding boxes into a uniform grid
+class WayAreaIndex
+{
+private:
+  double cell_size_;
+  std::vector<WayAreaPolygon> polygons_;
+  std::unordered_map<uint64_t, std::vector<size_t>> cells_;
+
+  int toCell(double value) const
+  {
+    return static_cast<int>(std::floor(value / cell_size_));
+  }
+
+  static uint64_t toCellKey(int ix, int iy)
+  {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(ix)) << 32) | static_cast<uint32_t>(iy);
+  }
+
+public:
+  explicit WayAreaIndex(double cell_size = 10.0)
+    : cell_size_(cell_size)
+  {
+  }
+
+  void build(const VectorMap& vmap)
+  {
+    polygons_.clear();
+    cells_.clear();
+    for (const auto& way_area : vmap.findByFilter([](const WayArea& way_area){return true;}))
+    {
+      Area area = vmap.findByKey(Key<Area>(way_area.aid));
+      if (area.aid == 0)
+        continue;
+      WayAreaPolygon way_area_polygon;
+      way_area_polygon.polygon = createPolygon(vmap, area);
+      if (!isValidPolygon(way_area_polygon.polygon))
+        continue;
+
+      way_area_polygon.min_x = way_area_polygon.max_x = way_area_polygon.polygon[0].x;
+      way_area_polygon.min_y = way_area_polygon.max_y = way_area_polygon.polygon[0].y;
+      for (const auto& geom_point : way_area_polygon.polygon)
+      {
+        way_area_polygon.min_x = std::min(way_area_polygon.min_x, geom_point.x);
+        way_area_polygon.min_y = std::min(way_area_polygon.min_y, geom_point.y);
+        way_area_polygon.max_x = std::max(way_area_polygon.max_x, geom_point.x);
+        way_area_polygon.max_y = std::max(way_area_polygon.max_y, geom_point.y);
+      }
+
+      size_t index = polygons_.size();
+      for (int ix = toCell(way_area_polygon.min_x); ix <= toCell(way_area_polygon.max_x); ++ix)
+      {
+        for (int iy = toCell(way_area_polygon.min_y); iy <= toCell(way_area_polygon.max_y); ++iy)
+          cells_[toCellKey(ix, iy)].push_back(index);
+      }
+      polygons_.push_back(way_area_polygon);
+    }
+  }
+
+  bool contains(const geometry_msgs::Point& geom_point) const
+  {
+    auto it = cells_.find(toCellKey(toCell(geom_point.x), toCell(geom_point.y)));
+    if (it == cells_.end())
+      return false;
+    for (size_t index : it->second)
+    {
+      const WayAreaPolygon& way_area_polygon = polygons_[index];
+      if (geom_point.x < way_area_polygon.min_x || geom_point.x > way_area_polygon.max_x ||
+          geom_point.y < way_area_polygon.min_y || geom_point.y > way_area_polygon.max_y)
+        continue;
+      if (isInPolygon(way_area_polygon.polygon, geom_point))
+        return true;
+    }
+    return false;
+  }
+};
+
 class VectorMapServer
 {
 private:
@@ -519,6 +591,19 @@ private:
   visualization_msgs::MarkerArray marker_array_;
   ros::Publisher marker_array_pub_;
 
+  WayAreaIndex way_area_index_;
+  bool way_area_index_outdated_;
+
+  const WayAreaIndex& getWayAreaIndex()
+  {
+    if (way_area_index_outdated_)
+    {
+      way_area_index_.build(vmap_);
+      way_area_index_outdated_ = false;
+    }
+    return way_area_index_;
+  }
+
   std::vector<Lane> createTravelingRoute(const geometry_msgs::PoseStamped& pose,
                                          const autoware_msgs::Lane& waypoints)
   {
@@ -592,6 +677,20 @@ public:
     nh.param<double>("vector_map_server/radius", radius_, 10);
     nh.param<int>("vector_map_server/loops", loops_, 10000);
     nh.param<bool>("vector_map_server/debug", debug_, false);
+
+    double way_area_cell_size;
+    nh.param<double>("vector_map_server/way_area_cell_size", way_area_cell_size, 10);
+    if (!(way_area_cell_size > 0) || !std::isfinite(way_area_cell_size))
+    {
+      ROS_WARN("vector_map_server/way_area_cell_size must be positive, got %f, using 10", way_area_cell_size);
+      way_area_cell_size = 10;
+    }
+    way_area_index_ = WayAreaIndex(way_area_cell_size);
+    way_area_index_outdated_ = true;
+    vmap_.registerCallback([this](const vector_map_msgs::PointArray& msg){way_area_index_outdated_ = true;});
+    vmap_.registerCallback([this](const vector_map_msgs::LineArray& msg){way_area_index_outdated_ = true;});
+    vmap_.registerCallback([this](const vector_map_msgs::AreaArray& msg){way_area_index_outdated_ = true;});
+    vmap_.registerCallback([this](const vector_map_msgs::WayAreaArray& msg){way_area_index_outdated_ = true;});
     if (debug_)
       marker_array_pub_ = nh.advertise<visualization_msgs::MarkerArray>("vector_map_server", 10, true);
   }
@@ -1019,19 +1118,17 @@ public:
   bool isWayArea(vector_map_server::PositionState::Request& request,
                  vector_map_server::PositionState::Response& response)
   {
-    response.state = false;
-    for (const auto& way_area : vmap_.findByFilter([](const WayArea& way_area){return true;}))
-    {
-      Area area = vmap_.findByKey(Key<Area>(way_area.aid));
-      if (area.aid == 0)
-        continue;
-      Polygon polygon = createPolygon(vmap_, area);
-      if (isInPolygon(polygon, request.position))
-      {
-        response.state = true;
-        break;
-      }
-    }
+    response.state = getWayAreaIndex().contains(request.position);
+    return true;
+  }
+
+  bool isWayAreaArray(vector_map_server::PositionStateArray::Request& request,
+                      vector_map_server::PositionStateArray::Response& response)
+  {
+    const WayAreaIndex& way_area_index = getWayAreaIndex();
+    response.states.reserve(request.positions.size());
+    for (const auto& position : request.positions)
+      response.states.push_back(way_area_index.contains(position));
     return true;
   }
 };
@@ -1098,6 +1195,8 @@ int main(int argc, char **argv)
                                                                  &VectorMapServer::getRailCrossing, &vms);
   ros::ServiceServer is_way_area_srv = nh.advertiseService("vector_map_server/is_way_area",
                                                            &VectorMapServer::isWayArea, &vms);
+  ros::ServiceServer is_way_area_array_srv = nh.advertiseService("vector_map_server/is_way_area_array",
+                                                                 &VectorMapServer::isWayAreaArray, &vms);
 
   ros::spin();
 